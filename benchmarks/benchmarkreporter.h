@@ -0,0 +1,83 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef BENCHMARKREPORTER_H
+#define BENCHMARKREPORTER_H
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <QTextStream>
+#include <QVariantList>
+
+/* @brief Prints the results of a benchmark, as one JSON object per line or as CSV,
+   so that runs can be compared by scripts.
+ */
+class BenchmarkReporter
+{
+public:
+    /* @param columns are the names of the values of a result, in the order they are reported
+       @param csv selects CSV output, JSON lines otherwise
+     */
+    BenchmarkReporter(const QStringList &columns, bool csv)
+        : m_columns(columns)
+        , m_csv(csv)
+        , m_out(stdout)
+    {
+        if (m_csv) {
+            m_out << m_columns.join(QLatin1Char(',')) << endl;
+        }
+    }
+
+    /* @brief Prints one result, whose values are given in the order of the columns */
+    void report(const QVariantList &values)
+    {
+        Q_ASSERT(values.size() == m_columns.size());
+        if (m_csv) {
+            QStringList fields;
+            for (const QVariant &value : values) {
+                fields << value.toString();
+            }
+            m_out << fields.join(QLatin1Char(',')) << endl;
+            return;
+        }
+        QJsonObject object;
+        for (int i = 0; i < m_columns.size(); ++i) {
+            object.insert(m_columns.at(i), QJsonValue::fromVariant(values.at(i)));
+        }
+        m_out << QJsonDocument(object).toJson(QJsonDocument::Compact) << endl;
+    }
+
+    /* @brief Returns the average time of one unit of work
+       @param units is the number of units (pixels, samples, operations) processed by one iteration
+     */
+    static double nsPerUnit(qint64 nanoseconds, int iterations, qint64 units)
+    {
+        return (double)nanoseconds / ((double)qMax(1, iterations) * (double)qMax(Q_INT64_C(1), units));
+    }
+
+private:
+    QStringList m_columns;
+    bool m_csv;
+    QTextStream m_out;
+};
+
+#endif
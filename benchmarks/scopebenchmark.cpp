@@ -0,0 +1,336 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+/*
+  Headless benchmark of the scopes.
+
+  Synthetic frames (and optionally frames decoded from a clip) of several
+  resolutions go through the analysis and the drawing of each color scope, then
+  through all of them sharing one analysis as in the scope manager. Audio blocks
+  go through the spectrum computation of the audio scopes, and frames through
+  the queues used to pass them between threads.
+
+  Each result is printed as one JSON object per line (or CSV with --csv), so
+  that runs can be compared by scripts:
+    {"benchmark":"waveform","source":"synthetic","width":1920,"height":1080,"iterations":50,"unit":"PerPixel","nsPerUnit":1.9,"fps":251.3}
+*/
+
+#include "benchmarkreporter.h"
+#include "lib/audio/fftTools.h"
+#include "monitor/scopes/dataqueue.h"
+#include "monitor/scopes/ringqueue.h"
+#include "monitor/scopes/scopeframe.h"
+#include "monitor/scopes/sharedframe.h"
+#include "scopes/colorscopes/histogramgenerator.h"
+#include "scopes/colorscopes/rgbparadegenerator.h"
+#include "scopes/colorscopes/scopeanalyzer.h"
+#include "scopes/colorscopes/vectorscopegenerator.h"
+#include "scopes/colorscopes/waveformgenerator.h"
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QImage>
+#include <QPainter>
+#include <cmath>
+#include <functional>
+#include <mlt++/Mlt.h>
+#include <thread>
+#include <vector>
+
+namespace {
+// Size of the scope widgets, the drawing cost depends on it
+const QSize waveformSize(720, 256);
+const QSize histogramSize(512, 256);
+const QSize paradeSize(768, 256);
+const QSize vectorscopeSize(400, 400);
+
+struct Result
+{
+    QString benchmark;
+    QString source;
+    int width;
+    int height;
+    int iterations;
+    // Number of units (pixels, samples, items) processed by one iteration
+    qint64 units;
+    QString unit;
+    qint64 nanoseconds;
+};
+
+void report(BenchmarkReporter &reporter, const Result &result)
+{
+    const double fps = result.nanoseconds > 0 ? result.iterations * 1e9 / result.nanoseconds : 0;
+    reporter.report({result.benchmark, result.source, result.width, result.height, result.iterations, result.unit,
+                     BenchmarkReporter::nsPerUnit(result.nanoseconds, result.iterations, result.units), fps});
+}
+
+// Color bars over a luma ramp, with some noise so that the distributions are not too sparse
+QImage syntheticImage(int width, int height, int seed)
+{
+    QImage image(width, height, QImage::Format_RGB32);
+    const QRgb bars[] = {qRgb(191, 191, 191), qRgb(191, 191, 0), qRgb(0, 191, 191), qRgb(0, 191, 0),
+                         qRgb(191, 0, 191),   qRgb(191, 0, 0),   qRgb(0, 0, 191),   qRgb(16, 16, 16)};
+    uint random = 2463534242u + (uint)seed;
+    for (int y = 0; y < height; ++y) {
+        auto *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+        for (int x = 0; x < width; ++x) {
+            random ^= random << 13;
+            random ^= random >> 17;
+            random ^= random << 5;
+            const int noise = (int)(random & 15) - 8;
+            int r, g, b;
+            if (y < height / 2) {
+                const QRgb bar = bars[x * 8 / width];
+                r = qRed(bar);
+                g = qGreen(bar);
+                b = qBlue(bar);
+            } else {
+                r = g = b = x * 255 / qMax(1, width - 1);
+            }
+            line[x] = qRgb(qBound(0, r + noise, 255), qBound(0, g + noise, 255), qBound(0, b + noise, 255));
+        }
+    }
+    return image;
+}
+
+// Decodes the first frames of a clip, at the resolution of the clip
+std::vector<ScopeFrame> decodedFrames(const QString &path, int count)
+{
+    std::vector<ScopeFrame> frames;
+    Mlt::Profile profile;
+    Mlt::Producer producer(profile, path.toUtf8().constData());
+    if (!producer.is_valid()) {
+        return frames;
+    }
+    profile.from_producer(producer);
+    for (int i = 0; i < count; ++i) {
+        producer.seek(i);
+        std::unique_ptr<Mlt::Frame> frame(producer.get_frame());
+        if (frame == nullptr || !frame->is_valid()) {
+            break;
+        }
+        mlt_image_format format = mlt_image_yuv420p;
+        int width = profile.width();
+        int height = profile.height();
+        frame->get_image(format, width, height);
+        ScopeFrame scopeFrame{SharedFrame(*frame)};
+        if (scopeFrame.isValid()) {
+            frames.push_back(scopeFrame);
+        }
+    }
+    return frames;
+}
+
+// Runs work on each frame in turn, a new frame each time so that the analysis is never cached
+qint64 timeFrames(const std::vector<ScopeFrame> &frames, int iterations, const std::function<void(const ScopeFrame &)> &work)
+{
+    // Warm up the caches and the thread pool
+    work(frames.front());
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; ++i) {
+        work(frames[(size_t)(i + 1) % frames.size()]);
+    }
+    return timer.nsecsElapsed();
+}
+
+void benchmarkColorScopes(BenchmarkReporter &reporter, const QString &source, const std::vector<ScopeFrame> &frames, int iterations)
+{
+    const int width = frames.front().width();
+    const int height = frames.front().height();
+    auto run = [&](const QString &name, const std::function<void(const ScopeFrame &)> &work) {
+        qint64 ns = timeFrames(frames, iterations, work);
+        report(reporter, Result{name, source, width, height, iterations, (qint64)width * height, QStringLiteral("PerPixel"), ns});
+    };
+
+    WaveformGenerator waveformGenerator;
+    HistogramGenerator histogramGenerator;
+    RGBParadeGenerator paradeGenerator;
+    VectorscopeGenerator vectorscopeGenerator;
+    ScopeAnalyzer::Request waveform;
+    waveform.lumaColumns = waveformSize.width();
+    ScopeAnalyzer::Request histogram;
+    histogram.lumaColumns = 1;
+    histogram.rgbColumns = 1;
+    ScopeAnalyzer::Request parade;
+    parade.rgbColumns = (int)RGBParadeGenerator::partWidth(paradeSize);
+    ScopeAnalyzer::Request vectorscope;
+    vectorscope.chroma = true;
+    const int components = HistogramGenerator::ComponentY | HistogramGenerator::ComponentR | HistogramGenerator::ComponentG | HistogramGenerator::ComponentB;
+    const float gain = 1;
+
+    auto drawWaveform = [&](const ScopeAnalyzer::Analysis &analysis) {
+        waveformGenerator.calculateWaveform(waveformSize, *analysis.findLuma(waveform.lumaSpace, waveform.lumaColumns), WaveformGenerator::PaintMode_Yellow,
+                                            true);
+    };
+    auto drawHistogram = [&](const ScopeAnalyzer::Analysis &analysis) {
+        histogramGenerator.calculateHistogram(histogramSize, analysis.findLuma(histogram.lumaSpace, 1), analysis.findRgb(1), components, false);
+    };
+    auto drawParade = [&](const ScopeAnalyzer::Analysis &analysis) {
+        paradeGenerator.calculateRGBParade(paradeSize, *analysis.findRgb(parade.rgbColumns), RGBParadeGenerator::PaintMode_RGB, true, true);
+    };
+    auto drawVectorscope = [&](const ScopeAnalyzer::Analysis &analysis) {
+        vectorscopeGenerator.calculateVectorscope(vectorscopeSize, analysis, gain, VectorscopeGenerator::PaintMode_Green2,
+                                                  VectorscopeGenerator::ColorSpace_YUV, true);
+    };
+
+    {
+        ScopeAnalyzer analyzer;
+        run(QStringLiteral("waveform"), [&](const ScopeFrame &frame) { drawWaveform(*analyzer.analyse(&waveform, waveform, frame)); });
+    }
+    {
+        ScopeAnalyzer analyzer;
+        run(QStringLiteral("histogram"), [&](const ScopeFrame &frame) { drawHistogram(*analyzer.analyse(&histogram, histogram, frame)); });
+    }
+    {
+        ScopeAnalyzer analyzer;
+        run(QStringLiteral("rgbparade"), [&](const ScopeFrame &frame) { drawParade(*analyzer.analyse(&parade, parade, frame)); });
+    }
+    {
+        ScopeAnalyzer analyzer;
+        run(QStringLiteral("vectorscope"), [&](const ScopeFrame &frame) { drawVectorscope(*analyzer.analyse(&vectorscope, vectorscope, frame)); });
+    }
+    {
+        // All the scopes open, the frame is analysed once for all of them
+        ScopeAnalyzer analyzer;
+        run(QStringLiteral("allscopes"), [&](const ScopeFrame &frame) {
+            drawWaveform(*analyzer.analyse(&waveform, waveform, frame));
+            drawHistogram(*analyzer.analyse(&histogram, histogram, frame));
+            drawParade(*analyzer.analyse(&parade, parade, frame));
+            drawVectorscope(*analyzer.analyse(&vectorscope, vectorscope, frame));
+        });
+    }
+}
+
+void benchmarkSpectrum(BenchmarkReporter &reporter, int iterations)
+{
+    const uint channels = 2;
+    const int frequency = 48000;
+    // One video frame of audio at 25 fps
+    const uint samples = (uint)frequency / 25;
+    std::vector<qint16> audio(samples * channels);
+    for (uint i = 0; i < samples; ++i) {
+        const double t = (double)i / frequency;
+        audio[i * channels] = (qint16)(16000 * std::sin(2 * M_PI * 440 * t));
+        audio[i * channels + 1] = (qint16)(12000 * std::sin(2 * M_PI * 1000 * t) + 4000 * std::sin(2 * M_PI * 5000 * t));
+    }
+    FFTTools fft;
+    QVector<QVector<float>> spectra;
+    for (uint windowSize : {512u, 2048u, 8192u}) {
+        fft.spectra(audio.data(), samples, channels, spectra, FFTTools::Window_Hamming, windowSize);
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < iterations; ++i) {
+            fft.spectra(audio.data(), samples, channels, spectra, FFTTools::Window_Hamming, windowSize);
+        }
+        report(reporter, Result{QStringLiteral("spectrum"), QStringLiteral("synthetic"), (int)windowSize, (int)channels, iterations,
+                               (qint64)samples * channels, QStringLiteral("PerSample"), timer.nsecsElapsed()});
+    }
+}
+
+template <class Queue> qint64 timeQueue(Queue &queue, const std::vector<ScopeFrame> &frames, int items)
+{
+    QElapsedTimer timer;
+    timer.start();
+    std::thread consumer([&queue, items]() {
+        for (int i = 0; i < items; ++i) {
+            queue.pop();
+        }
+    });
+    for (int i = 0; i < items; ++i) {
+        queue.push(frames[(size_t)i % frames.size()]);
+    }
+    consumer.join();
+    return timer.nsecsElapsed();
+}
+
+void benchmarkQueues(BenchmarkReporter &reporter, const std::vector<ScopeFrame> &frames, int items)
+{
+    // Frames are passed between the renderer and the scopes without being dropped
+    {
+        DataQueue<ScopeFrame> queue(8, DataQueue<ScopeFrame>::OverflowModeWait);
+        report(reporter, Result{QStringLiteral("dataqueue"), QStringLiteral("synthetic"), 0, 0, 1, items, QStringLiteral("PerItem"), timeQueue(queue, frames, items)});
+    }
+    {
+        RingQueue<ScopeFrame> queue(8, RingQueue<ScopeFrame>::OverflowModeWait);
+        report(reporter, Result{QStringLiteral("ringqueue"), QStringLiteral("synthetic"), 0, 0, 1, items, QStringLiteral("PerItem"), timeQueue(queue, frames, items)});
+    }
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    // Scopes draw text, which needs a GUI application, but no display is needed
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Measures the cost of the Kdenlive scopes"));
+    parser.addHelpOption();
+    QCommandLineOption iterationsOption(QStringLiteral("iterations"), QStringLiteral("Number of frames analysed per benchmark."), QStringLiteral("count"),
+                                        QStringLiteral("50"));
+    QCommandLineOption sizesOption(QStringLiteral("sizes"), QStringLiteral("Comma separated frame sizes."), QStringLiteral("sizes"),
+                                   QStringLiteral("640x360,1280x720,1920x1080,3840x2160"));
+    QCommandLineOption clipOption(QStringLiteral("clip"), QStringLiteral("Also benchmark frames decoded from this clip."), QStringLiteral("file"));
+    QCommandLineOption csvOption(QStringLiteral("csv"), QStringLiteral("Print CSV instead of JSON lines."));
+    parser.addOption(iterationsOption);
+    parser.addOption(sizesOption);
+    parser.addOption(clipOption);
+    parser.addOption(csvOption);
+    parser.process(app);
+
+    const int iterations = qMax(1, parser.value(iterationsOption).toInt());
+    BenchmarkReporter reporter({QStringLiteral("benchmark"), QStringLiteral("source"), QStringLiteral("width"), QStringLiteral("height"),
+                                QStringLiteral("iterations"), QStringLiteral("unit"), QStringLiteral("nsPerUnit"), QStringLiteral("fps")},
+                               parser.isSet(csvOption));
+    std::vector<ScopeFrame> frames;
+    for (const QString &size : parser.value(sizesOption).split(QLatin1Char(','), QString::SkipEmptyParts)) {
+        const QStringList dimensions = size.split(QLatin1Char('x'));
+        const int width = dimensions.value(0).toInt();
+        const int height = dimensions.value(1).toInt();
+        if (width < 2 || height < 2) {
+            qWarning("Invalid frame size %s", qPrintable(size));
+            return 1;
+        }
+        frames.clear();
+        for (int i = 0; i < 4; ++i) {
+            frames.emplace_back(syntheticImage(width, height, i));
+        }
+        benchmarkColorScopes(reporter, QStringLiteral("synthetic"), frames, iterations);
+    }
+    if (parser.isSet(clipOption)) {
+        Mlt::Factory::init();
+        std::vector<ScopeFrame> decoded = decodedFrames(parser.value(clipOption), 8);
+        if (decoded.empty()) {
+            qWarning("Cannot decode %s", qPrintable(parser.value(clipOption)));
+            return 1;
+        }
+        benchmarkColorScopes(reporter, QStringLiteral("decoded"), decoded, iterations);
+    }
+    benchmarkSpectrum(reporter, iterations * 10);
+    if (frames.empty()) {
+        frames.emplace_back(syntheticImage(64, 64, 0));
+    }
+    benchmarkQueues(reporter, frames, iterations * 1000);
+    return 0;
+}
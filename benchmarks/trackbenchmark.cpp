@@ -0,0 +1,203 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+/*
+  Benchmark of the row bookkeeping of timeline tracks.
+
+  A track uses the id order of its clips as row order, and every view
+  notification converts between ids and rows. This builds a headless timeline
+  and replays, through TimelineItemModel and its TrackModel, the row lookups
+  done by bulk timeline operations on large tracks:
+  - insert: clips are inserted one by one, each insertion notifies its row;
+  - move: all clips are moved to another track, notifying the row on both tracks;
+  - ripple: the first clip is deleted and the index of each following clip is updated;
+  - rows: the index of each row is read, as the views do when they are filled.
+
+  Each result is printed as one JSON object per line (or CSV with --csv):
+    {"benchmark":"ripple","clips":3000,"iterations":10,"nsPerOperation":41.2}
+*/
+
+#include "benchmarkreporter.h"
+#include "bin/model/markerlistmodel.hpp"
+#include "bin/projectfolder.h"
+#include "bin/projectitemmodel.h"
+#include "core.h"
+#include "doc/docundostack.hpp"
+#include "profiles/profilemodel.hpp"
+#include "timeline2/model/timelineitemmodel.hpp"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <memory>
+#include <mlt++/MltProducer.h>
+
+namespace {
+// Duration of the timeline clips, in frames
+const int clipLength = 10;
+
+// Keeps the compiler from dropping lookups whose result is unused
+volatile int sink;
+
+// Adds the color clip from which all the timeline clips are cut
+QString createBinClip()
+{
+    std::shared_ptr<Mlt::Producer> producer =
+        std::make_shared<Mlt::Producer>(pCore->getCurrentProfile()->profile(), "color", "red");
+    producer->set("length", clipLength);
+    producer->set("out", clipLength - 1);
+    QString binId;
+    Fun undo = []() { return true; };
+    Fun redo = []() { return true; };
+    pCore->projectItemModel()->requestAddBinClip(binId, producer, pCore->projectItemModel()->getRootFolder()->clipId(), undo, redo);
+    return binId;
+}
+
+class Timeline
+{
+public:
+    Timeline()
+        : m_undoStack(std::make_shared<DocUndoStack>(nullptr))
+        , m_guides(new MarkerListModel(m_undoStack))
+        , m_model(TimelineItemModel::construct(&pCore->getCurrentProfile()->profile(), m_guides, m_undoStack))
+    {
+        Fun undo = []() { return true; };
+        Fun redo = []() { return true; };
+        m_model->requestTrackInsertion(-1, m_source, QString(), false, undo, redo);
+        m_model->requestTrackInsertion(-1, m_target, QString(), false, undo, redo);
+    }
+
+    const std::shared_ptr<TimelineItemModel> &model() const { return m_model; }
+    int source() const { return m_source; }
+    int target() const { return m_target; }
+
+    // Inserts clips on the source track, one after the other
+    std::vector<int> fill(const QString &binId, int clips)
+    {
+        std::vector<int> ids;
+        for (int i = 0; i < clips; ++i) {
+            int id;
+            m_model->requestClipInsertion(binId, m_source, i * clipLength, id, false, true);
+            ids.push_back(id);
+        }
+        return ids;
+    }
+
+private:
+    std::shared_ptr<DocUndoStack> m_undoStack;
+    std::shared_ptr<MarkerListModel> m_guides;
+    std::shared_ptr<TimelineItemModel> m_model;
+    int m_source = -1;
+    int m_target = -1;
+};
+
+void benchmarkRows(BenchmarkReporter &reporter, const QString &binId, int clips, int iterations)
+{
+    QElapsedTimer timer;
+    qint64 elapsed = 0;
+    for (int i = 0; i < iterations; ++i) {
+        Timeline timeline;
+        timer.start();
+        timeline.fill(binId, clips);
+        elapsed += timer.nsecsElapsed();
+    }
+    reporter.report({QStringLiteral("insert"), clips, iterations, BenchmarkReporter::nsPerUnit(elapsed, iterations, clips)});
+
+    elapsed = 0;
+    for (int i = 0; i < iterations; ++i) {
+        Timeline timeline;
+        const std::vector<int> ids = timeline.fill(binId, clips);
+        timer.start();
+        for (int id : ids) {
+            timeline.model()->requestClipMove(id, timeline.target(), timeline.model()->getClipPosition(id), true, false);
+        }
+        elapsed += timer.nsecsElapsed();
+    }
+    reporter.report({QStringLiteral("move"), clips, iterations, BenchmarkReporter::nsPerUnit(elapsed, iterations, clips)});
+
+    Timeline timeline;
+    std::vector<int> ids = timeline.fill(binId, clips);
+    elapsed = 0;
+    qint64 operations = 0;
+    int ripples = 0;
+    for (int i = 0; i < iterations && ids.size() > 1; ++i, ++ripples) {
+        timer.start();
+        Fun undo = []() { return true; };
+        Fun redo = []() { return true; };
+        timeline.model()->requestItemDeletion(ids.front(), undo, redo);
+        ids.erase(ids.begin());
+        for (int id : ids) {
+            sink = timeline.model()->makeClipIndexFromID(id).row();
+        }
+        elapsed += timer.nsecsElapsed();
+        operations += (qint64)ids.size();
+    }
+    reporter.report({QStringLiteral("ripple"), clips, ripples, BenchmarkReporter::nsPerUnit(elapsed, 1, operations)});
+
+    const QModelIndex track = timeline.model()->makeTrackIndexFromID(timeline.source());
+    const int rows = timeline.model()->rowCount(track);
+    elapsed = 0;
+    for (int i = 0; i < iterations; ++i) {
+        timer.start();
+        for (int row = 0; row < rows; ++row) {
+            sink = (int)timeline.model()->index(row, 0, track).internalId();
+        }
+        elapsed += timer.nsecsElapsed();
+    }
+    reporter.report({QStringLiteral("rows"), clips, iterations, BenchmarkReporter::nsPerUnit(elapsed, iterations, rows)});
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    // The project model creates thumbnails, which needs a GUI application, but no display is needed
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Measures the row bookkeeping of Kdenlive timeline tracks"));
+    parser.addHelpOption();
+    QCommandLineOption iterationsOption(QStringLiteral("iterations"), QStringLiteral("Number of runs of each operation."), QStringLiteral("count"),
+                                        QStringLiteral("10"));
+    QCommandLineOption sizesOption(QStringLiteral("sizes"), QStringLiteral("Comma separated numbers of clips per track."), QStringLiteral("sizes"),
+                                   QStringLiteral("100,1000,3000,10000"));
+    QCommandLineOption csvOption(QStringLiteral("csv"), QStringLiteral("Print CSV instead of JSON lines."));
+    parser.addOption(iterationsOption);
+    parser.addOption(sizesOption);
+    parser.addOption(csvOption);
+    parser.process(app);
+
+    const int iterations = qMax(1, parser.value(iterationsOption).toInt());
+    BenchmarkReporter reporter({QStringLiteral("benchmark"), QStringLiteral("clips"), QStringLiteral("iterations"), QStringLiteral("nsPerOperation")},
+                               parser.isSet(csvOption));
+    Core::build();
+    const QString binId = createBinClip();
+    for (const QString &size : parser.value(sizesOption).split(QLatin1Char(','), QString::SkipEmptyParts)) {
+        const int clips = size.toInt();
+        if (clips < 1) {
+            qWarning("Invalid track size %s", qPrintable(size));
+            return 1;
+        }
+        benchmarkRows(reporter, binId, clips, iterations);
+    }
+    return 0;
+}
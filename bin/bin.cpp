@@ -2999,10 +2999,9 @@ void Bin::slotSendAudioThumb(const QString &id)
 {
     std::shared_ptr<ProjectClip> clip = m_itemModel->getClipByBinID(id);
     if ((clip != nullptr) && clip->audioThumbCreated()) {
-        m_monitor->prepareAudioThumb(clip->audioChannels(), clip->audioFrameCache);
+        m_monitor->prepareAudioThumb(clip->audioPeaks());
     } else {
-        QVariantList list;
-        m_monitor->prepareAudioThumb(0, list);
+        m_monitor->prepareAudioThumb(nullptr);
     }
 }
 
@@ -65,7 +65,6 @@ public:
      */
     bool addMarker(GenTime pos, const QString &comment, int type = -1);
 
-protected:
     /* @brief Same function but accumulates undo/redo */
     bool addMarker(GenTime pos, const QString &comment, int type, Fun &undo, Fun &redo);
 
@@ -27,6 +27,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "doc/kdenlivedoc.h"
 #include "doc/kthumb.h"
 #include "effects/effectstack/model/effectstackmodel.hpp"
+#include "jobs/audiothumbjob.hpp"
 #include "jobs/jobmanager.h"
 #include "jobs/thumbjob.hpp"
 #include "jobs/loadjob.hpp"
@@ -64,6 +65,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 ProjectClip::ProjectClip(const QString &id, const QIcon &thumb, std::shared_ptr<ProjectItemModel> model, std::shared_ptr<Mlt::Producer> producer)
     : AbstractProjectItem(AbstractProjectItem::ClipItem, id, model)
     , ClipController(id, producer)
+    , m_detailGeneration(0)
     , m_thumbsProducer(nullptr)
 {
     m_markerModel = std::make_shared<MarkerListModel>(id, pCore->projectManager()->undoStack());
@@ -104,6 +106,7 @@ std::shared_ptr<ProjectClip> ProjectClip::construct(const QString &id, const QIc
 ProjectClip::ProjectClip(const QString &id, const QDomElement &description, const QIcon &thumb, std::shared_ptr<ProjectItemModel> model)
     : AbstractProjectItem(AbstractProjectItem::ClipItem, id, model)
     , ClipController(id)
+    , m_detailGeneration(0)
     , m_thumbsProducer(nullptr)
 {
     m_clipStatus = StatusWaiting;
@@ -145,7 +148,10 @@ ProjectClip::~ProjectClip()
     m_requestedThumbs.clear();
     m_thumbMutex.unlock();
     m_thumbThread.waitForFinished();
-    audioFrameCache.clear();
+    m_audioPeaks.reset();
+    m_detailMutex.lock();
+    m_audioDetail.clear();
+    m_detailMutex.unlock();
     // delete all timeline producers
     std::map<int, std::shared_ptr<Mlt::Producer>>::iterator itr = m_timelineProducers.begin();
     while (itr != m_timelineProducers.end()) {
@@ -165,6 +171,11 @@ void ProjectClip::connectEffectStack()
 
 QString ProjectClip::getToolTip() const
 {
+    if (m_loudness.valid) {
+        return url() + QLatin1Char('\n') +
+               i18n("Loudness: %1 LUFS, range: %2 LU, true peak: %3 dBTP", QString::number(m_loudness.integrated, 'f', 1),
+                    QString::number(m_loudness.range, 'f', 1), QString::number(m_loudness.truePeak, 'f', 1));
+    }
     return url();
 }
 
@@ -181,16 +192,121 @@ QString ProjectClip::getXmlProperty(const QDomElement &producer, const QString &
     return value;
 }
 
-void ProjectClip::updateAudioThumbnail(QVariantList audioLevels)
+void ProjectClip::updateAudioThumbnail(std::shared_ptr<const AudioPeaks> peaks)
 {
-    std::swap(audioFrameCache, audioLevels); // avoid second copy
-    m_audioThumbCreated = true;
+    m_audioPeaks = std::move(peaks);
+    m_audioThumbCreated = m_audioPeaks != nullptr;
     if (auto ptr = m_model.lock()) {
         emit std::static_pointer_cast<ProjectItemModel>(ptr)->refreshAudioThumbs(m_binId);
     }
     updateTimelineClips({TimelineModel::AudioLevelsRole});
 }
 
+void ProjectClip::updateLoudness(const LoudnessInfo &info)
+{
+    m_loudness = info;
+}
+
+std::shared_ptr<const AudioPeaks> ProjectClip::audioPeaks() const
+{
+    return m_audioPeaks;
+}
+
+std::shared_ptr<const AudioPeaks> ProjectClip::audioDetail(int frame)
+{
+    QMutexLocker locker(&m_detailMutex);
+    auto it = m_audioDetail.find(frame / AudioDetailChunk);
+    return it == m_audioDetail.end() ? nullptr : it->second;
+}
+
+void ProjectClip::requestAudioDetail(int from, int to)
+{
+    if (!KdenliveSettings::audiothumbdetail() || !m_audioThumbCreated || audioChannels() <= 0) {
+        return;
+    }
+    int length = getFramePlaytime();
+    from = qMax(0, from);
+    to = qMin(length, to);
+    QList<int> chunks;
+    m_detailMutex.lock();
+    for (int chunk = from / AudioDetailChunk; chunk * AudioDetailChunk < to; ++chunk) {
+        if (m_audioDetail.count(chunk) == 0 && m_pendingDetail.count(chunk) == 0 && m_failedDetail.count(chunk) == 0) {
+            m_pendingDetail.insert(chunk);
+            chunks << chunk;
+        }
+    }
+    int generation = m_detailGeneration;
+    m_detailMutex.unlock();
+    if (chunks.isEmpty()) {
+        return;
+    }
+    std::weak_ptr<ProjectClip> weakClip = std::static_pointer_cast<ProjectClip>(shared_from_this());
+    std::shared_ptr<Mlt::Producer> prod = originalProducer();
+    int channels = audioChannels();
+    int frequency = audioInfo()->samplingRate();
+    frequency = frequency <= 0 ? 48000 : frequency;
+    QtConcurrent::run([weakClip, prod, chunks, channels, frequency, length, generation]() {
+        for (int chunk : chunks) {
+            {
+                // Stop if the audio thumbnail was discarded, the remaining chunks are not needed anymore
+                auto clip = weakClip.lock();
+                if (!clip || !clip->isAudioDetailValid(generation)) {
+                    return;
+                }
+            }
+            int first = chunk * AudioDetailChunk;
+            std::shared_ptr<AudioPeaks> peaks =
+                AudioThumbJob::computeDetail(prod, channels, frequency, first, qMin(AudioDetailChunk, length - first), AudioDetailLevels);
+            if (peaks) {
+                peaks->buildPyramid();
+            }
+            auto clip = weakClip.lock();
+            if (!clip) {
+                return;
+            }
+            clip->storeAudioDetail(generation, chunk, peaks);
+        }
+    });
+}
+
+bool ProjectClip::isAudioDetailValid(int generation)
+{
+    QMutexLocker locker(&m_detailMutex);
+    return generation == m_detailGeneration;
+}
+
+void ProjectClip::storeAudioDetail(int generation, int chunk, const std::shared_ptr<const AudioPeaks> &peaks)
+{
+    m_detailMutex.lock();
+    if (generation != m_detailGeneration) {
+        // Computed before the audio thumbnail was discarded
+        m_detailMutex.unlock();
+        return;
+    }
+    m_pendingDetail.erase(chunk);
+    if (!peaks) {
+        // Remember the failure, so that repaints do not request the chunk again
+        m_failedDetail.insert(chunk);
+    } else {
+        m_audioDetail[chunk] = peaks;
+        // Detail is only needed around the zoomed area, drop the chunks that are the farthest from the new one
+        while (m_audioDetail.size() > 64) {
+            auto first = m_audioDetail.begin();
+            auto last = std::prev(m_audioDetail.end());
+            m_audioDetail.erase(chunk - first->first > last->first - chunk ? first : last);
+        }
+    }
+    m_detailMutex.unlock();
+    if (peaks) {
+        emit audioDetailReady();
+    }
+}
+
+LoudnessInfo ProjectClip::loudness() const
+{
+    return m_loudness;
+}
+
 bool ProjectClip::audioThumbCreated() const
 {
     return (m_audioThumbCreated);
@@ -818,13 +934,30 @@ void ProjectClip::discardAudioThumb()
     if (!audioThumbPath.isEmpty()) {
         QFile::remove(audioThumbPath);
     }
-    audioFrameCache.clear();
+    QString loudnessPath = getLoudnessPath();
+    if (!loudnessPath.isEmpty()) {
+        QFile::remove(loudnessPath);
+    }
+    QString envelopePath = getAudioEnvelopePath();
+    if (!envelopePath.isEmpty()) {
+        QFile::remove(envelopePath);
+    }
+    m_audioPeaks.reset();
+    m_detailMutex.lock();
+    // Pending computations are stopped and their results dropped
+    m_detailGeneration++;
+    m_audioDetail.clear();
+    m_pendingDetail.clear();
+    m_failedDetail.clear();
+    m_detailMutex.unlock();
+    m_loudness = LoudnessInfo();
     qCDebug(KDENLIVE_LOG) << "////////////////////  DISCARD AUIIO THUMBNS";
     m_audioThumbCreated = false;
     pCore->jobManager()->discardJobs(clipId(), AbstractClipJob::AUDIOTHUMBJOB);
+    pCore->jobManager()->discardJobs(clipId(), AbstractClipJob::LOUDNESSJOB);
 }
 
-const QString ProjectClip::getAudioThumbPath()
+const QString ProjectClip::getAudioCachePrefix()
 {
     if (audioInfo() == nullptr) {
         return QString();
@@ -843,11 +976,55 @@ const QString ProjectClip::getAudioThumbPath()
     if (audioStream > 0) {
         audioPath.append(QLatin1Char('_') + QString::number(audioInfo()->audio_index()));
     }
+    return audioPath;
+}
+
+const QString ProjectClip::getAudioThumbPath()
+{
+    QString audioPath = getAudioCachePrefix();
+    if (audioPath.isEmpty()) {
+        return QString();
+    }
+    int roundedFps = (int)pCore->getCurrentFps();
+    audioPath.append(QStringLiteral("_%1_audio.peaks").arg(roundedFps));
+    return audioPath;
+}
+
+const QString ProjectClip::getLoudnessPath()
+{
+    QString audioPath = getAudioCachePrefix();
+    if (audioPath.isEmpty()) {
+        return QString();
+    }
+    audioPath.append(QStringLiteral("_loudness.json"));
+    return audioPath;
+}
+
+const QString ProjectClip::getAudioEnvelopePath()
+{
+    QString audioPath = getAudioCachePrefix();
+    if (audioPath.isEmpty()) {
+        return QString();
+    }
     int roundedFps = (int)pCore->getCurrentFps();
-    audioPath.append(QStringLiteral("_%1_audio.png").arg(roundedFps));
+    audioPath.append(QStringLiteral("_%1_envelope.bin").arg(roundedFps));
     return audioPath;
 }
 
+const QString ProjectClip::getLegalityReportPath()
+{
+    QString clipHash = hash();
+    if (clipHash.isEmpty()) {
+        return QString();
+    }
+    bool ok = false;
+    QDir thumbFolder = pCore->currentDoc()->getCacheDir(CacheThumbs, &ok);
+    if (!ok) {
+        return QString();
+    }
+    return thumbFolder.absoluteFilePath(clipHash + QStringLiteral("_legality.qc"));
+}
+
 bool ProjectClip::isTransparent() const
 {
     if (m_clipType == ClipType::Text) {
@@ -25,6 +25,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "abstractprojectitem.h"
 #include "definitions.h"
+#include "lib/audio/loudnessMeter.h"
 #include "mltcontroller/clipcontroller.h"
 #include "timeline2/model/timelinemodel.hpp"
 
@@ -32,7 +33,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QMutex>
 #include <QUrl>
 #include <memory>
+#include <unordered_set>
 
+class AudioPeaks;
 class AudioStreamInfo;
 class ClipPropertiesController;
 class MarkerListModel;
@@ -159,9 +162,16 @@ public:
     /** @brief Returns true if we are using a proxy for this clip. */
     bool hasProxy() const;
 
-    /** Cache for every audio Frame with 10 Bytes */
-    /** format is frame -> channel ->bytes */
-    QVariantList audioFrameCache;
+    /** @brief Returns the audio thumbnail (min / max peaks per frame and channel), nullptr if not created yet */
+    std::shared_ptr<const AudioPeaks> audioPeaks() const;
+    /** @brief Number of frames of a detailed audio thumbnail chunk */
+    static const int AudioDetailChunk = 250;
+    /** @brief Number of min / max pairs per frame in detailed audio thumbnails */
+    static const int AudioDetailLevels = 32;
+    /** @brief Returns the detailed audio thumbnail of the chunk containing the frame, nullptr if it was not computed */
+    std::shared_ptr<const AudioPeaks> audioDetail(int frame);
+    /** @brief Compute the detailed audio thumbnail of a range of frames in a background thread. audioDetailReady is emitted when done */
+    void requestAudioDetail(int from, int to);
     bool audioThumbCreated() const;
 
     void setWaitingStatus(const QString &id);
@@ -179,6 +189,14 @@ public:
     void discardAudioThumb();
     /** @brief Get path for this clip's audio thumbnail */
     const QString getAudioThumbPath();
+    /** @brief Get path for this clip's cached loudness analysis, stored next to the audio thumbnail */
+    const QString getLoudnessPath();
+    /** @brief Get path for this clip's cached audio envelope, used for audio alignment */
+    const QString getAudioEnvelopePath();
+    /** @brief Get path for this clip's broadcast legality report */
+    const QString getLegalityReportPath();
+    /** @brief Returns the result of the loudness analysis, invalid if not computed yet */
+    LoudnessInfo loudness() const;
     /** @brief Returns true if this producer has audio and can be splitted on timeline*/
     bool isSplittable() const;
 
@@ -215,15 +233,30 @@ protected:
     void connectEffectStack();
 
 public slots:
-    /* @brief Store the audio thumbnails once computed. Note that the parameter is a value and not a reference, fill free to use it as a sink (use std::move to
-     * avoid copy). */
-    void updateAudioThumbnail(QVariantList audioLevels);
+    /* @brief Store the audio thumbnails once computed. */
+    void updateAudioThumbnail(std::shared_ptr<const AudioPeaks> peaks);
+    /* @brief Store the loudness analysis once computed. */
+    void updateLoudness(const LoudnessInfo &info);
     /** @brief Extract image thumbnails for timeline. */
     void slotExtractImage(const QList<int> &frames);
 
 private:
     /** @brief Generate and store file hash if not available. */
     const QString getFileHash();
+    /** @brief Returns the common prefix of the audio cache files of this clip */
+    const QString getAudioCachePrefix();
+    LoudnessInfo m_loudness;
+    std::shared_ptr<const AudioPeaks> m_audioPeaks;
+    /** @brief Detailed audio thumbnails, computed on demand and indexed by chunk */
+    std::map<int, std::shared_ptr<const AudioPeaks>> m_audioDetail;
+    std::unordered_set<int> m_pendingDetail;
+    /** @brief Chunks that could not be decoded */
+    std::unordered_set<int> m_failedDetail;
+    QMutex m_detailMutex;
+    /** @brief Incremented when the audio thumbnail is discarded, so that detail computed before is dropped */
+    int m_detailGeneration;
+    bool isAudioDetailValid(int generation);
+    void storeAudioDetail(int generation, int chunk, const std::shared_ptr<const AudioPeaks> &peaks);
     /** @brief Store clip url temporarily while the clip controller has not been created. */
     QString m_temporaryUrl;
     std::shared_ptr<Mlt::Producer> m_thumbsProducer;
@@ -245,6 +278,8 @@ signals:
     void thumbReady(int, const QImage &);
     /** @brief Clip is ready, load properties. */
     void loadPropertiesPanel();
+    /** @brief A detailed audio thumbnail chunk was computed. */
+    void audioDetailReady();
 };
 
 #endif
@@ -28,6 +28,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "jobs/audiothumbjob.hpp"
 #include "jobs/jobmanager.h"
 #include "jobs/loadjob.hpp"
+#include "jobs/loudnessjob.hpp"
 #include "jobs/thumbjob.hpp"
 #include "kdenlivesettings.h"
 #include "macros.hpp"
@@ -534,7 +535,8 @@ bool ProjectItemModel::requestAddBinClip(QString &id, const QDomElement &descrip
     if (res) {
         int loadJob = pCore->jobManager()->startJob<LoadJob>({id}, -1, QString(), description);
         pCore->jobManager()->startJob<ThumbJob>({id}, loadJob, QString(), 150, 0, true);
-        pCore->jobManager()->startJob<AudioThumbJob>({id}, loadJob, QString());
+        int audioThumbJob = pCore->jobManager()->startJob<AudioThumbJob>({id}, loadJob, QString());
+        pCore->jobManager()->startJob<LoudnessJob>({id}, audioThumbJob, QString());
     }
     return res;
 }
@@ -565,7 +567,8 @@ bool ProjectItemModel::requestAddBinClip(QString &id, std::shared_ptr<Mlt::Produ
     if (res) {
         int blocking = pCore->jobManager()->getBlockingJobId(id, AbstractClipJob::LOADJOB);
         pCore->jobManager()->startJob<ThumbJob>({id}, blocking, QString(), 150, -1, true);
-        pCore->jobManager()->startJob<AudioThumbJob>({id}, blocking, QString());
+        int audioThumbJob = pCore->jobManager()->startJob<AudioThumbJob>({id}, blocking, QString());
+        pCore->jobManager()->startJob<LoudnessJob>({id}, audioThumbJob, QString());
     }
     return res;
 }
@@ -24,9 +24,12 @@
 
 #include "kdenlive_debug.h"
 
+#include <QMetaMethod>
+#include <QResizeEvent>
 #include <QString>
 #include <QThread>
 #include <QTimer>
+#include <QWidget>
 
 #include <cstdarg>
 #include <cstdlib>
@@ -58,6 +61,20 @@ MltDeviceCapture::MltDeviceCapture(QString profile, /*VideoSurface *surface, */
     m_droppedFramesTimer.setSingleShot(false);
     m_droppedFramesTimer.setInterval(1000);
     connect(&m_droppedFramesTimer, &QTimer::timeout, this, &MltDeviceCapture::slotCheckDroppedFrames);
+    if (parent != nullptr) {
+        // Preview images are converted at the size of the capture monitor
+        setPreviewSize(parent->size() * parent->devicePixelRatioF());
+        parent->installEventFilter(this);
+    }
+}
+
+bool MltDeviceCapture::eventFilter(QObject *obj, QEvent *event)
+{
+    if (event->type() == QEvent::Resize && obj == parent()) {
+        auto *widget = static_cast<QWidget *>(obj);
+        setPreviewSize(static_cast<QResizeEvent *>(event)->size() * widget->devicePixelRatioF());
+    }
+    return AbstractRender::eventFilter(obj, event);
 }
 
 MltDeviceCapture::~MltDeviceCapture()
@@ -94,7 +111,7 @@ bool MltDeviceCapture::buildConsumer(const QString &profileName)
     // OpenGL monitor
     m_mltConsumer = new Mlt::Consumer(*m_mltProfile, KdenliveSettings::audiobackend().toUtf8().constData());
     m_mltConsumer->set("preview_off", 1);
-    m_mltConsumer->set("preview_format", mlt_image_rgb24);
+    m_mltConsumer->set("preview_format", mlt_image_yuv422);
     m_showFrameEvent = m_mltConsumer->listen("consumer-frame-show", this, (mlt_listener)consumer_gl_frame_show);
     // m_mltConsumer->set("resize", 1);
     // m_mltConsumer->set("terminate_on_pause", 1);
@@ -192,42 +209,54 @@ void MltDeviceCapture::stop()
     m_mltConsumer = nullptr;
 }
 
-void MltDeviceCapture::emitFrameUpdated(Mlt::Frame &frame)
+QImage MltDeviceCapture::previewImage(Mlt::Frame &frame)
 {
-    /*
-    //TEST: is it better to convert the frame in a thread outside of MLT??
-    if (processingImage) return;
-    mlt_image_format format = (mlt_image_format) frame.get_int("format"); //mlt_image_rgb24;
-    int width = frame.get_int("width");
-    int height = frame.get_int("height");
-    unsigned char *buffer = (unsigned char *) frame.get_data("image");
-    if (format == mlt_image_yuv422) {
-        QtConcurrent::run(this, &MltDeviceCapture::uyvy2rgb, (unsigned char *) buffer, width, height);
-    }
-    */
-
-    mlt_image_format format = mlt_image_rgb24;
+    // Capture devices deliver packed 4:2:2, requesting it avoids a conversion in MLT
+    mlt_image_format format = mlt_image_yuv422;
     int width = 0;
     int height = 0;
     const uchar *image = frame.get_image(format, width, height);
-    QImage qimage(width, height, QImage::Format_RGB888);
-    // QImage qimage(width, height, QImage::Format_ARGB32_Premultiplied);
-    memcpy(qimage.bits(), image, (size_t)(width * height * 3));
-    emit frameUpdated(qimage);
+    m_previewSizeMutex.lock();
+    const QSize size = m_previewSize;
+    m_previewSizeMutex.unlock();
+    if (format == mlt_image_yuv420p) {
+        return m_converter.convert(image, YuvConverter::YUV420P, width, height, size);
+    }
+    if (format != mlt_image_yuv422) {
+        return QImage();
+    }
+    return m_converter.convert(image, YuvConverter::YUYV, width, height, size);
 }
 
-void MltDeviceCapture::showFrame(Mlt::Frame &frame)
+void MltDeviceCapture::setPreviewSize(const QSize &size)
 {
-    mlt_image_format format = mlt_image_rgb24;
-    int width = 0;
-    int height = 0;
-    const uchar *image = frame.get_image(format, width, height);
-    QImage qimage(width, height, QImage::Format_RGB888);
-    memcpy(qimage.scanLine(0), image, static_cast<size_t>(width * height * 3));
-    emit showImageSignal(qimage);
+    // Called from the GUI thread, the size is read by the consumer thread
+    QMutexLocker lock(&m_previewSizeMutex);
+    m_previewSize = size;
+}
+
+void MltDeviceCapture::emitFrameUpdated(Mlt::Frame &frame)
+{
+    emit frameUpdated(previewImage(frame));
+}
 
-    if (sendFrameForAnalysis && (frame.get_frame()->convert_image != nullptr)) {
-        emit frameUpdated(qimage.rgbSwapped());
+void MltDeviceCapture::showFrame(Mlt::Frame &frame)
+{
+    // Only convert the frame when someone will use it
+    bool display = isSignalConnected(QMetaMethod::fromSignal(&MltDeviceCapture::showImageSignal));
+    bool analyse = sendFrameForAnalysis && (frame.get_frame()->convert_image != nullptr);
+    if (!display && !analyse) {
+        return;
+    }
+    QImage qimage = previewImage(frame);
+    if (qimage.isNull()) {
+        return;
+    }
+    if (display) {
+        emit showImageSignal(qimage);
+    }
+    if (analyse) {
+        emit frameUpdated(qimage);
     }
 }
 
@@ -237,21 +266,15 @@ void MltDeviceCapture::showAudio(Mlt::Frame &frame)
         return;
     }
     mlt_audio_format audio_format = mlt_audio_s16;
-    int freq = 0;
-    int num_channels = 0;
-    int samples = 0;
-    qint16 *data = (qint16 *)frame.get_audio(audio_format, freq, num_channels, samples);
-
-    if (!data) {
+    int freq = frame.get_int("audio_frequency");
+    int num_channels = frame.get_int("audio_channels");
+    int samples = frame.get_int("audio_samples");
+    if (frame.get_audio(audio_format, freq, num_channels, samples) == nullptr) {
         return;
     }
-
-    // Data format: [ c00 c10 c01 c11 c02 c12 c03 c13 ... c0{samples-1} c1{samples-1} for 2 channels.
-    // So the vector is of size samples*channels.
-    audioShortVector sampleVector(samples * num_channels);
-    memcpy(sampleVector.data(), data, (size_t)(samples * num_channels) * sizeof(qint16));
-    if (samples > 0) {
-        emit audioSamplesSignal(sampleVector, freq, num_channels, samples);
+    AudioBlock block{SharedFrame(frame)};
+    if (block.isValid()) {
+        emit audioSamplesSignal(block);
     }
 }
 
@@ -398,7 +421,7 @@ bool MltDeviceCapture::slotStartCapture(const QString &params, const QString &pa
         // OpenGL monitor
         previewProps->set("mlt_service", KdenliveSettings::audiobackend().toUtf8().constData());
         previewProps->set("preview_off", 1);
-        previewProps->set("preview_format", mlt_image_rgb24);
+        previewProps->set("preview_format", mlt_image_yuv422);
         previewProps->set("terminate_on_pause", 0);
         m_showFrameEvent = m_mltConsumer->listen("consumer-frame-show", this, (mlt_listener)consumer_gl_frame_show);
         // m_mltConsumer->set("resize", 1);
@@ -596,88 +619,6 @@ void MltDeviceCapture::mirror(bool activate)
     mlt_service_unlock(service.get_service());
 }
 
-void MltDeviceCapture::uyvy2rgb(unsigned char *yuv_buffer, int width, int height)
-{
-    processingImage = true;
-    QImage image(width, height, QImage::Format_RGB888);
-    unsigned char *rgb_buffer = image.bits();
-
-    int rgb_ptr = 0, y_ptr = 0;
-    int len = width * height / 2;
-
-    for (int t = 0; t < len; ++t) {
-        int Y = yuv_buffer[y_ptr];
-        int U = yuv_buffer[y_ptr + 1];
-        int Y2 = yuv_buffer[y_ptr + 2];
-        int V = yuv_buffer[y_ptr + 3];
-        y_ptr += 4;
-
-        int r = ((298 * (Y - 16) + 409 * (V - 128) + 128) >> 8);
-
-        int g = ((298 * (Y - 16) - 100 * (U - 128) - 208 * (V - 128) + 128) >> 8);
-
-        int b = ((298 * (Y - 16) + 516 * (U - 128) + 128) >> 8);
-
-        if (r > 255) {
-            r = 255;
-        }
-        if (g > 255) {
-            g = 255;
-        }
-        if (b > 255) {
-            b = 255;
-        }
-
-        if (r < 0) {
-            r = 0;
-        }
-        if (g < 0) {
-            g = 0;
-        }
-        if (b < 0) {
-            b = 0;
-        }
-
-        rgb_buffer[rgb_ptr] = static_cast<uchar>(r);
-        rgb_buffer[rgb_ptr + 1] = static_cast<uchar>(g);
-        rgb_buffer[rgb_ptr + 2] = static_cast<uchar>(b);
-        rgb_ptr += 3;
-
-        r = ((298 * (Y2 - 16) + 409 * (V - 128) + 128) >> 8);
-        g = ((298 * (Y2 - 16) - 100 * (U - 128) - 208 * (V - 128) + 128) >> 8);
-        b = ((298 * (Y2 - 16) + 516 * (U - 128) + 128) >> 8);
-
-        if (r > 255) {
-            r = 255;
-        }
-        if (g > 255) {
-            g = 255;
-        }
-        if (b > 255) {
-            b = 255;
-        }
-
-        if (r < 0) {
-            r = 0;
-        }
-        if (g < 0) {
-            g = 0;
-        }
-        if (b < 0) {
-            b = 0;
-        }
-
-        rgb_buffer[rgb_ptr] = static_cast<uchar>(r);
-        rgb_buffer[rgb_ptr + 1] = static_cast<uchar>(g);
-        rgb_buffer[rgb_ptr + 2] = static_cast<uchar>(b);
-        rgb_ptr += 3;
-    }
-    // emit imageReady(image);
-    // m_captureDisplayWidget->setImage(image);
-    emit unblockPreview();
-    // processingImage = false;
-}
-
 void MltDeviceCapture::slotPreparePreview()
 {
     QTimer::singleShot(1000, this, &MltDeviceCapture::slotAllowPreview);
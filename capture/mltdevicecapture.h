@@ -29,8 +29,10 @@
 #include "definitions.h"
 #include "gentime.h"
 #include "monitor/abstractmonitor.h"
+#include "yuvconverter.h"
 
 #include <QMutex>
+#include <QSize>
 #include <QTimer>
 
 // include after QTimer to have C++ phtreads defined
@@ -70,6 +72,9 @@ class MltDeviceCapture : public AbstractRender
     void emitConsumerStopped();
     void showFrame(Mlt::Frame &);
     void showAudio(Mlt::Frame &);
+    /** @brief Frames sent for display and analysis are downscaled to fit in this size, no downscale if invalid.
+     *  It follows the size of the parent widget automatically. */
+    void setPreviewSize(const QSize &size);
 
     void saveFrame(Mlt::Frame &frame);
 
@@ -96,6 +101,10 @@ class MltDeviceCapture : public AbstractRender
 
     void pause();
 
+protected:
+    /** @brief Follows the size of the capture monitor, to update the preview size. */
+    bool eventFilter(QObject *obj, QEvent *event) override;
+
 private:
     Mlt::Consumer *m_mltConsumer;
     Mlt::Producer *m_mltProducer;
@@ -108,7 +117,14 @@ private:
     /** @brief Count captured frames, used to display only one in ten images while capturing. */
     int m_frameCount;
 
-    void uyvy2rgb(unsigned char *yuv_buffer, int width, int height);
+    /** @brief Size the preview images fit in. */
+    QSize m_previewSize;
+    QMutex m_previewSizeMutex;
+    /** @brief Converts the device frames to RGB, reusing the preview images. Only used from the consumer thread. */
+    YuvConverter m_converter;
+
+    /** @brief Converts the frame image to RGB for display and analysis. */
+    QImage previewImage(Mlt::Frame &frame);
 
     QString m_capturePath;
 
@@ -0,0 +1,203 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "yuvconverter.h"
+
+#include <algorithm>
+
+namespace {
+// Studio range Rec. 601 coefficients, in 1/256
+const int ky = 298;
+const int rv = 409;
+const int gu = 100;
+const int gv = 208;
+const int bu = 516;
+// Number of images kept for reuse: one being displayed, one queued, one being converted
+const size_t imagePoolSize = 3;
+
+inline uint packRgb(int r, int g, int b)
+{
+    r = std::min(std::max(r >> 8, 0), 255);
+    g = std::min(std::max(g >> 8, 0), 255);
+    b = std::min(std::max(b >> 8, 0), 255);
+    return 0xff000000u | ((uint)r << 16) | ((uint)g << 8) | (uint)b;
+}
+
+inline uint toRgb(int y, int u, int v)
+{
+    const int c = ky * (y - 16) + 128;
+    u -= 128;
+    v -= 128;
+    return packRgb(c + rv * v, c - gu * u - gv * v, c + bu * u);
+}
+
+// Full resolution line of a packed 4:2:2 frame, two pixels share their chroma
+void convertPackedLine(const uchar *line, int lumaOffset, int uOffset, int vOffset, int width, uint *out)
+{
+    const int pairs = width / 2;
+    for (int i = 0; i < pairs; ++i) {
+        const uchar *pixels = line + 4 * i;
+        const int u = pixels[uOffset] - 128;
+        const int v = pixels[vOffset] - 128;
+        const int c0 = ky * (pixels[lumaOffset] - 16) + 128;
+        const int c1 = ky * (pixels[lumaOffset + 2] - 16) + 128;
+        const int r = rv * v;
+        const int g = -gu * u - gv * v;
+        const int b = bu * u;
+        out[2 * i] = packRgb(c0 + r, c0 + g, c0 + b);
+        out[2 * i + 1] = packRgb(c1 + r, c1 + g, c1 + b);
+    }
+}
+
+// Full resolution line of a planar 4:2:0 frame
+void convertPlanarLine(const uchar *y, const uchar *u, const uchar *v, int width, uint *out)
+{
+    const int pairs = width / 2;
+    for (int i = 0; i < pairs; ++i) {
+        const int cu = u[i] - 128;
+        const int cv = v[i] - 128;
+        const int c0 = ky * (y[2 * i] - 16) + 128;
+        const int c1 = ky * (y[2 * i + 1] - 16) + 128;
+        const int r = rv * cv;
+        const int g = -gu * cu - gv * cv;
+        const int b = bu * cu;
+        out[2 * i] = packRgb(c0 + r, c0 + g, c0 + b);
+        out[2 * i + 1] = packRgb(c1 + r, c1 + g, c1 + b);
+    }
+    if ((width & 1) != 0) {
+        out[width - 1] = toRgb(y[width - 1], u[pairs - 1], v[pairs - 1]);
+    }
+}
+
+// Downscaled line, only the samples of the output pixels are read
+void convertScaledLine(const uchar *y, const uchar *u, const uchar *v, const int *lumaOffsets, const int *chromaOffsets, int outputWidth, uint *out)
+{
+    for (int x = 0; x < outputWidth; ++x) {
+        out[x] = toRgb(y[lumaOffsets[x]], u[chromaOffsets[x]], v[chromaOffsets[x]]);
+    }
+}
+} // namespace
+
+YuvConverter::YuvConverter()
+    : m_format(YUV420P)
+    , m_width(0)
+    , m_outputWidth(0)
+    , m_nextImage(0)
+{
+}
+
+QImage &YuvConverter::image(const QSize &size)
+{
+    // An image only referenced by the pool is not used by anyone anymore
+    for (QImage &candidate : m_images) {
+        if (candidate.size() == size && candidate.isDetached()) {
+            return candidate;
+        }
+    }
+    if (m_images.size() < imagePoolSize) {
+        m_images.emplace_back(size, QImage::Format_RGB32);
+        return m_images.back();
+    }
+    // The replaced image stays alive as long as someone holds it
+    QImage &replaced = m_images[m_nextImage];
+    m_nextImage = (m_nextImage + 1) % imagePoolSize;
+    replaced = QImage(size, QImage::Format_RGB32);
+    return replaced;
+}
+
+void YuvConverter::prepareColumns(Format format, int width, int outputWidth)
+{
+    if (format == m_format && width == m_width && outputWidth == m_outputWidth) {
+        return;
+    }
+    m_format = format;
+    m_width = width;
+    m_outputWidth = outputWidth;
+    m_lumaOffsets.resize((size_t)outputWidth);
+    m_chromaOffsets.resize((size_t)outputWidth);
+    for (int x = 0; x < outputWidth; ++x) {
+        // Center of the output pixel in the source line
+        const int source = std::min(width - 1, (int)(((qint64)x * 2 + 1) * width / (2 * outputWidth)));
+        switch (format) {
+        case UYVY:
+            m_lumaOffsets[x] = 2 * source + 1;
+            m_chromaOffsets[x] = 4 * (source / 2);
+            break;
+        case YUYV:
+            m_lumaOffsets[x] = 2 * source;
+            m_chromaOffsets[x] = 4 * (source / 2) + 1;
+            break;
+        case YUV420P:
+            m_lumaOffsets[x] = source;
+            m_chromaOffsets[x] = std::min(source / 2, width / 2 - 1);
+            break;
+        }
+    }
+}
+
+QImage YuvConverter::convert(const uchar *data, Format format, int width, int height, const QSize &targetSize)
+{
+    if (data == nullptr || width < 2 || height < 2) {
+        return QImage();
+    }
+    QSize outputSize(width, height);
+    if (targetSize.isValid() && (targetSize.width() < width || targetSize.height() < height)) {
+        outputSize.scale(targetSize, Qt::KeepAspectRatio);
+        outputSize = outputSize.expandedTo(QSize(1, 1));
+    }
+    // Written while only the pool references it, so that scanLine() does not detach
+    QImage &result = image(outputSize);
+    const int outputWidth = outputSize.width();
+    const int outputHeight = outputSize.height();
+    const bool scaled = outputWidth != width;
+    if (scaled) {
+        prepareColumns(format, width, outputWidth);
+    }
+    const int chromaWidth = width / 2;
+    const uchar *uPlane = data + width * height;
+    const uchar *vPlane = uPlane + chromaWidth * (height / 2);
+    for (int row = 0; row < outputHeight; ++row) {
+        const int sourceRow = outputHeight == height ? row : std::min(height - 1, (int)(((qint64)row * 2 + 1) * height / (2 * outputHeight)));
+        auto *out = reinterpret_cast<uint *>(result.scanLine(row));
+        if (format == YUV420P) {
+            const uchar *y = data + sourceRow * width;
+            const int chromaRow = std::min(sourceRow / 2, height / 2 - 1);
+            const uchar *u = uPlane + chromaRow * chromaWidth;
+            const uchar *v = vPlane + chromaRow * chromaWidth;
+            if (scaled) {
+                convertScaledLine(y, u, v, m_lumaOffsets.data(), m_chromaOffsets.data(), outputWidth, out);
+            } else {
+                convertPlanarLine(y, u, v, width, out);
+            }
+            continue;
+        }
+        // V follows U two bytes later in both packed formats
+        const uchar *line = data + 2 * sourceRow * width;
+        if (scaled) {
+            convertScaledLine(line, line, line + 2, m_lumaOffsets.data(), m_chromaOffsets.data(), outputWidth, out);
+        } else if (format == UYVY) {
+            convertPackedLine(line, 1, 0, 2, width, out);
+        } else {
+            convertPackedLine(line, 0, 1, 3, width, out);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,79 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef YUVCONVERTER_H
+#define YUVCONVERTER_H
+
+#include <QImage>
+#include <QSize>
+#include <vector>
+
+/*!
+  \class YuvConverter
+  \brief The YuvConverter converts the YUV frames of capture devices to RGB
+  images for previews.
+
+  Packed 4:2:2 (UYVY and YUYV) and planar 4:2:0 frames are supported, with the
+  studio range Rec. 601 coefficients used by capture devices. Clamping is done
+  with min / max operations instead of branches, and the inner loops only use
+  integer arithmetic on arrays, so that compilers vectorize them.
+
+  The frame can be downscaled while it is converted: only the pixels of the
+  target image are read and converted (nearest neighbour), so that a half size
+  preview costs a quarter of a full size conversion.
+
+  The converter keeps the images it returns and reuses one as soon as no copy of
+  it is alive anymore, so that no image is allocated for each frame once the
+  previous ones have been displayed.
+*/
+
+class YuvConverter
+{
+public:
+    enum Format { UYVY, YUYV, YUV420P };
+
+    YuvConverter();
+
+    /*!
+      Converts a \a width x \a height frame to an RGB32 image.
+
+      If \a targetSize is valid and smaller than the frame, the image is
+      downscaled to fit in it, keeping the aspect ratio.
+    */
+    QImage convert(const uchar *data, Format format, int width, int height, const QSize &targetSize = QSize());
+
+private:
+    // Images that were returned, reused once the caller released them
+    std::vector<QImage> m_images;
+    // Offsets of the luma and chroma samples of each output column in a source line
+    std::vector<int> m_lumaOffsets;
+    std::vector<int> m_chromaOffsets;
+    Format m_format;
+    int m_width;
+    int m_outputWidth;
+    size_t m_nextImage;
+
+    // Pooled image to write the next frame to, only referenced by the pool
+    QImage &image(const QSize &size);
+    void prepareColumns(Format format, int width, int outputWidth);
+};
+
+#endif // YUVCONVERTER_H
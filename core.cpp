@@ -18,11 +18,13 @@ the Free Software Foundation, either version 3 of the License, or
 #include "kdenlivesettings.h"
 #include "library/librarywidget.h"
 #include "mainwindow.h"
+#include "mixer/audiomixer.h"
 #include "mltconnection.h"
 #include "mltcontroller/bincontroller.h"
 #include "monitor/monitormanager.h"
+#include "monitor/scopes/audioblock.h"
+#include "monitor/scopes/scopeframe.h"
 #include "profiles/profilemodel.hpp"
-#include "mixer/audiomixer.cpp"
 #include "profiles/profilerepository.hpp"
 #include "project/projectmanager.h"
 #include "timeline2/model/timelineitemmodel.hpp"
@@ -46,9 +48,9 @@ std::unique_ptr<Core> Core::m_self;
 Core::Core()
     : m_mainWindow(nullptr)
     , m_projectManager(nullptr)
+    , m_mixerWidget(nullptr)
     , m_monitorManager(nullptr)
     , m_binWidget(nullptr)
-    , m_mixerWidget(nullptr)
     , m_library(nullptr)
     , m_thumbProfile(nullptr)
 {
@@ -78,7 +80,8 @@ void Core::build(const QString &MltPath)
     m_self.reset(new Core());
     m_self->initLocale();
 
-    qRegisterMetaType<audioShortVector>("audioShortVector");
+    qRegisterMetaType<AudioBlock>("AudioBlock");
+    qRegisterMetaType<ScopeFrame>("ScopeFrame");
     qRegisterMetaType<QVector<double>>("QVector<double>");
     qRegisterMetaType<MessageType>("MessageType");
     qRegisterMetaType<stringMap>("stringMap");
@@ -217,7 +220,7 @@ ProjectManager *Core::projectManager()
 }
 AudioMixer *Core::audioMixer()
 {
-        return m_mixerWidget;
+    return m_mixerWidget;
 }
 
 MonitorManager *Core::monitorManager()
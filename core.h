@@ -104,10 +104,8 @@ public:
     std::shared_ptr<JobManager> jobManager();
     /** @brief Returns a pointer to the library. */
     LibraryWidget *library();
-     AudioMixer *audioMixer();
-
-
-
+    /** @brief Returns a pointer to the project audio mixer. */
+    AudioMixer *audioMixer();
 
     /** @brief Returns a pointer to MLT's repository */
     std::unique_ptr<Mlt::Repository> &getMltRepository();
@@ -50,7 +50,9 @@ public:
         THUMBJOB = 6,
         ANALYSECLIPJOB = 7,
         LOADJOB = 8,
-        AUDIOTHUMBJOB = 9
+        AUDIOTHUMBJOB = 9,
+        LOUDNESSJOB = 10,
+        LEGALITYJOB = 11
     };
     AbstractClipJob(JOBTYPE type, const QString &id, QObject *parent = nullptr);
     virtual ~AbstractClipJob();
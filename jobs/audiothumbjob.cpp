@@ -27,7 +27,9 @@
 #include "doc/kthumb.h"
 #include "kdenlivesettings.h"
 #include "klocalizedstring.h"
+#include "lib/audio/audioPeaks.h"
 #include "lib/audio/audioStreamInfo.h"
+#include "lib/audio/loudnessMeter.h"
 #include "macros.hpp"
 #include "utils/thumbnailcache.hpp"
 #include <QDir>
@@ -43,41 +45,101 @@ AudioThumbJob::AudioThumbJob(const QString &binId)
 {
 }
 
+AudioThumbJob::~AudioThumbJob() = default;
+
+namespace {
+// Lowest and highest value of count samples, read every stride samples
+void minMax(const qint16 *data, int count, int stride, qint16 &min, qint16 &max)
+{
+    qint16 low = 0;
+    qint16 high = 0;
+    for (int i = 0; i < count; ++i) {
+        qint16 value = data[i * stride];
+        low = qMin(low, value);
+        high = qMax(high, value);
+    }
+    min = low;
+    max = high;
+}
+} // namespace
+
 const QString AudioThumbJob::getDescription() const
 {
     return i18n("Extracting audio thumb from clip %1", m_clipId);
 }
 
-bool AudioThumbJob::computeWithMlt()
+Mlt::Producer *AudioThumbJob::createAudioProducer(const std::shared_ptr<Mlt::Producer> &prod)
 {
-    m_audioLevels.clear();
-    // MLT audio thumbs: slower but safer
-    QString service = m_prod->get("mlt_service");
+    QString service = prod->get("mlt_service");
     if (service == QLatin1String("avformat-novalidate")) {
         service = QStringLiteral("avformat");
     } else if (service.startsWith(QLatin1String("xml"))) {
         service = QStringLiteral("xml-nogl");
     }
-    QScopedPointer<Mlt::Producer> audioProducer(new Mlt::Producer(*m_prod->profile(), service.toUtf8().constData(), m_prod->get("resource")));
+    auto *audioProducer = new Mlt::Producer(*prod->profile(), service.toUtf8().constData(), prod->get("resource"));
     if (!audioProducer->is_valid()) {
-        return false;
+        delete audioProducer;
+        return nullptr;
     }
     audioProducer->set("video_index", "-1");
-    Mlt::Filter chans(*m_prod->profile(), "audiochannels");
-    Mlt::Filter converter(*m_prod->profile(), "audioconvert");
-    Mlt::Filter levels(*m_prod->profile(), "audiolevel");
+    Mlt::Filter chans(*prod->profile(), "audiochannels");
+    Mlt::Filter converter(*prod->profile(), "audioconvert");
     audioProducer->attach(chans);
     audioProducer->attach(converter);
-    audioProducer->attach(levels);
+    return audioProducer;
+}
 
-    int last_val = 0;
+std::shared_ptr<AudioPeaks> AudioThumbJob::computeDetail(const std::shared_ptr<Mlt::Producer> &prod, int channels, int frequency, int firstFrame, int frames,
+                                                         int levelsPerFrame)
+{
+    QScopedPointer<Mlt::Producer> audioProducer(createAudioProducer(prod));
+    if (!audioProducer || frames <= 0) {
+        return nullptr;
+    }
     double framesPerSecond = audioProducer->get_fps();
+    auto peaks = std::make_shared<AudioPeaks>(channels, frames, framesPerSecond, levelsPerFrame);
+    audioProducer->seek(firstFrame);
     mlt_audio_format audioFormat = mlt_audio_s16;
-    QStringList keys;
-    keys.reserve(m_channels);
-    for (int i = 0; i < m_channels; i++) {
-        keys << "meta.media.audio_level." + QString::number(i);
+    for (int z = 0; z < frames; ++z) {
+        QScopedPointer<Mlt::Frame> mltFrame(audioProducer->get_frame());
+        if ((mltFrame == nullptr) || !mltFrame->is_valid() || (mltFrame->get_int("test_audio") != 0)) {
+            continue;
+        }
+        int samples = mlt_sample_calculator(float(framesPerSecond), frequency, firstFrame + z);
+        int freq = frequency;
+        int chans = channels;
+        const auto *data = static_cast<const qint16 *>(mltFrame->get_audio(audioFormat, freq, chans, samples));
+        if (data == nullptr || chans != channels) {
+            continue;
+        }
+        // Split the samples of the frame in levelsPerFrame parts
+        for (int part = 0; part < levelsPerFrame; ++part) {
+            int start = part * samples / levelsPerFrame;
+            int end = (part + 1) * samples / levelsPerFrame;
+            for (int channel = 0; channel < channels; ++channel) {
+                qint16 min, max;
+                minMax(data + start * channels + channel, end - start, channels, min, max);
+                peaks->setPeak(channel, z * levelsPerFrame + part, min, max);
+            }
+        }
     }
+    return peaks;
+}
+
+bool AudioThumbJob::computeWithMlt()
+{
+    m_peaks.reset();
+    m_loudness->reset();
+    // MLT audio thumbs: slower but safer
+    QScopedPointer<Mlt::Producer> audioProducer(createAudioProducer(m_prod));
+    if (!audioProducer) {
+        return false;
+    }
+
+    int last_val = 0;
+    double framesPerSecond = audioProducer->get_fps();
+    mlt_audio_format audioFormat = mlt_audio_s16;
+    auto peaks = std::make_shared<AudioPeaks>(m_channels, m_lengthInFrames, framesPerSecond);
 
     for (int z = 0; z < m_lengthInFrames; ++z) {
         int val = (int)(100.0 * z / m_lengthInFrames);
@@ -88,24 +150,35 @@ bool AudioThumbJob::computeWithMlt()
         QScopedPointer<Mlt::Frame> mltFrame(audioProducer->get_frame());
         if ((mltFrame != nullptr) && mltFrame->is_valid() && (mltFrame->get_int("test_audio") == 0)) {
             int samples = mlt_sample_calculator(float(framesPerSecond), m_frequency, z);
-            mltFrame->get_audio(audioFormat, m_frequency, m_channels, samples);
-            for (int channel = 0; channel < m_channels; ++channel) {
-                double level = 256 * qMin(mltFrame->get_double(keys.at(channel).toUtf8().constData()) * 0.9, 1.0);
-                m_audioLevels << level;
+            int frequency = m_frequency;
+            int channels = m_channels;
+            const auto *data = static_cast<const qint16 *>(mltFrame->get_audio(audioFormat, frequency, channels, samples));
+            if (data != nullptr && channels == m_channels) {
+                m_loudness->addInterleaved(data, samples);
+                for (int channel = 0; channel < m_channels; ++channel) {
+                    qint16 min, max;
+                    minMax(data + channel, samples, m_channels, min, max);
+                    peaks->setPeak(channel, z, min, max);
+                }
+                continue;
             }
-        } else if (!m_audioLevels.isEmpty()) {
-            for (int channel = 0; channel < m_channels; channel++) {
-                m_audioLevels << m_audioLevels.last();
+        }
+        if (z > 0) {
+            // Repeat the previous frame
+            for (int channel = 0; channel < m_channels; ++channel) {
+                peaks->setPeak(channel, z, peaks->minimum(channel, z - 1), peaks->maximum(channel, z - 1));
             }
         }
     }
+    m_peaks = std::move(peaks);
     m_done = true;
     return true;
 }
 
 bool AudioThumbJob::computeWithFFMPEG()
 {
-    m_audioLevels.clear();
+    m_peaks.reset();
+    m_loudness->reset();
     QStringList args;
 
     std::vector<std::unique_ptr<QTemporaryFile>> channelFiles;
@@ -170,32 +243,22 @@ bool AudioThumbJob::computeWithFFMPEG()
             }
             rawChannels.emplace_back((const qint16 *)res.constData());
         }
-        int progress = 0;
-        std::vector<long> channelsData;
-        double offset = (double)dataSize / (2.0 * m_lengthInFrames);
-        int intraOffset = 1;
-        if (offset > 1000) {
-            intraOffset = offset / 60;
-        } else if (offset > 250) {
-            intraOffset = offset / 10;
+        if (isFFmpeg && (int)rawChannels.size() == m_channels) {
+            // FFmpeg keeps the original sample rate, so the decoded data can also be used for the loudness
+            m_loudness->addPlanar(rawChannels.data(), dataSize / 2);
         }
-        double factor = 800.0 / 32768;
+        int progress = 0;
+        int samplesPerChannel = dataSize / 2;
+        double offset = (double)samplesPerChannel / m_lengthInFrames;
+        auto peaks = std::make_shared<AudioPeaks>((int)rawChannels.size(), m_lengthInFrames, m_prod->get_fps());
         for (int i = 0; i < m_lengthInFrames; i++) {
-            channelsData.resize((size_t)rawChannels.size());
-            std::fill(channelsData.begin(), channelsData.end(), 0);
-            int pos = (int)(i * offset);
-            int steps = 0;
-            for (int j = 0; j < (int)offset && (pos + j < dataSize); j += intraOffset) {
-                steps++;
-                for (size_t k = 0; k < rawChannels.size(); k++) {
-                    channelsData[k] += abs(rawChannels[k][pos + j]);
-                }
-            }
-            for (size_t k = 0; k < channelsData.size(); k++) {
-                if (steps != 0) {
-                    channelsData[k] /= steps;
-                }
-                m_audioLevels << channelsData[k] * factor;
+            // Scan all the samples of the frame, so that no peak is lost
+            int pos = qMin((int)(i * offset), samplesPerChannel);
+            int end = qMin((int)((i + 1) * offset), samplesPerChannel);
+            for (size_t k = 0; k < rawChannels.size(); k++) {
+                qint16 min, max;
+                minMax(rawChannels[k] + pos, end - pos, 1, min, max);
+                peaks->setPeak((int)k, i, min, max);
             }
             int p = 80 + (i * 20 / m_lengthInFrames);
             if (p != progress) {
@@ -203,6 +266,7 @@ bool AudioThumbJob::computeWithFFMPEG()
                 progress = p;
             }
         }
+        m_peaks = std::move(peaks);
         m_done = true;
         return true;
     }
@@ -256,49 +320,25 @@ bool AudioThumbJob::startJob()
     }
     m_cachePath = m_binClip->getAudioThumbPath();
 
-    // checking for cached thumbs
-    QImage image(m_cachePath);
-    if (!image.isNull()) {
-        // convert cached image
-        int n = image.width() * image.height();
-        for (int i = 0; i < n; i++) {
-            QRgb p = image.pixel(i / m_channels, i % m_channels);
-            m_audioLevels << qRed(p);
-            m_audioLevels << qGreen(p);
-            m_audioLevels << qBlue(p);
-            m_audioLevels << qAlpha(p);
-        }
-    }
-    if (!m_audioLevels.isEmpty()) {
+    // checking for cached thumbs, the file is mapped so there is nothing to decode
+    m_peaks = AudioPeaks::load(m_cachePath);
+    if (m_peaks) {
+        m_peaks->buildPyramid();
         m_done = true;
         m_successful = true;
         return true;
     }
+    m_loudness.reset(new LoudnessMeter(m_channels, m_frequency));
     bool ok = computeWithFFMPEG();
     ok = ok || computeWithMlt();
     Q_ASSERT(ok == m_done);
+    if (ok && m_loudness->hasData()) {
+        m_loudness->result().save(m_binClip->getLoudnessPath());
+    }
 
-    if (ok && m_done && !m_audioLevels.isEmpty()) {
-        // Put into an image for caching.
-        int count = m_audioLevels.size();
-        image = QImage((int)lrint((count + 3) / 4.0 / m_channels), m_channels, QImage::Format_ARGB32);
-        int n = image.width() * image.height();
-        for (int i = 0; i < n; i++) {
-            QRgb p;
-            if ((4 * i + 3) < count) {
-                p = qRgba(m_audioLevels.at(4 * i).toInt(), m_audioLevels.at(4 * i + 1).toInt(), m_audioLevels.at(4 * i + 2).toInt(),
-                          m_audioLevels.at(4 * i + 3).toInt());
-            } else {
-                int last = m_audioLevels.last().toInt();
-                int r = (4 * i + 0) < count ? m_audioLevels.at(4 * i + 0).toInt() : last;
-                int g = (4 * i + 1) < count ? m_audioLevels.at(4 * i + 1).toInt() : last;
-                int b = (4 * i + 2) < count ? m_audioLevels.at(4 * i + 2).toInt() : last;
-                int a = last;
-                p = qRgba(r, g, b, a);
-            }
-            image.setPixel(i / m_channels, i % m_channels, p);
-        }
-        image.save(m_cachePath);
+    if (ok && m_done && m_peaks) {
+        m_peaks->save(m_cachePath);
+        m_peaks->buildPyramid();
         m_successful = true;
         return true;
     }
@@ -318,10 +358,14 @@ bool AudioThumbJob::commitResult(Fun &undo, Fun &redo)
     if (!m_successful) {
         return false;
     }
-    QVariantList old = m_binClip->audioFrameCache;
+    if (!m_peaks) {
+        // Nothing was computed
+        return true;
+    }
+    std::shared_ptr<const AudioPeaks> old = m_binClip->audioPeaks();
 
-    // note that the image is moved into lambda, it won't be available from this class anymore
-    auto operation = [ clip = m_binClip, audio = std::move(m_audioLevels) ]()
+    // note that the peaks are moved into lambda, they won't be available from this class anymore
+    auto operation = [ clip = m_binClip, audio = std::shared_ptr<const AudioPeaks>(std::move(m_peaks)) ]()
     {
         clip->updateAudioThumbnail(audio);
         return true;
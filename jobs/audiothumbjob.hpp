@@ -28,6 +28,8 @@
 /* @brief This class represents the job that corresponds to computing the audio thumb of a clip (waveform)
  */
 
+class AudioPeaks;
+class LoudnessMeter;
 class ProjectClip;
 namespace Mlt {
 class Producer;
@@ -43,6 +45,7 @@ public:
        @param persistent: if true, we will use the persistent cache (for query and saving)
     */
     AudioThumbJob(const QString &binId);
+    ~AudioThumbJob();
 
     const QString getDescription() const override;
 
@@ -52,7 +55,15 @@ public:
         By design, the job should store the result of the computation but not share it with the rest of the code. This happens when we call commitResult */
     bool commitResult(Fun &undo, Fun &redo) override;
 
+    /** @brief Decode a range of frames with MLT and return its peaks, with levelsPerFrame min / max pairs per frame.
+        This is used to compute detailed waveforms on demand, only for the visible part of a zoomed in timeline */
+    static std::shared_ptr<AudioPeaks> computeDetail(const std::shared_ptr<Mlt::Producer> &prod, int channels, int frequency, int firstFrame, int frames,
+                                                     int levelsPerFrame);
+
 protected:
+    // Create a producer that only decodes the audio of prod
+    static Mlt::Producer *createAudioProducer(const std::shared_ptr<Mlt::Producer> &prod);
+
     bool computeWithFFMPEG();
     // MLT audio thumbs: slower but safer
     bool computeWithMlt();
@@ -68,6 +79,8 @@ private:
 
     bool m_done{false}, m_successful{false};
     int m_channels, m_frequency, m_lengthInFrames, m_audioStream;
-    QVariantList m_audioLevels;
+    std::shared_ptr<AudioPeaks> m_peaks;
     QProcess *m_ffmpegProcess;
+    // The loudness is measured in the same decoding pass as the levels, the result is cached for the LoudnessJob
+    std::unique_ptr<LoudnessMeter> m_loudness;
 };
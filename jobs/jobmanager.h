@@ -61,7 +61,9 @@ struct Job_t
 };
 
 class AudioThumbJob;
+class LegalityJob;
 class LoadJob;
+class LoudnessJob;
 class SceneSplitJob;
 class StabilizeJob;
 class ThumbJob;
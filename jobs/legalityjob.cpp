@@ -0,0 +1,251 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "legalityjob.hpp"
+#include "bin/model/markerlistmodel.hpp"
+#include "bin/projectclip.h"
+#include "bin/projectitemmodel.h"
+#include "core.h"
+#include "klocalizedstring.h"
+#include "lib/audio/audioStreamInfo.h"
+#include "lib/audio/loudnessMeter.h"
+#include "macros.hpp"
+#include "monitor/scopes/scopeframe.h"
+#include "monitor/scopes/sharedframe.h"
+#include "scopes/colorscopes/scopeanalyzer.h"
+#include "scopes/legalityreport.h"
+
+#include <QImage>
+#include <QScopedPointer>
+#include <QStringList>
+#include <cmath>
+#include <mlt++/MltProducer.h>
+
+namespace {
+void addVideoStats(const ScopeAnalyzer::Analysis &analysis, LegalityReport::FrameStats &stats)
+{
+    for (int i = 0; i < (int)analysis.levels.size(); ++i) {
+        if (analysis.levels[i] > 0) {
+            stats.lumaMin = (quint8)qMin((int)stats.lumaMin, i);
+            stats.lumaMax = (quint8)i;
+            stats.pixels += analysis.levels[i];
+        }
+    }
+    // Chroma samples are counted at index U * 256 + V
+    for (int u = 0; u < 256; ++u) {
+        const uint *row = analysis.chroma.data() + u * 256;
+        for (int v = 0; v < 256; ++v) {
+            if (row[v] > 0) {
+                stats.uMin = (quint8)qMin((int)stats.uMin, u);
+                stats.uMax = (quint8)u;
+                stats.vMin = (quint8)qMin((int)stats.vMin, v);
+                stats.vMax = (quint8)qMax((int)stats.vMax, v);
+            }
+        }
+    }
+    stats.illegalLuma = analysis.illegalLuma;
+    stats.illegalGamut = analysis.illegalGamut;
+}
+
+void addAudioStats(const qint16 *samples, int count, LegalityReport::FrameStats &stats)
+{
+    int peak = 0;
+    double sum = 0;
+    for (int i = 0; i < count; ++i) {
+        const int value = samples[i];
+        peak = qMax(peak, qAbs(value));
+        sum += (double)value * value;
+    }
+    stats.audioPeak = (quint16)qMin(peak, 32767);
+    stats.audioRms = count > 0 ? (quint16)qMin(32767L, std::lround(std::sqrt(sum / count))) : 0;
+}
+
+QString violationText(int violations)
+{
+    QStringList rules;
+    if ((violations & LegalityReport::LumaViolation) != 0) {
+        rules << i18n("luma out of range");
+    }
+    if ((violations & LegalityReport::GamutViolation) != 0) {
+        rules << i18n("out of gamut");
+    }
+    if ((violations & LegalityReport::AudioPeakViolation) != 0) {
+        rules << i18n("audio peak above -1 dBFS");
+    }
+    return rules.join(QStringLiteral(", "));
+}
+} // namespace
+
+LegalityJob::LegalityJob(const QString &binId, bool zoneOnly)
+    : AbstractClipJob(LEGALITYJOB, binId)
+    , m_zoneOnly(zoneOnly)
+{
+}
+
+const QString LegalityJob::getDescription() const
+{
+    return i18n("Checking broadcast legality of clip %1", m_clipId);
+}
+
+bool LegalityJob::startJob()
+{
+    if (m_done) {
+        return true;
+    }
+    m_done = true;
+    m_binClip = pCore->projectItemModel()->getClipByBinID(m_clipId);
+    std::shared_ptr<Mlt::Producer> prod = m_binClip->originalProducer();
+    if ((prod == nullptr) || !prod->is_valid()) {
+        m_errorMessage.append(i18n("Invalid clip"));
+        return false;
+    }
+    // A clone of the bin producer, so that the monitors are not disturbed. Unlike a producer reopened from the resource,
+    // it keeps the service and properties of generated clips (color, title, playlist...)
+    std::shared_ptr<Mlt::Producer> producer = m_binClip->cloneProducer();
+    if (!producer || !producer->is_valid()) {
+        m_errorMessage.append(i18n("Cannot decode clip %1\n", m_clipId));
+        return false;
+    }
+    int in = 0;
+    int out = m_binClip->frameDuration() - 1;
+    if (m_zoneOnly) {
+        QPoint zone = m_binClip->zone();
+        in = qMax(0, zone.x());
+        out = qMin(out, zone.y());
+    }
+    if (out < in) {
+        m_errorMessage.append(i18n("Nothing to analyse in clip %1\n", m_clipId));
+        return false;
+    }
+    const bool hasVideo = m_binClip->clipType() != ClipType::Audio;
+    const int channels = qMax(0, m_binClip->audioChannels());
+    int frequency = channels > 0 ? m_binClip->audioInfo()->samplingRate() : 0;
+    frequency = frequency <= 0 ? 48000 : frequency;
+    const double fps = prod->get_fps();
+    const int width = prod->profile()->width();
+    const int height = prod->profile()->height();
+
+    auto report = std::make_shared<LegalityReport>(out - in + 1, fps, in);
+    LoudnessMeter meter(qMax(1, channels), frequency);
+    // Full precision analysis of the luma levels, chroma and pixels out of range, as done for the color scopes
+    ScopeAnalyzer analyzer;
+    ScopeAnalyzer::Request request;
+    request.chroma = true;
+    request.legality = true;
+
+    int lastProgress = 0;
+    for (int position = in; position <= out; ++position) {
+        int progress = (int)(100.0 * (position - in) / (out - in + 1));
+        if (progress != lastProgress) {
+            emit jobProgress(progress);
+            lastProgress = progress;
+        }
+        producer->seek(position);
+        QScopedPointer<Mlt::Frame> mltFrame(producer->get_frame());
+        if ((mltFrame == nullptr) || !mltFrame->is_valid()) {
+            continue;
+        }
+        LegalityReport::FrameStats stats;
+        if (hasVideo) {
+            mlt_image_format format = mlt_image_yuv420p;
+            int w = width;
+            int h = height;
+            mltFrame->get_image(format, w, h);
+            ScopeFrame frame{SharedFrame(*mltFrame)};
+            if (!frame.isValid()) {
+                // Sources that cannot provide planar YUV are converted once, as the scopes do
+                format = mlt_image_rgb24a;
+                const uchar *image = mltFrame->get_image(format, w, h);
+                if (image != nullptr) {
+                    frame = ScopeFrame(QImage(image, w, h, QImage::Format_RGBA8888));
+                }
+            }
+            std::shared_ptr<const ScopeAnalyzer::Analysis> analysis = analyzer.analyse(this, request, frame);
+            if (analysis) {
+                addVideoStats(*analysis, stats);
+            }
+        }
+        if (channels > 0) {
+            mlt_audio_format audioFormat = mlt_audio_s16;
+            int audioChannels = channels;
+            int samples = mlt_sample_calculator(float(fps), frequency, position);
+            const auto *data = static_cast<const qint16 *>(mltFrame->get_audio(audioFormat, frequency, audioChannels, samples));
+            if (data != nullptr && audioChannels == channels) {
+                meter.addInterleaved(data, samples);
+                addAudioStats(data, samples * channels, stats);
+            }
+        }
+        report->setFrame(position - in, stats);
+    }
+    if (meter.hasData()) {
+        report->setLoudness(meter.result());
+    }
+    if (!report->save(m_binClip->getLegalityReportPath())) {
+        qDebug() << "Cannot write legality report of clip" << m_clipId;
+    }
+    m_report = report;
+    m_successful = true;
+    return true;
+}
+
+bool LegalityJob::commitResult(Fun &undo, Fun &redo)
+{
+    Q_ASSERT(!m_resultConsumed);
+    if (!m_done) {
+        qDebug() << "ERROR: Trying to consume invalid results";
+        return false;
+    }
+    m_resultConsumed = true;
+    if (!m_successful) {
+        return false;
+    }
+    // One marker at the start of each run of frames breaking the same rules
+    std::shared_ptr<MarkerListModel> markerModel = m_binClip->getMarkerModel();
+    const double fps = m_report->fps();
+    int runStart = 0;
+    int runViolations = LegalityReport::NoViolation;
+    int markers = 0;
+    for (int i = 0; i <= m_report->frames(); ++i) {
+        int violations = i < m_report->frames() ? m_report->violations(i) : LegalityReport::NoViolation;
+        if (violations == runViolations) {
+            continue;
+        }
+        if (runViolations != LegalityReport::NoViolation) {
+            QString comment = i18np("Legality: %2 (1 frame)", "Legality: %2 (%1 frames)", i - runStart, violationText(runViolations));
+            if (!markerModel->addMarker(GenTime(m_report->in() + runStart, fps), comment, -1, undo, redo)) {
+                return false;
+            }
+            markers++;
+        }
+        runStart = i;
+        runViolations = violations;
+    }
+
+    QString message = i18n("Legality of clip %1: %2 frames with illegal luma, %3 out of gamut, %4 with audio peaks", m_binClip->clipName(),
+                           m_report->violationCount(LegalityReport::LumaViolation), m_report->violationCount(LegalityReport::GamutViolation),
+                           m_report->violationCount(LegalityReport::AudioPeakViolation));
+    LoudnessInfo loudness = m_report->loudness();
+    if (loudness.valid) {
+        message.append(i18n(", loudness %1 LUFS", QString::number(loudness.integrated, 'f', 1)));
+    }
+    pCore->displayMessage(message, markers > 0 ? ErrorMessage : OperationCompletedMessage);
+    return true;
+}
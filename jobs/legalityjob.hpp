@@ -0,0 +1,60 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#pragma once
+
+#include "abstractclipjob.h"
+
+#include <memory>
+
+/* @brief This class represents the job that checks the broadcast legality of a clip, without playing it.
+   Every frame of the clip (or of its zone) is decoded once. The image goes through the same analysis as the color scopes to find the luma and chroma
+   ranges and the pixels out of the EBU R 103 ranges, the audio through the loudness meter and a peak meter. The per frame results are written to a binary
+   report, and a marker is added on the clip at the start of each run of frames violating a rule.
+ */
+
+class LegalityReport;
+class ProjectClip;
+
+class LegalityJob : public AbstractClipJob
+{
+    Q_OBJECT
+
+public:
+    /* @brief Creates the job
+       @param zoneOnly if true, only the zone of the clip is analysed
+     */
+    LegalityJob(const QString &binId, bool zoneOnly = false);
+
+    const QString getDescription() const override;
+
+    bool startJob() override;
+
+    /** @brief This is to be called after the job finished.
+        By design, the job should store the result of the computation but not share it with the rest of the code. This happens when we call commitResult */
+    bool commitResult(Fun &undo, Fun &redo) override;
+
+private:
+    std::shared_ptr<ProjectClip> m_binClip;
+    std::shared_ptr<LegalityReport> m_report;
+    bool m_zoneOnly;
+    bool m_done{false}, m_successful{false};
+};
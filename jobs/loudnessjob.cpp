@@ -0,0 +1,154 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "loudnessjob.hpp"
+#include "bin/projectclip.h"
+#include "bin/projectitemmodel.h"
+#include "core.h"
+#include "klocalizedstring.h"
+#include "lib/audio/audioStreamInfo.h"
+#include "macros.hpp"
+#include <QScopedPointer>
+#include <mlt++/MltProducer.h>
+
+LoudnessJob::LoudnessJob(const QString &binId)
+    : AbstractClipJob(LOUDNESSJOB, binId)
+    , m_channels(2)
+    , m_frequency(48000)
+{
+}
+
+const QString LoudnessJob::getDescription() const
+{
+    return i18n("Analysing loudness of clip %1", m_clipId);
+}
+
+bool LoudnessJob::computeWithMlt(LoudnessMeter &meter)
+{
+    std::shared_ptr<Mlt::Producer> prod = m_binClip->originalProducer();
+    if ((prod == nullptr) || !prod->is_valid()) {
+        return false;
+    }
+    QString service = prod->get("mlt_service");
+    if (service == QLatin1String("avformat-novalidate")) {
+        service = QStringLiteral("avformat");
+    } else if (service.startsWith(QLatin1String("xml"))) {
+        service = QStringLiteral("xml-nogl");
+    }
+    QScopedPointer<Mlt::Producer> audioProducer(new Mlt::Producer(*prod->profile(), service.toUtf8().constData(), prod->get("resource")));
+    if (!audioProducer->is_valid()) {
+        return false;
+    }
+    audioProducer->set("video_index", "-1");
+    Mlt::Filter chans(*prod->profile(), "audiochannels");
+    Mlt::Filter converter(*prod->profile(), "audioconvert");
+    audioProducer->attach(chans);
+    audioProducer->attach(converter);
+
+    int lengthInFrames = prod->get_length();
+    double framesPerSecond = audioProducer->get_fps();
+    mlt_audio_format audioFormat = mlt_audio_s16;
+    int last_val = 0;
+    for (int z = 0; z < lengthInFrames; ++z) {
+        int val = (int)(100.0 * z / lengthInFrames);
+        if (last_val != val) {
+            emit jobProgress(val);
+            last_val = val;
+        }
+        QScopedPointer<Mlt::Frame> mltFrame(audioProducer->get_frame());
+        if ((mltFrame != nullptr) && mltFrame->is_valid() && (mltFrame->get_int("test_audio") == 0)) {
+            int samples = mlt_sample_calculator(float(framesPerSecond), m_frequency, z);
+            const auto *data = static_cast<const qint16 *>(mltFrame->get_audio(audioFormat, m_frequency, m_channels, samples));
+            if (data != nullptr) {
+                meter.addInterleaved(data, samples);
+            }
+        }
+    }
+    return meter.hasData();
+}
+
+bool LoudnessJob::startJob()
+{
+    if (m_done) {
+        return true;
+    }
+    m_binClip = pCore->projectItemModel()->getClipByBinID(m_clipId);
+    if (m_binClip->audioChannels() == 0 || m_binClip->loudness().valid) {
+        // nothing to do
+        m_done = true;
+        m_successful = true;
+        return true;
+    }
+    m_frequency = m_binClip->audioInfo()->samplingRate();
+    m_frequency = m_frequency <= 0 ? 48000 : m_frequency;
+    m_channels = m_binClip->audioInfo()->channels();
+    m_channels = m_channels <= 0 ? 2 : m_channels;
+
+    // checking for cached analysis, usually written by the audio thumbnail job
+    const QString cachePath = m_binClip->getLoudnessPath();
+    m_result = LoudnessInfo::load(cachePath);
+    if (!m_result.valid) {
+        LoudnessMeter meter(m_channels, m_frequency);
+        if (!computeWithMlt(meter)) {
+            m_errorMessage.append(i18n("Cannot decode the audio of clip %1\n", m_clipId));
+            m_done = true;
+            m_successful = false;
+            return false;
+        }
+        m_result = meter.result();
+        // Silent or very short clips have no measurable loudness, save() skips them
+        m_result.save(cachePath);
+    }
+    m_done = true;
+    m_successful = true;
+    return true;
+}
+
+bool LoudnessJob::commitResult(Fun &undo, Fun &redo)
+{
+    Q_ASSERT(!m_resultConsumed);
+    if (!m_done) {
+        qDebug() << "ERROR: Trying to consume invalid results";
+        return false;
+    }
+    m_resultConsumed = true;
+    if (!m_successful) {
+        return false;
+    }
+    if (!m_result.valid) {
+        // Nothing was measured
+        return true;
+    }
+    LoudnessInfo old = m_binClip->loudness();
+    auto operation = [clip = m_binClip, info = m_result]() {
+        clip->updateLoudness(info);
+        return true;
+    };
+    auto reverse = [clip = m_binClip, info = old]() {
+        clip->updateLoudness(info);
+        return true;
+    };
+    bool ok = operation();
+    if (ok) {
+        UPDATE_UNDO_REDO_NOLOCK(operation, reverse, undo, redo);
+    }
+    return ok;
+}
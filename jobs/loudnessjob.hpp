@@ -0,0 +1,61 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#pragma once
+
+#include "abstractclipjob.h"
+#include "lib/audio/loudnessMeter.h"
+
+#include <memory>
+
+/* @brief This class represents the job that measures the loudness of a clip (EBU R128 integrated, short-term and momentary loudness, loudness range and
+   true peak).
+   The audio thumbnail job runs the loudness meter in its own decoding pass and caches the result, so this job usually only has to read the cache. The clip
+   is decoded again only if the audio thumbnail was already cached when the loudness analysis was introduced.
+ */
+
+class ProjectClip;
+
+class LoudnessJob : public AbstractClipJob
+{
+    Q_OBJECT
+
+public:
+    LoudnessJob(const QString &binId);
+
+    const QString getDescription() const override;
+
+    bool startJob() override;
+
+    /** @brief This is to be called after the job finished.
+        By design, the job should store the result of the computation but not share it with the rest of the code. This happens when we call commitResult */
+    bool commitResult(Fun &undo, Fun &redo) override;
+
+protected:
+    // Decode the audio of the clip with MLT and feed it to the meter
+    bool computeWithMlt(LoudnessMeter &meter);
+
+private:
+    std::shared_ptr<ProjectClip> m_binClip;
+    LoudnessInfo m_result;
+    bool m_done{false}, m_successful{false};
+    int m_channels, m_frequency;
+};
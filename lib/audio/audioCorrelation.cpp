@@ -13,9 +13,19 @@ the Free Software Foundation, either version 3 of the License, or
 
 #include "kdenlive_debug.h"
 #include "klocalizedstring.h"
+#include <QThreadPool>
 #include <QTime>
+#include <QtConcurrent>
+#include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <limits>
+#include <vector>
+
+namespace {
+// Longest envelope correlated at full resolution, longer ones are decimated for the coarse search
+const int maxCoarseSize = 16384;
+} // namespace
 
 AudioCorrelation::AudioCorrelation(AudioEnvelope *mainTrackEnvelope)
     : m_mainTrackEnvelope(mainTrackEnvelope)
@@ -61,7 +71,11 @@ void AudioCorrelation::slotProcessChild(AudioEnvelope *envelope)
     qint64 max = 0;
 
     if (sizeSub > 200) {
-        FFTCorrelation::correlate(envMain, sizeMain, envSub, sizeSub, correlation);
+        if (!m_fft) {
+            m_fft.reset(new FFTCorrelation());
+            m_fft->setReference(envMain, sizeMain, sizeSub);
+        }
+        m_fft->correlateWithReference(envSub, sizeSub, correlation);
     } else {
         correlate(envMain, sizeMain, envSub, sizeSub, correlation, &max);
         info->setMax(max);
@@ -87,6 +101,126 @@ int AudioCorrelation::getShift(int childIndex) const
     return indexOffset;
 }
 
+QVector<AudioCorrelation::Alignment> AudioCorrelation::alignBatch(AudioEnvelope *mainTrackEnvelope, const QList<AudioEnvelope *> &children)
+{
+    QTime t;
+    t.start();
+    QVector<Alignment> results(children.size());
+    QList<AudioEnvelope *> envelopes = children;
+    envelopes.prepend(mainTrackEnvelope);
+
+    // Envelopes are loaded concurrently, sharing the cores between them
+    const int cores = qMax(1, QThread::idealThreadCount());
+    const int concurrent = qMin(cores, envelopes.size());
+    QThreadPool pool;
+    pool.setMaxThreadCount(concurrent);
+    for (AudioEnvelope *envelope : envelopes) {
+        envelope->setThreadCount(qMax(1, cores / concurrent));
+        QtConcurrent::run(&pool, [envelope]() { envelope->centerEnvelope(); });
+    }
+    pool.waitForDone();
+
+    const int sizeMain = mainTrackEnvelope->envelopeSize();
+    const qint64 *envMain = mainTrackEnvelope->envelope();
+    int maxChildSize = 0;
+    for (AudioEnvelope *envelope : children) {
+        maxChildSize = qMax(maxChildSize, envelope->envelopeSize());
+    }
+    // Coarse search on decimated envelopes
+    const int factor = decimationFactor(qMax(sizeMain, maxChildSize));
+    const std::vector<qint64> coarseMain = decimate(envMain, sizeMain, factor);
+    const int coarseMainSize = (int)coarseMain.size();
+    const int coarseMaxChildSize = (maxChildSize + factor - 1) / factor;
+    // The spectrum of the main track is computed once, at the size needed by the longest child
+    FFTCorrelation mainFFT;
+    if (coarseMaxChildSize > 200) {
+        mainFFT.setReference(coarseMain.data(), coarseMainSize, coarseMaxChildSize);
+    }
+
+    Alignment *out = results.data();
+    pool.setMaxThreadCount(cores);
+    for (int i = 0; i < children.size(); ++i) {
+        QtConcurrent::run(&pool, [&, i]() {
+            AudioEnvelope *envelope = children.at(i);
+            const int sizeSub = envelope->envelopeSize();
+            const std::vector<qint64> coarseSub = decimate(envelope->envelope(), sizeSub, factor);
+            const int coarseSubSize = (int)coarseSub.size();
+            AudioCorrelationInfo info(coarseMainSize, coarseSubSize);
+            if (coarseSubSize > 200) {
+                FFTCorrelation engine;
+                engine.setReference(mainFFT);
+                engine.correlateWithReference(coarseSub.data(), coarseSubSize, info.correlationVector());
+            } else {
+                qint64 max = 0;
+                correlate(coarseMain.data(), coarseMainSize, coarseSub.data(), coarseSubSize, info.correlationVector(), &max);
+                info.setMax(max);
+            }
+            out[i].confidence = info.confidence(qMax(2, 12 / factor));
+            // The true shift is less than one decimated entry away from the coarse one
+            int coarseShift = (info.maxIndex() - coarseSubSize) * factor;
+            refine(envMain, sizeMain, envelope->envelope(), sizeSub, coarseShift, 2 * factor, out[i]);
+        });
+    }
+    pool.waitForDone();
+    qCDebug(KDENLIVE_LOG) << "Aligned" << children.size() << "clips in" << t.elapsed() << "ms.";
+    return results;
+}
+
+int AudioCorrelation::decimationFactor(int size)
+{
+    int factor = 1;
+    while (size / factor > maxCoarseSize) {
+        factor *= 2;
+    }
+    return factor;
+}
+
+std::vector<qint64> AudioCorrelation::decimate(const qint64 *envelope, int size, int factor)
+{
+    std::vector<qint64> result((size_t)((size + factor - 1) / factor), 0);
+    for (int i = 0; i < size; ++i) {
+        result[(size_t)(i / factor)] += envelope[i];
+    }
+    return result;
+}
+
+void AudioCorrelation::refine(const qint64 *envMain, int sizeMain, const qint64 *envSub, int sizeSub, int shift, int window, Alignment &result)
+{
+    // Same shift convention as correlate(): envSub[i] is compared with envMain[i + shift].
+    // Sums are computed in floating point, products of long envelopes overflow 64 bit integers.
+    const int from = qMax(-sizeSub + 1, shift - window);
+    const int to = qMin(sizeMain - 1, shift + window);
+    std::vector<double> values;
+    for (int s = from; s <= to; ++s) {
+        int start = qMax(0, -s);
+        int end = qMin(sizeSub, sizeMain - s);
+        double sum = 0;
+        for (int i = start; i < end; ++i) {
+            sum += double(envSub[i]) * double(envMain[i + s]);
+        }
+        values.push_back(sum);
+    }
+    if (values.empty()) {
+        result.shift = shift;
+        result.preciseShift = shift;
+        return;
+    }
+    int best = int(std::max_element(values.begin(), values.end()) - values.begin());
+    result.shift = from + best;
+    // Fit a parabola through the peak and its neighbours
+    double delta = 0;
+    if (best > 0 && best + 1 < (int)values.size()) {
+        double left = values[(size_t)best - 1];
+        double center = values[(size_t)best];
+        double right = values[(size_t)best + 1];
+        double curvature = left - 2 * center + right;
+        if (curvature < 0) {
+            delta = qBound(-0.5, 0.5 * (left - right) / curvature, 0.5);
+        }
+    }
+    result.preciseShift = result.shift + delta;
+}
+
 AudioCorrelationInfo const *AudioCorrelation::info(int childIndex) const
 {
     Q_ASSERT(childIndex >= 0);
@@ -102,8 +236,10 @@ void AudioCorrelation::correlate(const qint64 *envMain, int sizeMain, const qint
     qint64 const *left;
     qint64 const *right;
     int size;
-    qint64 sum;
-    qint64 max = 0;
+    // Sums are computed in floating point, products of long or decimated envelopes overflow 64 bit integers
+    std::vector<double> sums((size_t)(sizeSub + sizeMain + 1));
+    double max = 0;
+    double peak = 0;
 
     /*
       Correlation:
@@ -134,21 +270,28 @@ void AudioCorrelation::correlate(const qint64 *envMain, int sizeMain, const qint
             size = std::min(sizeSub, sizeMain - shift);
         }
 
-        sum = 0;
+        double sum = 0;
         for (int i = 0; i < size; ++i) {
-            sum += (*left) * (*right);
+            sum += double(*left) * double(*right);
             left++;
             right++;
         }
-        correlation[sizeSub + shift] = qAbs(sum);
+        sums[(size_t)(sizeSub + shift)] = sum;
 
         if (sum > max) {
             max = sum;
         }
+        peak = qMax(peak, std::fabs(sum));
+    }
+    // Scale the results down if they do not fit in the correlation vector
+    const double limit = double(std::numeric_limits<qint64>::max() / 2);
+    const double scale = peak > limit ? limit / peak : 1.;
+    for (size_t i = 0; i < sums.size(); ++i) {
+        correlation[i] = qint64(std::fabs(sums[i]) * scale);
     }
     qCDebug(KDENLIVE_LOG) << "Correlation calculated. Time taken: " << t.elapsed() << " ms.";
 
     if (out_max != nullptr) {
-        *out_max = max;
+        *out_max = qint64(max * scale);
     }
 }
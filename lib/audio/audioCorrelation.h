@@ -14,7 +14,11 @@
 #include "audioCorrelationInfo.h"
 #include "audioEnvelope.h"
 #include "definitions.h"
+#include "fftCorrelation.h"
 #include <QList>
+#include <QVector>
+#include <memory>
+#include <vector>
 
 /**
   This class does the correlation between two tracks
@@ -22,6 +26,13 @@
 
   It uses one main track (used in the initializer); further tracks will be
   aligned relative to this main track.
+
+  alignBatch() aligns many children at once, without the signal chain:
+  all envelopes are computed in parallel, then every child is correlated
+  with the main track concurrently, reusing the spectrum of the main track.
+  Long envelopes are searched coarse to fine: the correlation runs on
+  decimated envelopes, then the best candidate is refined at frame
+  resolution in a small window, and interpolated to a sub-frame offset.
   */
 class AudioCorrelation : public QObject
 {
@@ -45,11 +56,41 @@ public:
       */
     static void correlate(const qint64 *envMain, int sizeMain, const qint64 *envSub, int sizeSub, qint64 *correlation, qint64 *out_max = nullptr);
 
+    /// Result of the alignment of a child in a batch.
+    struct Alignment
+    {
+        /// Position of the child relative to the main track, in frames
+        int shift = 0;
+        /// Interpolated position of the child relative to the main track, with sub-frame precision
+        double preciseShift = 0;
+        /// See AudioCorrelationInfo::confidence()
+        double confidence = 0;
+    };
+
+    /**
+      Aligns all \c children with \c mainTrackEnvelope and returns one result per child, in the same order.
+      This blocks until everything is computed, so it should run in a worker thread.
+      The envelopes stay owned by the caller.
+      */
+    static QVector<Alignment> alignBatch(AudioEnvelope *mainTrackEnvelope, const QList<AudioEnvelope *> &children);
+
+    /// Factor by which envelopes of this size are decimated for the coarse search, 1 for short envelopes.
+    static int decimationFactor(int size);
+    /// Sums every \c factor consecutive entries of the envelope.
+    static std::vector<qint64> decimate(const qint64 *envelope, int size, int factor);
+    /**
+      Searches the best shift between \c shift - \c window and \c shift + \c window at frame resolution,
+      and interpolates the correlation peak to find the sub-frame shift.
+      */
+    static void refine(const qint64 *envMain, int sizeMain, const qint64 *envSub, int sizeSub, int shift, int window, Alignment &result);
+
 private:
     AudioEnvelope *m_mainTrackEnvelope;
 
     QList<AudioEnvelope *> m_children;
     QList<AudioCorrelationInfo *> m_correlations;
+    /// Keeps the spectrum of the main track envelope between children
+    std::unique_ptr<FFTCorrelation> m_fft;
 
 private slots:
     void slotProcessChild(AudioEnvelope *envelope);
@@ -65,6 +65,23 @@ int AudioCorrelationInfo::maxIndex() const
     return index;
 }
 
+double AudioCorrelationInfo::confidence(int minDistance) const
+{
+    int index = maxIndex();
+    qint64 max = m_correlationVector[index];
+    if (max <= 0) {
+        return 0;
+    }
+    qint64 second = 0;
+    int width = size();
+    for (int i = 0; i < width; ++i) {
+        if (qAbs(i - index) >= minDistance && m_correlationVector[i] > second) {
+            second = m_correlationVector[i];
+        }
+    }
+    return 1. - double(second) / max;
+}
+
 qint64 *AudioCorrelationInfo::correlationVector()
 {
     return m_correlationVector;
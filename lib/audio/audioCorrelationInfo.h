@@ -42,6 +42,13 @@ public:
       */
     int maxIndex() const;
 
+    /**
+      Returns how distinct the best match is, from 0 (another shift matches as well)
+      to 1: one minus the ratio between the highest value found at least
+      \c minDistance entries away from the maximum, and the maximum.
+      */
+    double confidence(int minDistance = 12) const;
+
     QImage toImage(int height = 400) const;
 
 private:
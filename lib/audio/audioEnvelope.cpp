@@ -12,13 +12,64 @@
 
 #include "audioStreamInfo.h"
 #include "kdenlive_debug.h"
+#include <QDataStream>
+#include <QFile>
+#include <QHash>
 #include <QImage>
+#include <QMutex>
+#include <QSaveFile>
+#include <QThreadPool>
 #include <QTime>
 #include <QtConcurrent>
 #include <cmath>
+#include <memory>
+
+namespace {
+// Number of frames decoded by one task, small enough to balance the work between threads
+const int rangeSize = 1500;
+const quint32 envelopeMagic = 0x4b444556;
+// Bump when the content of the cache file changes
+const quint32 envelopeVersion = 1;
+
+struct CacheLocks
+{
+    QMutex mutex;
+    QHash<QString, std::shared_ptr<QMutex>> locks;
+};
+
+CacheLocks &cacheLocks()
+{
+    static CacheLocks registry;
+    return registry;
+}
+
+// Returns the lock of a cache file, several envelopes of the same bin clip may be loaded at the same time
+std::shared_ptr<QMutex> cacheLock(const QString &path)
+{
+    CacheLocks &registry = cacheLocks();
+    QMutexLocker locker(&registry.mutex);
+    std::shared_ptr<QMutex> &lock = registry.locks[path];
+    if (!lock) {
+        lock = std::make_shared<QMutex>();
+    }
+    return lock;
+}
+
+// Drops a lock returned by cacheLock(), and forgets it if no other envelope uses it
+void releaseCacheLock(const QString &path, std::shared_ptr<QMutex> &lock)
+{
+    CacheLocks &registry = cacheLocks();
+    QMutexLocker locker(&registry.mutex);
+    lock.reset();
+    auto it = registry.locks.find(path);
+    if (it != registry.locks.end() && it.value().use_count() == 1) {
+        registry.locks.erase(it);
+    }
+}
+} // namespace
 
 AudioEnvelope::AudioEnvelope(const QString &url, Mlt::Producer *producer, int offset, int length, int track, int startPos)
-    : m_envelope(nullptr)
+    : m_threadCount(QThread::idealThreadCount())
     , m_offset(offset)
     , m_length(length)
     , m_track(track)
@@ -35,6 +86,7 @@ AudioEnvelope::AudioEnvelope(const QString &url, Mlt::Producer *producer, int of
     if (path == QLatin1String("<playlist>") || path == QLatin1String("<tractor>") || path == QLatin1String("<producer>")) {
         path = url;
     }
+    m_path = path;
     m_producer = new Mlt::Producer(*(producer->profile()), path.toUtf8().constData());
     connect(&m_watcher, &QFutureWatcherBase::finished, this, &AudioEnvelope::slotProcessEnveloppe);
     if ((m_producer == nullptr) || !m_producer->is_valid()) {
@@ -51,73 +103,173 @@ AudioEnvelope::AudioEnvelope(const QString &url, Mlt::Producer *producer, int of
 
 AudioEnvelope::~AudioEnvelope()
 {
-    if (m_envelope != nullptr) {
-        delete[] m_envelope;
-    }
+    m_future.waitForFinished();
     delete m_info;
     delete m_producer;
 }
 
 const qint64 *AudioEnvelope::envelope()
 {
-    if (m_envelope == nullptr) {
+    if (m_envelope.empty()) {
         loadEnvelope();
     }
-    return m_envelope;
+    return m_envelope.data();
 }
 int AudioEnvelope::envelopeSize() const
 {
     return m_envelopeSize;
 }
 
-void AudioEnvelope::loadEnvelope()
+void AudioEnvelope::setThreadCount(int count)
 {
-    Q_ASSERT(m_envelope == nullptr);
+    m_threadCount = count;
+}
 
-    qCDebug(KDENLIVE_LOG) << "Loading envelope ...";
+void AudioEnvelope::setCacheFile(const QString &path)
+{
+    m_cacheFile = path;
+}
 
-    int samplingRate = m_info->info(0)->samplingRate();
+qint64 AudioEnvelope::absSum(const qint16 *samples, int count)
+{
+    // Independent 32 bit lanes let the compiler vectorize the loop. Blocks are
+    // short enough for a lane to never overflow (8192 * 32768 < 2^31).
+    const int lanes = 8;
+    const int block = 8192 * lanes;
+    qint64 total = 0;
+    int i = 0;
+    while (count - i >= lanes) {
+        const int end = i + qMin(block, (count - i) / lanes * lanes);
+        qint32 acc[lanes] = {0, 0, 0, 0, 0, 0, 0, 0};
+        for (; i < end; i += lanes) {
+            for (int k = 0; k < lanes; ++k) {
+                acc[k] += std::abs((qint32)samples[i + k]);
+            }
+        }
+        for (int k = 0; k < lanes; ++k) {
+            total += acc[k];
+        }
+    }
+    for (; i < count; ++i) {
+        total += std::abs((qint32)samples[i]);
+    }
+    return total;
+}
+
+void AudioEnvelope::computeRange(int first, int count, int samplingRate, qint64 *out) const
+{
+    // Producers cannot be shared between threads, each range decodes with its own
+    Mlt::Producer producer(*(m_producer->profile()), m_path.toUtf8().constData());
+    if (!producer.is_valid()) {
+        std::fill(out, out + count, 0);
+        return;
+    }
+    producer.set("video_index", -1);
+    producer.seek(first);
+    producer.set_speed(1.0);
+    const double fps = producer.get_fps();
     mlt_audio_format format_s16 = mlt_audio_s16;
-    int channels = 1;
+    for (int i = 0; i < count; ++i) {
+        QScopedPointer<Mlt::Frame> frame(producer.get_frame());
+        int frequency = samplingRate;
+        int channels = 1;
+        int samples = mlt_sample_calculator(fps, samplingRate, first + i);
+        const auto *data = (frame != nullptr && frame->is_valid()) ? static_cast<const qint16 *>(frame->get_audio(format_s16, frequency, channels, samples))
+                                                                   : nullptr;
+        out[i] = data == nullptr ? 0 : absSum(data, samples * channels);
+    }
+}
 
-    m_envelope = new qint64[m_envelopeSize];
-    m_envelopeMax = 0;
-    m_envelopeMean = 0;
+bool AudioEnvelope::computeEnvelope(int first, int count, qint64 *out) const
+{
+    if (m_info->size() == 0) {
+        std::fill(out, out + count, 0);
+        return false;
+    }
+    int samplingRate = m_info->info(0)->samplingRate();
+    // A private pool, so that waiting for the ranges never starves the global pool this may run in
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMax(1, m_threadCount));
+    for (int start = 0; start < count; start += rangeSize) {
+        int frames = qMin(rangeSize, count - start);
+        QtConcurrent::run(&pool, [this, first, start, frames, samplingRate, out]() { computeRange(first + start, frames, samplingRate, out + start); });
+    }
+    pool.waitForDone();
+    return true;
+}
+
+bool AudioEnvelope::loadCache(std::vector<qint64> &envelope) const
+{
+    QFile file(m_cacheFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    quint32 magic, version, fpsMillis;
+    qint32 size;
+    stream >> magic >> version >> fpsMillis >> size;
+    if (stream.status() != QDataStream::Ok || magic != envelopeMagic || version != envelopeVersion || size != m_producer->get_length() ||
+        fpsMillis != (quint32)std::lround(m_producer->get_fps() * 1000)) {
+        return false;
+    }
+    envelope.resize((size_t)size);
+    int bytes = size * (int)sizeof(qint64);
+    return stream.readRawData(reinterpret_cast<char *>(envelope.data()), bytes) == bytes;
+}
+
+void AudioEnvelope::saveCache(const std::vector<qint64> &envelope) const
+{
+    QSaveFile file(m_cacheFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCDebug(KDENLIVE_LOG) << "Cannot write envelope cache" << m_cacheFile;
+        return;
+    }
+    QDataStream stream(&file);
+    stream << envelopeMagic << envelopeVersion << (quint32)std::lround(m_producer->get_fps() * 1000) << (qint32)envelope.size();
+    stream.writeRawData(reinterpret_cast<const char *>(envelope.data()), (int)(envelope.size() * sizeof(qint64)));
+    file.commit();
+}
+
+void AudioEnvelope::loadEnvelope()
+{
+    Q_ASSERT(m_envelope.empty());
+
+    qCDebug(KDENLIVE_LOG) << "Loading envelope ...";
 
     QTime t;
     t.start();
-    int count = 0;
-    m_producer->seek(m_offset);
-    m_producer->set_speed(1.0); // This is necessary, otherwise we don't get any new frames in the 2nd run.
-    for (int i = 0; i < m_envelopeSize; ++i) {
-        Mlt::Frame *frame = m_producer->get_frame(i);
-        qint64 position = mlt_frame_get_position(frame->get_frame());
-        int samples = mlt_sample_calculator(m_producer->get_fps(), samplingRate, position);
-
-        auto *data = static_cast<qint16 *>(frame->get_audio(format_s16, samplingRate, channels, samples));
-
-        qint64 sum = 0;
-        for (int k = 0; k < samples; ++k) {
-            sum += abs(data[k]);
+    if (!m_cacheFile.isEmpty()) {
+        // The whole clip is cached, the requested range is copied from it.
+        // The first envelope of a clip computes the cache while the others wait, then read it
+        std::shared_ptr<QMutex> lock = cacheLock(m_cacheFile);
+        std::vector<qint64> clipEnvelope;
+        lock->lock();
+        if (!loadCache(clipEnvelope)) {
+            clipEnvelope.resize((size_t)qMax(0, m_producer->get_length()));
+            if (computeEnvelope(0, (int)clipEnvelope.size(), clipEnvelope.data())) {
+                saveCache(clipEnvelope);
+            }
+        }
+        lock->unlock();
+        releaseCacheLock(m_cacheFile, lock);
+        if ((int)clipEnvelope.size() >= m_offset + m_envelopeSize) {
+            m_envelope.assign(clipEnvelope.begin() + m_offset, clipEnvelope.begin() + m_offset + m_envelopeSize);
         }
-        m_envelope[i] = sum;
+    }
+    if (m_envelope.empty()) {
+        m_envelope.resize((size_t)m_envelopeSize);
+        computeEnvelope(m_offset, m_envelopeSize, m_envelope.data());
+    }
 
+    m_envelopeMax = 0;
+    m_envelopeMean = 0;
+    for (qint64 sum : m_envelope) {
         m_envelopeMean += sum;
         if (sum > m_envelopeMax) {
             m_envelopeMax = sum;
         }
-
-        //        qCDebug(KDENLIVE_LOG) << position << '|' << m_producer->get_playtime()
-        //                  << '-' << m_producer->get_in() << '+' << m_producer->get_out() << ' ';
-
-        delete frame;
-
-        count++;
-        if (m_length > 0 && count > m_length) {
-            break;
-        }
     }
-    m_envelopeMean /= m_envelopeSize;
+    m_envelopeMean /= qMax(1, m_envelopeSize);
     qCDebug(KDENLIVE_LOG) << "Calculating the envelope (" << m_envelopeSize << " frames) took " << t.elapsed() << " ms.";
 }
 
@@ -133,7 +285,7 @@ int AudioEnvelope::startPos() const
 
 void AudioEnvelope::normalizeEnvelope(bool /*clampTo0*/)
 {
-    if (m_envelope == nullptr && !m_future.isRunning()) {
+    if (m_envelope.empty() && !m_future.isRunning()) {
         m_future = QtConcurrent::run(this, &AudioEnvelope::loadEnvelope);
         m_watcher.setFuture(m_future);
     }
@@ -141,6 +293,15 @@ void AudioEnvelope::normalizeEnvelope(bool /*clampTo0*/)
 
 void AudioEnvelope::slotProcessEnveloppe()
 {
+    centerEnvelope();
+    emit envelopeReady(this);
+}
+
+void AudioEnvelope::centerEnvelope()
+{
+    if (m_envelope.empty()) {
+        loadEnvelope();
+    }
     if (!m_envelopeIsNormalized) {
 
         m_envelopeMax = 0;
@@ -163,12 +324,11 @@ void AudioEnvelope::slotProcessEnveloppe()
 
         m_envelopeIsNormalized = true;
     }
-    emit envelopeReady(this);
 }
 
 QImage AudioEnvelope::drawEnvelope()
 {
-    if (m_envelope == nullptr) {
+    if (m_envelope.empty()) {
         loadEnvelope();
     }
 
@@ -190,7 +350,7 @@ QImage AudioEnvelope::drawEnvelope()
 
 void AudioEnvelope::dumpInfo() const
 {
-    if (m_envelope == nullptr) {
+    if (m_envelope.empty()) {
         qCDebug(KDENLIVE_LOG) << "Envelope not generated, no information available.";
     } else {
         qCDebug(KDENLIVE_LOG) << "Envelope info"
@@ -16,6 +16,7 @@
 
 #include <QFutureWatcher>
 #include <QObject>
+#include <vector>
 
 class QImage;
 
@@ -24,6 +25,11 @@ class QImage;
   with frame resolution. One entry is calculated by the sum
   of the absolute values of all samples in the current frame.
 
+  The clip is split in ranges of frames that are decoded in parallel, each
+  range by its own producer. When a cache file is set, the envelope of the
+  whole clip is computed once and stored there, so that aligning the same
+  clip again (with any offset / length) does not decode anything.
+
   See also: http://bemasc.net/wordpress/2011/07/26/an-auto-aligner-for-pitivi/
   */
 class AudioEnvelope : public QObject
@@ -38,8 +44,15 @@ public:
     qint64 const *envelope();
     int envelopeSize() const;
 
+    /// Sets the maximum number of threads decoding the clip, defaults to the number of cores.
+    void setThreadCount(int count);
+    /// Sets the file where the envelope of the whole clip is persisted, must be called before the envelope is loaded.
+    void setCacheFile(const QString &path);
+
     void loadEnvelope();
     void normalizeEnvelope(bool clampTo0 = false);
+    /// Loads the envelope if necessary and subtracts its mean, synchronously.
+    void centerEnvelope();
 
     QImage drawEnvelope();
 
@@ -48,8 +61,14 @@ public:
     int track() const;
     int startPos() const;
 
+    /// Sum of the absolute values of \a count samples.
+    static qint64 absSum(const qint16 *samples, int count);
+
 private:
-    qint64 *m_envelope;
+    std::vector<qint64> m_envelope;
+    QString m_path;
+    QString m_cacheFile;
+    int m_threadCount;
     Mlt::Producer *m_producer;
     AudioInfo *m_info;
     QFutureWatcher<void> m_watcher;
@@ -68,6 +87,13 @@ private:
     bool m_envelopeStdDevCalculated;
     bool m_envelopeIsNormalized;
 
+    /// Computes the envelope of \a count frames starting at \a first, in parallel, into \a out.
+    bool computeEnvelope(int first, int count, qint64 *out) const;
+    /// Decodes one range of frames with a dedicated producer.
+    void computeRange(int first, int count, int samplingRate, qint64 *out) const;
+    bool loadCache(std::vector<qint64> &envelope) const;
+    void saveCache(const std::vector<qint64> &envelope) const;
+
 private slots:
     void slotProcessEnveloppe();
 
@@ -0,0 +1,280 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "audioPeaks.h"
+
+#include <QDebug>
+#include <QSaveFile>
+#include <cmath>
+#include <cstring>
+
+namespace {
+const char peakMagic[4] = {'K', 'D', 'P', 'K'};
+// Bump when the layout of the file changes, old files are then recomputed
+const quint32 peakVersion = 1;
+// Number of pairs of a level merged in one pair of the next level
+const int pyramidFactor = 4;
+} // namespace
+
+AudioPeaks::AudioPeaks()
+    : m_data(nullptr)
+{
+    memset(&m_header, 0, sizeof(Header));
+}
+
+AudioPeaks::AudioPeaks(int channels, int frames, double fps, int levelsPerFrame, SampleFormat format)
+    : AudioPeaks()
+{
+    memcpy(m_header.magic, peakMagic, sizeof(peakMagic));
+    m_header.version = peakVersion;
+    m_header.channels = (quint32)qMax(1, channels);
+    m_header.format = (quint32)format;
+    m_header.levelsPerFrame = (quint32)qMax(1, levelsPerFrame);
+    m_header.frames = (quint32)qMax(0, frames);
+    m_header.fpsNum = (quint32)std::lround(fps * 1000);
+    m_header.fpsDen = 1000;
+    m_header.dataOffset = sizeof(Header);
+    // Silence is 0 in 16 bit and 128 in 8 bit format
+    m_buffer.fill(format == UInt8 ? char(128) : char(0), (int)m_header.channels * count() * 2 * sampleSize());
+    m_data = reinterpret_cast<const uchar *>(m_buffer.data());
+}
+
+AudioPeaks::~AudioPeaks()
+{
+    if (m_file.isOpen() && m_data != nullptr) {
+        m_file.unmap(const_cast<uchar *>(m_data) - m_header.dataOffset);
+    }
+}
+
+std::shared_ptr<AudioPeaks> AudioPeaks::load(const QString &path)
+{
+    std::shared_ptr<AudioPeaks> peaks(new AudioPeaks());
+    peaks->m_file.setFileName(path);
+    if (path.isEmpty() || !peaks->m_file.open(QIODevice::ReadOnly)) {
+        return nullptr;
+    }
+    qint64 size = peaks->m_file.size();
+    if (size < (qint64)sizeof(Header) || peaks->m_file.read(reinterpret_cast<char *>(&peaks->m_header), sizeof(Header)) != sizeof(Header) ||
+        !peaks->validHeader(size)) {
+        return nullptr;
+    }
+    uchar *map = peaks->m_file.map(0, size);
+    if (map == nullptr) {
+        qDebug() << "Cannot map audio thumbnail" << path;
+        return nullptr;
+    }
+    peaks->m_data = map + peaks->m_header.dataOffset;
+    return peaks;
+}
+
+bool AudioPeaks::save(const QString &path) const
+{
+    QSaveFile file(path);
+    if (path.isEmpty() || !file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    Header header = m_header;
+    header.dataOffset = sizeof(Header);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+    file.write(reinterpret_cast<const char *>(m_data), (qint64)channels() * count() * 2 * sampleSize());
+    return file.commit();
+}
+
+bool AudioPeaks::validHeader(qint64 fileSize) const
+{
+    if (memcmp(m_header.magic, peakMagic, sizeof(peakMagic)) != 0 || m_header.version != peakVersion) {
+        return false;
+    }
+    if (m_header.format > Int16 || m_header.channels == 0 || m_header.levelsPerFrame == 0 || m_header.fpsDen == 0 ||
+        m_header.dataOffset < sizeof(Header)) {
+        return false;
+    }
+    qint64 dataSize = (qint64)m_header.channels * m_header.frames * m_header.levelsPerFrame * 2 * sampleSize();
+    return m_header.dataOffset + dataSize <= fileSize;
+}
+
+int AudioPeaks::channels() const
+{
+    return (int)m_header.channels;
+}
+
+int AudioPeaks::frames() const
+{
+    return (int)m_header.frames;
+}
+
+double AudioPeaks::fps() const
+{
+    return (double)m_header.fpsNum / m_header.fpsDen;
+}
+
+int AudioPeaks::levelsPerFrame() const
+{
+    return (int)m_header.levelsPerFrame;
+}
+
+int AudioPeaks::count() const
+{
+    return (int)(m_header.frames * m_header.levelsPerFrame);
+}
+
+AudioPeaks::SampleFormat AudioPeaks::format() const
+{
+    return (SampleFormat)m_header.format;
+}
+
+int AudioPeaks::sampleSize() const
+{
+    return m_header.format == UInt8 ? 1 : 2;
+}
+
+const uchar *AudioPeaks::pairAt(int channel, int index) const
+{
+    Q_ASSERT(channel >= 0 && channel < channels() && index >= 0 && index < count());
+    return m_data + ((size_t)channel * (size_t)count() + (size_t)index) * 2 * (size_t)sampleSize();
+}
+
+qint16 AudioPeaks::minimum(int channel, int index) const
+{
+    const uchar *pair = pairAt(channel, index);
+    if (m_header.format == UInt8) {
+        return (qint16)((pair[0] - 128) * 256);
+    }
+    return reinterpret_cast<const qint16 *>(pair)[0];
+}
+
+qint16 AudioPeaks::maximum(int channel, int index) const
+{
+    const uchar *pair = pairAt(channel, index);
+    if (m_header.format == UInt8) {
+        return (qint16)((pair[1] - 128) * 256);
+    }
+    return reinterpret_cast<const qint16 *>(pair)[1];
+}
+
+double AudioPeaks::level(int channel, int index) const
+{
+    return qMax(-(int)minimum(channel, index), (int)maximum(channel, index)) / 32768.;
+}
+
+void AudioPeaks::setPeak(int channel, int index, qint16 min, qint16 max)
+{
+    // Only thumbnails created in memory can be modified
+    Q_ASSERT(!m_buffer.isEmpty() && m_data == reinterpret_cast<const uchar *>(m_buffer.constData()));
+    auto *pair = const_cast<uchar *>(pairAt(channel, index));
+    if (m_header.format == UInt8) {
+        pair[0] = (uchar)((min >> 8) + 128);
+        pair[1] = (uchar)((max >> 8) + 128);
+    } else {
+        reinterpret_cast<qint16 *>(pair)[0] = min;
+        reinterpret_cast<qint16 *>(pair)[1] = max;
+    }
+}
+
+void AudioPeaks::buildPyramid()
+{
+    m_levels.clear();
+    int size = count();
+    int chans = channels();
+    while (size > pyramidFactor) {
+        Level next;
+        next.size = (size + pyramidFactor - 1) / pyramidFactor;
+        next.data.resize((size_t)(chans * next.size * 2));
+        const Level *previous = m_levels.empty() ? nullptr : &m_levels.back();
+        for (int channel = 0; channel < chans; ++channel) {
+            qint16 *out = next.data.data() + (size_t)channel * (size_t)next.size * 2;
+            const qint16 *in = previous ? previous->data.data() + (size_t)channel * (size_t)size * 2 : nullptr;
+            for (int i = 0; i < next.size; ++i) {
+                int end = qMin(size, (i + 1) * pyramidFactor);
+                qint16 low = 32767;
+                qint16 high = -32768;
+                for (int j = i * pyramidFactor; j < end; ++j) {
+                    low = qMin(low, in ? in[2 * j] : minimum(channel, j));
+                    high = qMax(high, in ? in[2 * j + 1] : maximum(channel, j));
+                }
+                out[2 * i] = low;
+                out[2 * i + 1] = high;
+            }
+        }
+        m_levels.push_back(std::move(next));
+        size = m_levels.back().size;
+    }
+}
+
+int AudioPeaks::levelCount() const
+{
+    return 1 + (int)m_levels.size();
+}
+
+int AudioPeaks::levelSize(int level) const
+{
+    return level == 0 ? count() : m_levels[(size_t)level - 1].size;
+}
+
+const qint16 *AudioPeaks::levelData(int level, int channel) const
+{
+    Q_ASSERT(level > 0 && level < levelCount());
+    const Level &l = m_levels[(size_t)level - 1];
+    return l.data.data() + (size_t)channel * (size_t)l.size * 2;
+}
+
+void AudioPeaks::range(int channel, int from, int to, qint16 &min, qint16 &max) const
+{
+    from = qMax(0, from);
+    to = qMin(count(), to);
+    if (from >= to) {
+        min = max = 0;
+        return;
+    }
+    qint16 low = 32767;
+    qint16 high = -32768;
+    auto take = [&](int level, int index) {
+        if (level == 0) {
+            low = qMin(low, minimum(channel, index));
+            high = qMax(high, maximum(channel, index));
+        } else {
+            const qint16 *pair = levelData(level, channel) + 2 * index;
+            low = qMin(low, pair[0]);
+            high = qMax(high, pair[1]);
+        }
+    };
+    // Read the unaligned ends at the current level, then move the aligned middle part to the next level
+    int level = 0;
+    while (from < to) {
+        if (level + 1 < levelCount() && to - from >= pyramidFactor) {
+            while (from % pyramidFactor != 0) {
+                take(level, from++);
+            }
+            while (to % pyramidFactor != 0) {
+                take(level, --to);
+            }
+            from /= pyramidFactor;
+            to /= pyramidFactor;
+            level++;
+        } else {
+            for (; from < to; ++from) {
+                take(level, from);
+            }
+        }
+    }
+    min = low;
+    max = high;
+}
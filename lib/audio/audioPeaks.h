@@ -0,0 +1,123 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef AUDIOPEAKS_H
+#define AUDIOPEAKS_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QMetaType>
+#include <QString>
+#include <memory>
+#include <vector>
+
+/**
+  Audio thumbnail of a clip: for each channel, a contiguous array of min / max
+  sample pairs, with a fixed number of pairs per video frame.
+
+  The peaks are stored in a versioned binary file that starts with a fixed size
+  header followed by the raw arrays, channel after channel. Loading a file maps
+  it in memory, so that no decoding nor copy happens before the waveform can be
+  drawn. Values are stored either as 8 bit (centered on 128) or 16 bit signed
+  samples, they are always returned in the 16 bit range.
+
+  For zoomed out views, buildPyramid() precomputes coarser min / max levels,
+  each one merging 4 pairs of the previous level (1x, 4x, 16x, 64x...), so that
+  the peaks of any range are found by reading a handful of values whatever its
+  length. The pyramid is only kept in memory, it is cheap to rebuild.
+  */
+class AudioPeaks
+{
+public:
+    enum SampleFormat { UInt8 = 0, Int16 = 1 };
+
+    /// Creates an empty (silent) thumbnail in memory, to be filled with setPeak().
+    AudioPeaks(int channels, int frames, double fps, int levelsPerFrame = 1, SampleFormat format = Int16);
+    ~AudioPeaks();
+
+    /// Maps the given peak file, returns nullptr if it does not exist or cannot be used.
+    static std::shared_ptr<AudioPeaks> load(const QString &path);
+    /// Writes the thumbnail to a peak file.
+    bool save(const QString &path) const;
+
+    int channels() const;
+    int frames() const;
+    double fps() const;
+    int levelsPerFrame() const;
+    /// Number of min / max pairs per channel, ie. frames() * levelsPerFrame().
+    int count() const;
+    SampleFormat format() const;
+
+    qint16 minimum(int channel, int index) const;
+    qint16 maximum(int channel, int index) const;
+    /// Returns the absolute peak of a pair, in the 0 - 1 range.
+    double level(int channel, int index) const;
+    void setPeak(int channel, int index, qint16 min, qint16 max);
+
+    /// Computes the coarser levels. Must be called before the peaks are shared with other threads.
+    void buildPyramid();
+    /// Number of levels, level 0 being the full resolution data.
+    int levelCount() const;
+    /// Number of pairs per channel in a level.
+    int levelSize(int level) const;
+    /// Contiguous min / max pairs of a channel in a level, level must be 1 or more.
+    const qint16 *levelData(int level, int channel) const;
+    /// Lowest and highest value between pairs \a from (included) and \a to (excluded), using the coarsest levels possible.
+    void range(int channel, int from, int to, qint16 &min, qint16 &max) const;
+
+private:
+    struct Header
+    {
+        char magic[4];
+        quint32 version;
+        quint32 channels;
+        quint32 format;
+        quint32 levelsPerFrame;
+        quint32 frames;
+        quint32 fpsNum;
+        quint32 fpsDen;
+        quint32 dataOffset;
+        quint32 reserved[7];
+    };
+
+    AudioPeaks();
+    bool validHeader(qint64 fileSize) const;
+    int sampleSize() const;
+    const uchar *pairAt(int channel, int index) const;
+
+    struct Level
+    {
+        int size;
+        std::vector<qint16> data;
+    };
+
+    Header m_header;
+    // Coarser levels, m_levels[0] is level 1
+    std::vector<Level> m_levels;
+    // Either a mapped file or a buffer owned by this object holds the arrays
+    QFile m_file;
+    QByteArray m_buffer;
+    const uchar *m_data;
+};
+
+Q_DECLARE_METATYPE(std::shared_ptr<const AudioPeaks>)
+
+#endif // AUDIOPEAKS_H
@@ -10,125 +10,183 @@ the Free Software Foundation, either version 3 of the License, or
 
 #include "fftCorrelation.h"
 
-extern "C" {
-#include "../external/kiss_fft/tools/kiss_fftr.h"
-}
-
 #include "kdenlive_debug.h"
 #include <QTime>
 #include <algorithm>
-#include <vector>
 
-void FFTCorrelation::correlate(const qint64 *left, const int leftSize, const qint64 *right, const int rightSize, qint64 *out_correlated)
+FFTCorrelation::FFTCorrelation()
+    : m_referenceFFTSize(0)
 {
-    float correlatedFloat[leftSize + rightSize + 1];
-    correlate(left, leftSize, right, rightSize, correlatedFloat);
+}
 
-    // The correlation vector will have entries up to N (number of entries
-    // of the vector), so converting to integers will not lose that much
-    // of precision.
-    for (int i = 0; i < leftSize + rightSize + 1; ++i) {
-        out_correlated[i] = correlatedFloat[i];
+FFTCorrelation::~FFTCorrelation()
+{
+    for (auto &plan : m_plans) {
+        kiss_fftr_free(plan.second.forward);
+        kiss_fftr_free(plan.second.inverse);
     }
 }
 
-void FFTCorrelation::correlate(const qint64 *left, const int leftSize, const qint64 *right, const int rightSize, float *out_correlated)
+int FFTCorrelation::transformSize(int largestSize)
 {
-    QTime t;
-    t.start();
+    // To avoid issues with repetition (we are dealing with cosine waves
+    // in the fourier domain) we need to pad the vectors to at least twice their size,
+    // otherwise convolution would convolve with the repeated pattern as well.
+    // The vectors must have the same size (same frequency resolution!) and should
+    // be a power of 2 (for FFT).
+    int size = 64;
+    while (size / 2 < largestSize) {
+        size = size << 1;
+    }
+    return size;
+}
 
-    float leftF[leftSize];
-    float rightF[rightSize];
+const FFTCorrelation::Plan &FFTCorrelation::plan(int size)
+{
+    auto it = m_plans.find(size);
+    if (it == m_plans.end()) {
+        Plan plan;
+        plan.forward = kiss_fftr_alloc(size, 0, nullptr, nullptr);
+        plan.inverse = kiss_fftr_alloc(size, 1, nullptr, nullptr);
+        it = m_plans.emplace(size, plan).first;
+    }
+    return it->second;
+}
 
-    // First the qint64 values need to be normalized to floats
+void FFTCorrelation::normalize(const qint64 *in, int size, bool reverse, std::vector<float> &out)
+{
     // Dividing by the max value is maybe not the best solution, but the
     // maximum value after correlation should not be larger than the longest
     // vector since each value should be at most 1
-    qint64 maxLeft = 1;
-    qint64 maxRight = 1;
-    for (int i = 0; i < leftSize; ++i) {
-        if (labs(left[i]) > maxLeft) {
-            maxLeft = labs(left[i]);
-        }
+    qint64 maxValue = 1;
+    for (int i = 0; i < size; ++i) {
+        maxValue = qMax(maxValue, qAbs(in[i]));
     }
-    for (int i = 0; i < rightSize; ++i) {
-        if (labs(right[i]) > maxRight) {
-            maxRight = labs(right[i]);
-        }
+    out.resize((size_t)size);
+    for (int i = 0; i < size; ++i) {
+        out[reverse ? size - 1 - i : i] = double(in[i]) / maxValue;
     }
+}
 
-    // One side needs to be reversed, since multiplication in frequency domain (fourier space)
-    // calculates the convolution: \sum l[x]r[N-x] and not the correlation: \sum l[x]r[x]
-    for (int i = 0; i < leftSize; ++i) {
-        leftF[i] = double(left[i]) / maxLeft;
-    }
-    for (int i = 0; i < rightSize; ++i) {
-        rightF[rightSize - 1 - i] = double(right[i]) / maxRight;
+void FFTCorrelation::forward(const float *data, int dataSize, int size, std::vector<kiss_fft_cpx> &spectrum)
+{
+    // Fill in the data with padding
+    m_timeData.assign((size_t)size, 0);
+    std::copy(data, data + dataSize, m_timeData.begin());
+    spectrum.resize((size_t)size / 2 + 1);
+    kiss_fftr(plan(size).forward, m_timeData.data(), spectrum.data());
+}
+
+void FFTCorrelation::convolveSpectra(const std::vector<kiss_fft_cpx> &left, const std::vector<kiss_fft_cpx> &right, int size, int outSize, float *out_convolved)
+{
+    // Convolution in spacial domain is a multiplication in fourier domain. O(n).
+    const size_t fftSize = (size_t)size / 2 + 1;
+    m_productFFT.resize(fftSize);
+    for (size_t i = 0; i < fftSize; ++i) {
+        m_productFFT[i].r = left[i].r * right[i].r - left[i].i * right[i].i;
+        m_productFFT[i].i = left[i].r * right[i].i + left[i].i * right[i].r;
     }
 
-    // Now we can convolve to get the correlation
-    convolve(leftF, leftSize, rightF, rightSize, out_correlated);
+    // Inverse fourier tranformation to get the convolved data.
+    // Insert one element at the beginning to obtain the same result
+    // that we also get with the nested for loop correlation.
+    m_timeData.resize((size_t)size);
+    kiss_fftri(plan(size).inverse, m_productFFT.data(), m_timeData.data());
+    *out_convolved = 0;
+    std::copy(m_timeData.begin(), m_timeData.begin() + outSize - 1, out_convolved + 1);
+}
 
-    qCDebug(KDENLIVE_LOG) << "Correlation (FFT based) computed in " << t.elapsed() << " ms.";
+void FFTCorrelation::updateReferenceFFT(int largestSize)
+{
+    int size = transformSize(largestSize);
+    if (size > m_referenceFFTSize) {
+        forward(m_reference.data(), (int)m_reference.size(), size, m_referenceFFT);
+        m_referenceFFTSize = size;
+    }
 }
 
-void FFTCorrelation::convolve(const float *left, const int leftSize, const float *right, const int rightSize, float *out_convolved)
+void FFTCorrelation::setReference(const qint64 *reference, const int referenceSize, const int maxChildSize)
 {
-    QTime time;
-    time.start();
+    normalize(reference, referenceSize, false, m_reference);
+    m_referenceFFTSize = 0;
+    updateReferenceFFT(qMax(referenceSize, maxChildSize));
+}
 
-    // To avoid issues with repetition (we are dealing with cosine waves
-    // in the fourier domain) we need to pad the vectors to at least twice their size,
-    // otherwise convolution would convolve with the repeated pattern as well
-    int largestSize = leftSize;
-    if (rightSize > largestSize) {
-        largestSize = rightSize;
-    }
+void FFTCorrelation::setReference(const FFTCorrelation &other)
+{
+    m_reference = other.m_reference;
+    m_referenceFFT = other.m_referenceFFT;
+    m_referenceFFTSize = other.m_referenceFFTSize;
+}
 
-    // The vectors must have the same size (same frequency resolution!) and should
-    // be a power of 2 (for FFT).
-    int size = 64;
-    while (size / 2 < largestSize) {
-        size = size << 1;
-    }
+void FFTCorrelation::correlateWithReference(const qint64 *child, const int childSize, float *out_correlated)
+{
+    QTime t;
+    t.start();
 
-    const int fft_size = size / 2 + 1;
-    kiss_fftr_cfg fftConfig = kiss_fftr_alloc(size, 0, nullptr, nullptr);
-    kiss_fftr_cfg ifftConfig = kiss_fftr_alloc(size, 1, nullptr, nullptr);
-    std::vector<kiss_fft_cpx> leftFFT(fft_size);
-    std::vector<kiss_fft_cpx> rightFFT(fft_size);
-    std::vector<kiss_fft_cpx> correlatedFFT(fft_size);
+    const int referenceSize = (int)m_reference.size();
+    // Grows the reference spectrum if this child is longer than the previous ones.
+    // A larger transform than needed is kept for smaller children.
+    updateReferenceFFT(qMax(referenceSize, childSize));
 
-    // Fill in the data into our new vectors with padding
-    std::vector<float> leftData(size, 0);
-    std::vector<float> rightData(size, 0);
-    std::vector<float> convolved(size);
+    // One side needs to be reversed, since multiplication in frequency domain (fourier space)
+    // calculates the convolution: \sum l[x]r[N-x] and not the correlation: \sum l[x]r[x]
+    normalize(child, childSize, true, m_child);
+    forward(m_child.data(), childSize, m_referenceFFTSize, m_childFFT);
+    const int outSize = referenceSize + childSize + 1;
+    convolveSpectra(m_referenceFFT, m_childFFT, m_referenceFFTSize, outSize, out_correlated);
+
+    // The inverse transform is not normalized, scale the result to the one of the smallest transform
+    const int size = transformSize(qMax(referenceSize, childSize));
+    if (size != m_referenceFFTSize) {
+        const float scale = float(size) / m_referenceFFTSize;
+        for (int i = 0; i < outSize; ++i) {
+            out_correlated[i] *= scale;
+        }
+    }
 
-    std::copy(left, left + leftSize, leftData.begin());
-    std::copy(right, right + rightSize, rightData.begin());
+    qCDebug(KDENLIVE_LOG) << "Correlation (FFT based) computed in " << t.elapsed() << " ms.";
+}
 
-    // Fourier transformation of the vectors
-    kiss_fftr(fftConfig, &leftData[0], &leftFFT[0]);
-    kiss_fftr(fftConfig, &rightData[0], &rightFFT[0]);
+void FFTCorrelation::correlateWithReference(const qint64 *child, const int childSize, qint64 *out_correlated)
+{
+    const int outSize = (int)m_reference.size() + childSize + 1;
+    m_correlated.resize((size_t)outSize);
+    correlateWithReference(child, childSize, m_correlated.data());
 
-    // Convolution in spacial domain is a multiplication in fourier domain. O(n).
-    for (int i = 0; i < correlatedFFT.size(); ++i) {
-        correlatedFFT[i].r = leftFFT[i].r * rightFFT[i].r - leftFFT[i].i * rightFFT[i].i;
-        correlatedFFT[i].i = leftFFT[i].r * rightFFT[i].i + leftFFT[i].i * rightFFT[i].r;
+    // The correlation vector will have entries up to N (number of entries
+    // of the vector), so converting to integers will not lose that much
+    // of precision.
+    for (int i = 0; i < outSize; ++i) {
+        out_correlated[i] = m_correlated[(size_t)i];
     }
+}
 
-    // Inverse fourier tranformation to get the convolved data.
-    // Insert one element at the beginning to obtain the same result
-    // that we also get with the nested for loop correlation.
-    *out_convolved = 0;
-    int out_size = leftSize + rightSize + 1;
+void FFTCorrelation::correlate(const qint64 *left, const int leftSize, const qint64 *right, const int rightSize, qint64 *out_correlated)
+{
+    FFTCorrelation engine;
+    engine.setReference(left, leftSize, rightSize);
+    engine.correlateWithReference(right, rightSize, out_correlated);
+}
 
-    kiss_fftri(ifftConfig, &correlatedFFT[0], &convolved[0]);
-    std::copy(convolved.begin(), convolved.begin() + out_size - 1, out_convolved + 1);
+void FFTCorrelation::correlate(const qint64 *left, const int leftSize, const qint64 *right, const int rightSize, float *out_correlated)
+{
+    FFTCorrelation engine;
+    engine.setReference(left, leftSize, rightSize);
+    engine.correlateWithReference(right, rightSize, out_correlated);
+}
+
+void FFTCorrelation::convolve(const float *left, const int leftSize, const float *right, const int rightSize, float *out_convolved)
+{
+    QTime time;
+    time.start();
 
-    // Finally some cleanup.
-    kiss_fftr_free(fftConfig);
-    kiss_fftr_free(ifftConfig);
+    FFTCorrelation engine;
+    int size = transformSize(qMax(leftSize, rightSize));
+    std::vector<kiss_fft_cpx> leftFFT;
+    engine.forward(left, leftSize, size, leftFFT);
+    engine.forward(right, rightSize, size, engine.m_childFFT);
+    engine.convolveSpectra(leftFFT, engine.m_childFFT, size, leftSize + rightSize + 1, out_convolved);
 
     qCDebug(KDENLIVE_LOG) << "FFT convolution computed. Time taken: " << time.elapsed() << " ms";
 }
@@ -11,16 +11,50 @@ the Free Software Foundation, either version 3 of the License, or
 #ifndef FFTCORRELATION_H
 #define FFTCORRELATION_H
 
+#include "../external/kiss_fft/tools/kiss_fftr.h"
 #include <QtGlobal>
+#include <unordered_map>
+#include <vector>
+
 /**
   This class provides methods to calculate convolution
   and correlation of two vectors by means of FFT, which
   is O(n log n) (convolution in spacial domain would be
   O(n²)).
+
+  An FFTCorrelation object is a correlation engine: it owns its
+  workspaces and keeps the FFT plans of every size it used, so that
+  correlating many vectors does not allocate once the sizes are known.
+  A reference vector can be set once and correlated with any number of
+  children, its spectrum is only computed again when a child needs a
+  larger FFT. An engine must not be used by several threads at once.
   */
 class FFTCorrelation
 {
 public:
+    FFTCorrelation();
+    ~FFTCorrelation();
+    FFTCorrelation(const FFTCorrelation &) = delete;
+    FFTCorrelation &operator=(const FFTCorrelation &) = delete;
+
+    /**
+      Sets the vector children are correlated with. \c maxChildSize
+      is the size of the largest child to come, if known, so that the
+      spectrum of the reference is computed only once.
+      */
+    void setReference(const qint64 *reference, const int referenceSize, const int maxChildSize = 0);
+    /// Uses the reference of another engine, without computing its spectrum again.
+    void setReference(const FFTCorrelation &other);
+
+    /**
+      Computes the correlation between the reference and \c child, identical
+      to correlate(reference, referenceSize, child, childSize, out_correlated).
+      \c out_correlated must be a pre-allocated vector of size
+      \c referenceSize + \c childSize + 1.
+      */
+    void correlateWithReference(const qint64 *child, const int childSize, float *out_correlated);
+    void correlateWithReference(const qint64 *child, const int childSize, qint64 *out_correlated);
+
     /**
       Computes the convolution between \c left and \c right.
       \c out_correlated must be a pre-allocated vector of size
@@ -36,6 +70,37 @@ public:
     static void correlate(const qint64 *left, const int leftSize, const qint64 *right, const int rightSize, float *out_correlated);
 
     static void correlate(const qint64 *left, const int leftSize, const qint64 *right, const int rightSize, qint64 *out_correlated);
+
+private:
+    struct Plan
+    {
+        kiss_fftr_cfg forward;
+        kiss_fftr_cfg inverse;
+    };
+
+    /// FFT plans by transform size
+    std::unordered_map<int, Plan> m_plans;
+
+    std::vector<float> m_reference;
+    std::vector<kiss_fft_cpx> m_referenceFFT;
+    int m_referenceFFTSize;
+
+    // Workspaces
+    std::vector<float> m_child;
+    std::vector<kiss_fft_cpx> m_childFFT;
+    std::vector<kiss_fft_cpx> m_productFFT;
+    std::vector<float> m_timeData;
+    std::vector<float> m_correlated;
+
+    /// Smallest transform size that avoids circular overlap for vectors up to \c largestSize
+    static int transformSize(int largestSize);
+    /// Scales the vector to the -1..1 range, optionally reversing it.
+    static void normalize(const qint64 *in, int size, bool reverse, std::vector<float> &out);
+
+    const Plan &plan(int size);
+    void forward(const float *data, int dataSize, int size, std::vector<kiss_fft_cpx> &spectrum);
+    void convolveSpectra(const std::vector<kiss_fft_cpx> &left, const std::vector<kiss_fft_cpx> &right, int size, int outSize, float *out_convolved);
+    void updateReferenceFFT(int largestSize);
 };
 
 #endif // FFTCORRELATION_H
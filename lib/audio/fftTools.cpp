@@ -10,11 +10,11 @@
 
 #include "fftTools.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <math.h>
 
-#include <QString>
-
 // Uncomment for debugging, like writing a GNU Octave .m file to /tmp
 //#define DEBUG_FFTTOOLS
 
@@ -25,27 +25,17 @@
 #endif
 
 FFTTools::FFTTools()
-    : m_fftCfgs()
-    , m_windowFunctions()
+    : m_plans()
+    , m_windows()
 {
 }
 FFTTools::~FFTTools()
 {
-    QHash<QString, kiss_fftr_cfg>::iterator i;
-    for (i = m_fftCfgs.begin(); i != m_fftCfgs.end(); ++i) {
-        free(*i);
+    for (auto &p : m_plans) {
+        free(p.second.cfg);
     }
 }
 
-const QString FFTTools::windowSignature(const WindowType windowType, const int size, const float param)
-{
-    return QStringLiteral("s%1_t%2_p%3").arg(size).arg(windowType).arg(param, 0, 'f', 3);
-}
-const QString FFTTools::cfgSignature(const int size)
-{
-    return QStringLiteral("s%1").arg(size);
-}
-
 // http://cplusplus.syntaxerrors.info/index.php?title=Cannot_declare_member_function_%E2%80%98static_int_Foo::bar%28%29%E2%80%99_to_have_static_linkage
 const QVector<float> FFTTools::window(const WindowType windowType, const int size, const float param)
 {
@@ -111,123 +101,183 @@ const QVector<float> FFTTools::window(const WindowType windowType, const int siz
     return QVector<float>();
 }
 
-void FFTTools::fftNormalized(const audioShortVector &audioFrame, const uint channel, const uint numChannels, float *freqSpectrum, const WindowType windowType,
-                             const uint windowSize, const float param)
+FFTTools::Plan &FFTTools::plan(const uint windowSize)
 {
+    auto it = m_plans.find(windowSize);
+    if (it != m_plans.end()) {
+        return it->second;
+    }
 #ifdef DEBUG_FFTTOOLS
-    QTime start = QTime::currentTime();
+    qCDebug(KDENLIVE_LOG) << "Creating FFT configuration with size " << windowSize;
 #endif
+    Plan &p = m_plans[windowSize];
+    p.cfg = kiss_fftr_alloc((int)windowSize, 0, nullptr, nullptr);
+    p.data.resize(windowSize);
+    // kiss_fftr writes windowSize/2 + 1 values, including the Nyquist frequency
+    p.freqData.resize(windowSize / 2 + 1);
+    p.power.resize(windowSize / 2);
+    return p;
+}
 
-    const uint numSamples = audioFrame.size() / numChannels;
-
-    if (((windowSize & 1) != 0u) || windowSize < 2) {
-        return;
+const std::vector<float> &FFTTools::windowFunction(const WindowType windowType, const uint windowSize, const float param)
+{
+    // Size, type and parameter (with a precision of 1/1000) packed in one key
+    const quint64 key = ((quint64)windowSize << 32) | ((quint64)windowType << 24) | (quint64)(qBound(0, qRound(param * 1000), 0xffffff));
+    auto it = m_windows.find(key);
+    if (it != m_windows.end()) {
+        return it->second;
     }
-
-    const QString cfgSig = cfgSignature(windowSize);
-    const QString winSig = windowSignature(windowType, windowSize, param);
-
-    // Get the kiss_fft configuration from the config cache
-    // or build a new configuration if the requested one is not available.
-    kiss_fftr_cfg myCfg;
-    if (m_fftCfgs.contains(cfgSig)) {
 #ifdef DEBUG_FFTTOOLS
-        qCDebug(KDENLIVE_LOG) << "Re-using FFT configuration with size " << windowSize;
+    qCDebug(KDENLIVE_LOG) << "Building new window function of type " << windowType << " with size " << windowSize;
 #endif
-        myCfg = m_fftCfgs.value(cfgSig);
-    } else {
-#ifdef DEBUG_FFTTOOLS
-        qCDebug(KDENLIVE_LOG) << "Creating FFT configuration with size " << windowSize;
-#endif
-        myCfg = kiss_fftr_alloc(windowSize, 0, nullptr, nullptr);
-        m_fftCfgs.insert(cfgSig, myCfg);
-    }
-
-    // Get the window function from the cache
-    // (except for a rectangular window; nothing to do there).
-    QVector<float> window;
-    float windowScaleFactor = 1;
+    std::vector<float> &w = m_windows[key];
     if (windowType != FFTTools::Window_Rect) {
+        const QVector<float> window = FFTTools::window(windowType, (int)windowSize, param);
+        // Apply the scale factor of the window and the normalization of samples to [0,1] once here
+        const float scale = 1.0f / window[(int)windowSize];
+        w.resize(windowSize);
+        for (uint i = 0; i < windowSize; ++i) {
+            w[i] = window[(int)i] * scale;
+        }
+    }
+    return w;
+}
 
-        if (m_windowFunctions.contains(winSig)) {
-#ifdef DEBUG_FFTTOOLS
-            qCDebug(KDENLIVE_LOG) << "Re-using window function with signature " << winSig;
-#endif
-            window = m_windowFunctions.value(winSig);
-        } else {
-#ifdef DEBUG_FFTTOOLS
-            qCDebug(KDENLIVE_LOG) << "Building new window function with signature " << winSig;
-#endif
-            window = FFTTools::window(windowType, windowSize, 0);
-            m_windowFunctions.insert(winSig, window);
+void FFTTools::deinterleave(const qint16 *audioFrame, const uint numSamples, const uint numChannels, float *const *planes)
+{
+    const float factor = 1.0f / 32767.0f;
+    if (numChannels == 2) {
+        // Most common case, with a fixed stride the compiler can vectorize the loop
+        float *left = planes[0];
+        float *right = planes[1];
+        for (uint i = 0; i < numSamples; ++i) {
+            left[i] = (float)audioFrame[2 * i] * factor;
+            right[i] = (float)audioFrame[2 * i + 1] * factor;
+        }
+        return;
+    }
+    for (uint c = 0; c < numChannels; ++c) {
+        float *plane = planes[c];
+        const qint16 *in = audioFrame + c;
+        for (uint i = 0; i < numSamples; ++i) {
+            plane[i] = (float)in[i * numChannels] * factor;
         }
-        windowScaleFactor = 1.0 / window[windowSize];
     }
+}
 
-    // Prepare frequency space vector. The resulting FFT vector is only half as long.
-    kiss_fft_cpx freqData[windowSize / 2];
-    float data[windowSize];
+void FFTTools::transform(Plan &plan, const float *samples, const uint numSamples, float *freqSpectrum, const WindowType windowType, const uint windowSize,
+                         const float param)
+{
+    const std::vector<float> &window = windowFunction(windowType, windowSize, param);
+    float *data = plan.data.data();
+    const uint count = qMin(numSamples, windowSize);
 
-    // Copy the first channel's audio into a vector for the FFT display;
     // Fill the data vector indices that cannot be covered with sample data with 0
-    if (numSamples < windowSize) {
-        std::fill(&data[numSamples], &data[windowSize - 1], 0);
-    }
-    // Normalize signals to [0,1] to get correct dB values later on
-    for (uint i = 0; i < numSamples && i < windowSize; ++i) {
-        // Performance note: Benchmarking has shown that using the if/else inside the loop
-        // does not do noticeable worse than keeping it outside (perhaps the branch predictor
-        // is good enough), so it remains in there for better readability.
-        if (windowType != FFTTools::Window_Rect) {
-            data[i] = (float)audioFrame.data()[i * numChannels + channel] / 32767.0f * window[i];
-        } else {
-            data[i] = (float)audioFrame.data()[i * numChannels + channel] / 32767.0f;
+    if (window.empty()) {
+        std::copy(samples, samples + count, data);
+    } else {
+        const float *w = window.data();
+        for (uint i = 0; i < count; ++i) {
+            data[i] = samples[i] * w[i];
         }
     }
+    std::fill(data + count, data + windowSize, 0.0f);
 
     // Calculate the Fast Fourier Transform for the input data
-    kiss_fftr(myCfg, data, freqData);
+    kiss_fftr(plan.cfg, data, plan.freqData.data());
 
     // Logarithmic scale: 20 * log ( 2 * magnitude / N ) with magnitude = sqrt(r² + i²)
-    // with N = FFT size (after FFT, 1/2 window size)
-    for (uint i = 0; i < windowSize / 2; ++i) {
-        // Logarithmic scale: 20 * log ( 2 * magnitude / N ) with magnitude = sqrt(r² + i²)
-        // with N = FFT size (after FFT, 1/2 window size)
-        freqSpectrum[i] =
-            20 * log(pow(pow(fabs(freqData[i].r * windowScaleFactor), 2) + pow(fabs(freqData[i].i * windowScaleFactor), 2), .5) / ((float)windowSize / 2.0f)) /
-            log(10);
-        ;
+    // with N = FFT size (after FFT, 1/2 window size).
+    // Computed as 10 * log (r² + i²) - 20 * log (N/2), without square root nor pow()
+    const uint bins = windowSize / 2;
+    const kiss_fft_cpx *freqData = plan.freqData.data();
+    float *power = plan.power.data();
+    for (uint i = 0; i < bins; ++i) {
+        power[i] = freqData[i].r * freqData[i].r + freqData[i].i * freqData[i].i;
+    }
+    const float offset = 20.0f * std::log10((float)bins);
+    for (uint i = 0; i < bins; ++i) {
+        // Silent bins give -inf like before, the scopes clamp to their dB range
+        freqSpectrum[i] = 10.0f * std::log10(power[i]) - offset;
     }
+}
 
+void FFTTools::fftNormalized(const qint16 *audioFrame, const uint numSamples, const uint channel, const uint numChannels, float *freqSpectrum, const WindowType windowType,
+                             const uint windowSize, const float param)
+{
 #ifdef DEBUG_FFTTOOLS
-    std::ofstream mFile;
-    mFile.open("/tmp/freq.m");
-    if (!mFile) {
-        qCDebug(KDENLIVE_LOG) << "Opening file failed.";
-    } else {
-        mFile << "val = [ ";
-
-        for (int sample = 0; sample < 256; ++sample) {
-            mFile << data[sample] << ' ';
-        }
-        mFile << " ];\n";
+    QTime start = QTime::currentTime();
+#endif
 
-        mFile << "freq = [ ";
-        for (int sample = 0; sample < 256; ++sample) {
-            mFile << freqData[sample].r << '+' << freqData[sample].i << "*i ";
-        }
-        mFile << " ];\n";
+    if (((windowSize & 1) != 0u) || windowSize < 2 || channel >= numChannels) {
+        return;
+    }
 
-        mFile.close();
-        qCDebug(KDENLIVE_LOG) << "File written.";
+    const uint count = qMin(numSamples, windowSize);
+    m_planes.resize(count);
+    float *plane = m_planes.data();
+    const float factor = 1.0f / 32767.0f;
+    for (uint i = 0; i < count; ++i) {
+        plane[i] = (float)audioFrame[i * numChannels + channel] * factor;
     }
-#endif
+    transform(plan(windowSize), plane, count, freqSpectrum, windowType, windowSize, param);
 
 #ifdef DEBUG_FFTTOOLS
     qCDebug(KDENLIVE_LOG) << "Calculated FFT in " << start.elapsed() << " ms.";
 #endif
 }
 
+void FFTTools::fftNormalized(const float *samples, const uint numSamples, float *freqSpectrum, const WindowType windowType, const uint windowSize,
+                             const float param)
+{
+    if (((windowSize & 1) != 0u) || windowSize < 2) {
+        return;
+    }
+    transform(plan(windowSize), samples, numSamples, freqSpectrum, windowType, windowSize, param);
+}
+
+void FFTTools::spectra(const qint16 *audioFrame, const uint numSamples, const uint numChannels, QVector<QVector<float>> &spectra, const WindowType windowType,
+                       const uint windowSize, const float param)
+{
+    if (((windowSize & 1) != 0u) || windowSize < 2 || numChannels == 0) {
+        spectra.clear();
+        return;
+    }
+    // Only the samples covered by the window are converted
+    const uint count = qMin(numSamples, windowSize);
+    m_planes.resize((size_t)count * numChannels);
+    std::vector<float *> planes(numChannels);
+    for (uint c = 0; c < numChannels; ++c) {
+        planes[c] = m_planes.data() + (size_t)c * count;
+    }
+    deinterleave(audioFrame, count, numChannels, planes.data());
+
+    spectra.resize((int)numChannels);
+    Plan &p = plan(windowSize);
+    for (uint c = 0; c < numChannels; ++c) {
+        QVector<float> &spectrum = spectra[(int)c];
+        spectrum.resize((int)windowSize / 2);
+        transform(p, planes[c], count, spectrum.data(), windowType, windowSize, param);
+    }
+}
+
+QVector<float> FFTTools::maximum(const QVector<QVector<float>> &spectra)
+{
+    if (spectra.isEmpty()) {
+        return QVector<float>();
+    }
+    QVector<float> result = spectra.first();
+    float *out = result.data();
+    for (int c = 1; c < spectra.size(); ++c) {
+        const float *in = spectra.at(c).constData();
+        const int size = qMin(result.size(), spectra.at(c).size());
+        for (int i = 0; i < size; ++i) {
+            out[i] = qMax(out[i], in[i]);
+        }
+    }
+    return result;
+}
+
 const QVector<float> FFTTools::interpolatePeakPreserving(const QVector<float> &in, const uint targetSize, uint left, uint right, float fill)
 {
 #ifdef DEBUG_FFTTOOLS
@@ -13,8 +13,9 @@
 
 #include "../../definitions.h"
 #include "../external/kiss_fft/tools/kiss_fftr.h"
-#include <QHash>
 #include <QVector>
+#include <unordered_map>
+#include <vector>
 
 class FFTTools
 {
@@ -39,24 +40,36 @@ public:
     */
     static const QVector<float> window(const WindowType windowType, const int size, const float param = 0);
 
-    static const QString windowSignature(const WindowType windowType, const int size, const float param = 0);
-
-    /** Returns a signature for a kiss_fft configuration
-        used as a hash in the cache */
-    static const QString cfgSignature(const int size);
+    /** Converts interleaved 16 bit samples to one float buffer per channel, in the -1 / 1 range.
+        * planes: numChannels pointers to buffers of at least numSamples values
+    */
+    static void deinterleave(const qint16 *audioFrame, const uint numSamples, const uint numChannels, float *const *planes);
 
-    /** Calculates the Fourier Tranformation of the input audio frame.
+    /** Calculates the Fourier Tranformation of one channel of the input audio frame.
         The resulting values will be given in relative dezibel: The maximum power is 0 dB, lower powers have
         negative dB values.
-        * audioFrame: Interleaved format with #numChannels channels
+        * audioFrame: Interleaved format with #numChannels channels, numSamples samples per channel
         * freqSpectrum: Array pointer to write the data into
         * windowSize must be divisible by 2,
         * freqSpectrum has to be of size windowSize/2
         For windowType and param see the FFTTools::window() function above.
     */
-    void fftNormalized(const audioShortVector &audioFrame, const uint channel, const uint numChannels, float *freqSpectrum, const WindowType windowType,
+    void fftNormalized(const qint16 *audioFrame, const uint numSamples, const uint channel, const uint numChannels, float *freqSpectrum, const WindowType windowType,
                        const uint windowSize, const float param = 0);
 
+    /** Same as above for planar float samples of a single channel, in the -1 / 1 range. */
+    void fftNormalized(const float *samples, const uint numSamples, float *freqSpectrum, const WindowType windowType, const uint windowSize,
+                       const float param = 0);
+
+    /** Calculates the spectrum of every channel of the input audio frame with one deinterleaving pass.
+        spectra is resized to numChannels vectors of windowSize/2 dB values.
+    */
+    void spectra(const qint16 *audioFrame, const uint numSamples, const uint numChannels, QVector<QVector<float>> &spectra, const WindowType windowType,
+                 const uint windowSize, const float param = 0);
+
+    /** Highest value of each bin over all the spectra, for displays that show all channels in one curve. */
+    static QVector<float> maximum(const QVector<QVector<float>> &spectra);
+
     /** This is linear interpolation with the special property that it preserves peaks, which is required
         for e.g. showing correct Decibel values (where the peak values are of interest because of clipping which
         may occur for too strong frequencies; The lower values are smeared by the window function anyway).
@@ -74,8 +87,23 @@ public:
     static const QVector<float> interpolatePeakPreserving(const QVector<float> &in, const uint targetSize, uint left = 0, uint right = 0, float fill = 0.0);
 
 private:
-    QHash<QString, kiss_fftr_cfg> m_fftCfgs;          // FFT cfg cache
-    QHash<QString, QVector<float>> m_windowFunctions; // Window function cache
+    /** FFT configuration and work buffers for one window size */
+    struct Plan
+    {
+        kiss_fftr_cfg cfg;
+        std::vector<float> data;
+        std::vector<kiss_fft_cpx> freqData;
+        std::vector<float> power;
+    };
+    Plan &plan(const uint windowSize);
+    /** Window function with its normalization applied, empty for the rectangular window */
+    const std::vector<float> &windowFunction(const WindowType windowType, const uint windowSize, const float param);
+    void transform(Plan &plan, const float *samples, const uint numSamples, float *freqSpectrum, const WindowType windowType, const uint windowSize,
+                   const float param);
+
+    std::unordered_map<uint, Plan> m_plans;                    // FFT cfg cache, keyed by window size
+    std::unordered_map<quint64, std::vector<float>> m_windows; // Window function cache
+    std::vector<float> m_planes;                               // Deinterleaved channels
 };
 
 #endif // FFTTOOLS_H
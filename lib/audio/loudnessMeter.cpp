@@ -0,0 +1,339 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "loudnessMeter.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Version of the cache file format, bump it when the analysis changes
+const int cacheVersion = 1;
+// Reported level for digital silence, in dB
+const double minimumLevel = -144.;
+// Blocks are 100 ms long: momentary loudness uses 4 of them, short-term loudness 30
+const int momentaryBlocks = 4;
+const int shortTermBlocks = 30;
+// Number of taps of each phase of the true peak interpolation filter
+const int tapsPerPhase = 12;
+
+double blockLoudness(double energy)
+{
+    return energy > 0. ? -0.691 + 10. * std::log10(energy) : minimumLevel;
+}
+
+double toDb(double peak)
+{
+    return peak > 0. ? qMax(minimumLevel, 20. * std::log10(peak)) : minimumLevel;
+}
+
+// Loudness of the energies above the absolute gate and the relative gate computed from them, as in BS.1770-4
+double gatedLoudness(const std::vector<double> &energies, double relativeGate, std::vector<double> *passed = nullptr)
+{
+    double sum = 0;
+    int count = 0;
+    for (double energy : energies) {
+        if (blockLoudness(energy) > -70.) {
+            sum += energy;
+            count++;
+        }
+    }
+    if (count == 0) {
+        return minimumLevel;
+    }
+    double threshold = blockLoudness(sum / count) + relativeGate;
+    sum = 0;
+    count = 0;
+    for (double energy : energies) {
+        double loudness = blockLoudness(energy);
+        if (loudness > -70. && loudness > threshold) {
+            sum += energy;
+            count++;
+            if (passed) {
+                passed->push_back(loudness);
+            }
+        }
+    }
+    return count > 0 ? blockLoudness(sum / count) : minimumLevel;
+}
+
+// Sums of consecutive blocks, in a sliding window of the given size
+std::vector<double> windowEnergies(const std::vector<double> &blocks, int window)
+{
+    std::vector<double> result;
+    if ((int)blocks.size() < window) {
+        return result;
+    }
+    result.reserve(blocks.size() - (size_t)window + 1);
+    double sum = 0;
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        sum += blocks[i];
+        if (i >= (size_t)window) {
+            sum -= blocks[i - (size_t)window];
+        }
+        if (i + 1 >= (size_t)window) {
+            result.push_back(qMax(0., sum) / window);
+        }
+    }
+    return result;
+}
+} // namespace
+
+bool LoudnessInfo::save(const QString &path) const
+{
+    if (!valid || path.isEmpty()) {
+        return false;
+    }
+    QJsonObject obj;
+    obj.insert(QStringLiteral("version"), cacheVersion);
+    obj.insert(QStringLiteral("integrated"), integrated);
+    obj.insert(QStringLiteral("momentaryMax"), momentaryMax);
+    obj.insert(QStringLiteral("shortTermMax"), shortTermMax);
+    obj.insert(QStringLiteral("range"), range);
+    obj.insert(QStringLiteral("truePeak"), truePeak);
+    obj.insert(QStringLiteral("samplePeak"), samplePeak);
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QJsonDocument(obj).toJson(QJsonDocument::Compact));
+    return true;
+}
+
+LoudnessInfo LoudnessInfo::load(const QString &path)
+{
+    LoudnessInfo info;
+    QFile file(path);
+    if (path.isEmpty() || !file.open(QIODevice::ReadOnly)) {
+        return info;
+    }
+    QJsonObject obj = QJsonDocument::fromJson(file.readAll()).object();
+    if (obj.value(QStringLiteral("version")).toInt() != cacheVersion) {
+        return info;
+    }
+    info.integrated = obj.value(QStringLiteral("integrated")).toDouble();
+    info.momentaryMax = obj.value(QStringLiteral("momentaryMax")).toDouble();
+    info.shortTermMax = obj.value(QStringLiteral("shortTermMax")).toDouble();
+    info.range = obj.value(QStringLiteral("range")).toDouble();
+    info.truePeak = obj.value(QStringLiteral("truePeak")).toDouble();
+    info.samplePeak = obj.value(QStringLiteral("samplePeak")).toDouble();
+    info.valid = true;
+    return info;
+}
+
+LoudnessMeter::LoudnessMeter(int channels, int frequency)
+    : m_channels(qMax(1, channels))
+    , m_frequency(frequency > 0 ? frequency : 48000)
+    , m_blockSize(qMax(1, (int)std::lround(m_frequency / 10.)))
+    , m_oversampling(m_frequency < 96000 ? 4 : (m_frequency < 192000 ? 2 : 1))
+    , m_taps(m_oversampling * tapsPerPhase)
+    , m_blockSum(0)
+    , m_blockFill(0)
+{
+    // K-weighting filters of BS.1770, recomputed for the actual sample rate
+    double k = std::tan(M_PI * 1681.974450955533 / m_frequency);
+    double q = 0.7071752369554196;
+    double vh = std::pow(10., 3.999843853973347 / 20.);
+    double vb = std::pow(vh, 0.4996667741545416);
+    double a0 = 1. + k / q + k * k;
+    m_stages[0] = {(vh + vb * k / q + k * k) / a0, 2. * (k * k - vh) / a0, (vh - vb * k / q + k * k) / a0, 2. * (k * k - 1.) / a0, (1. - k / q + k * k) / a0};
+    k = std::tan(M_PI * 38.13547087602444 / m_frequency);
+    q = 0.5003270373238773;
+    a0 = 1. + k / q + k * k;
+    m_stages[1] = {1., -2., 1., 2. * (k * k - 1.) / a0, (1. - k / q + k * k) / a0};
+
+    // Windowed sinc interpolation filter for the true peak, stored phase by phase
+    if (m_oversampling > 1) {
+        m_interpolation.resize((size_t)m_taps);
+        double center = (m_taps - 1) / 2.;
+        for (int phase = 0; phase < m_oversampling; ++phase) {
+            double sum = 0;
+            for (int i = 0; i < tapsPerPhase; ++i) {
+                int n = phase + i * m_oversampling;
+                double t = (n - center) / m_oversampling;
+                double sinc = std::abs(t) < 1e-9 ? 1. : std::sin(M_PI * t) / (M_PI * t);
+                double window = 0.42 - 0.5 * std::cos(2. * M_PI * n / (m_taps - 1)) + 0.08 * std::cos(4. * M_PI * n / (m_taps - 1));
+                m_interpolation[(size_t)(phase * tapsPerPhase + i)] = sinc * window;
+                sum += sinc * window;
+            }
+            for (int i = 0; i < tapsPerPhase; ++i) {
+                m_interpolation[(size_t)(phase * tapsPerPhase + i)] /= sum;
+            }
+        }
+    }
+    reset();
+}
+
+void LoudnessMeter::reset()
+{
+    m_state.assign((size_t)m_channels, ChannelState());
+    for (int c = 0; c < m_channels; ++c) {
+        ChannelState &state = m_state[(size_t)c];
+        // Channel weights for the usual L R C LFE Ls Rs layout, the LFE channel is ignored
+        if (m_channels >= 6 && c == 3) {
+            state.weight = 0.;
+        } else if (m_channels >= 6 && (c == 4 || c == 5)) {
+            state.weight = 1.41;
+        } else {
+            state.weight = 1.;
+        }
+        state.z[0][0] = state.z[0][1] = state.z[1][0] = state.z[1][1] = 0.;
+        state.history.assign(tapsPerPhase, 0.);
+        state.samplePeak = 0.;
+        state.truePeak = 0.;
+    }
+    m_blocks.clear();
+    m_blockSum = 0;
+    m_blockFill = 0;
+}
+
+bool LoudnessMeter::hasData() const
+{
+    return !m_blocks.empty() || m_blockFill > 0;
+}
+
+double LoudnessMeter::filter(ChannelState &state, double sample) const
+{
+    for (int s = 0; s < 2; ++s) {
+        const Biquad &b = m_stages[s];
+        double *z = state.z[s];
+        double out = b.b0 * sample + z[0];
+        z[0] = b.b1 * sample - b.a1 * out + z[1];
+        z[1] = b.b2 * sample - b.a2 * out;
+        sample = out;
+    }
+    return sample;
+}
+
+void LoudnessMeter::updatePeaks(ChannelState &state, double sample) const
+{
+    double value = std::abs(sample);
+    if (value > state.samplePeak) {
+        state.samplePeak = value;
+    }
+    if (m_oversampling == 1) {
+        state.truePeak = state.samplePeak;
+        return;
+    }
+    std::vector<double> &history = state.history;
+    std::copy_backward(history.begin(), history.end() - 1, history.end());
+    history[0] = sample;
+    const double *coeffs = m_interpolation.data();
+    for (int phase = 0; phase < m_oversampling; ++phase, coeffs += tapsPerPhase) {
+        double interpolated = 0;
+        for (int i = 0; i < tapsPerPhase; ++i) {
+            interpolated += coeffs[i] * history[(size_t)i];
+        }
+        interpolated = std::abs(interpolated);
+        if (interpolated > state.truePeak) {
+            state.truePeak = interpolated;
+        }
+    }
+}
+
+template <typename Reader> void LoudnessMeter::process(int frames, Reader read)
+{
+    int done = 0;
+    while (done < frames) {
+        // Process channel by channel up to the end of the current 100 ms block
+        int count = qMin(frames - done, m_blockSize - m_blockFill);
+        for (int c = 0; c < m_channels; ++c) {
+            ChannelState &state = m_state[(size_t)c];
+            double sum = 0;
+            for (int i = done; i < done + count; ++i) {
+                double sample = read(c, i);
+                updatePeaks(state, sample);
+                double weighted = filter(state, sample);
+                sum += weighted * weighted;
+            }
+            m_blockSum += state.weight * sum;
+        }
+        done += count;
+        m_blockFill += count;
+        if (m_blockFill == m_blockSize) {
+            m_blocks.push_back(m_blockSum / m_blockSize);
+            m_blockSum = 0;
+            m_blockFill = 0;
+        }
+    }
+}
+
+void LoudnessMeter::addInterleaved(const qint16 *samples, int frames)
+{
+    const int channels = m_channels;
+    process(frames, [samples, channels](int c, int i) { return samples[i * channels + c] / 32768.; });
+}
+
+void LoudnessMeter::addInterleaved(const float *samples, int frames)
+{
+    const int channels = m_channels;
+    process(frames, [samples, channels](int c, int i) { return (double)samples[i * channels + c]; });
+}
+
+void LoudnessMeter::addPlanar(const qint16 *const *channels, int frames)
+{
+    process(frames, [channels](int c, int i) { return channels[c][i] / 32768.; });
+}
+
+LoudnessInfo LoudnessMeter::result() const
+{
+    LoudnessInfo info;
+    double samplePeak = 0;
+    double truePeak = 0;
+    for (const ChannelState &state : m_state) {
+        samplePeak = qMax(samplePeak, state.samplePeak);
+        truePeak = qMax(truePeak, state.truePeak);
+    }
+    info.samplePeak = toDb(samplePeak);
+    info.truePeak = toDb(truePeak);
+
+    const std::vector<double> momentary = windowEnergies(m_blocks, momentaryBlocks);
+    if (momentary.empty()) {
+        // Less than 400 ms of audio, loudness cannot be measured
+        return info;
+    }
+    info.integrated = gatedLoudness(momentary, -10.);
+    info.momentaryMax = minimumLevel;
+    for (double energy : momentary) {
+        info.momentaryMax = qMax(info.momentaryMax, blockLoudness(energy));
+    }
+
+    // Clips shorter than 3 seconds get a single short-term block covering all the audio
+    std::vector<double> shortTerm = windowEnergies(m_blocks, qMin(shortTermBlocks, (int)m_blocks.size()));
+    info.shortTermMax = minimumLevel;
+    for (double energy : shortTerm) {
+        info.shortTermMax = qMax(info.shortTermMax, blockLoudness(energy));
+    }
+
+    // Loudness range, EBU Tech 3342: spread between the 10th and 95th percentiles of the gated short-term loudness
+    std::vector<double> gated;
+    gatedLoudness(shortTerm, -20., &gated);
+    if (gated.size() > 1) {
+        std::sort(gated.begin(), gated.end());
+        auto percentile = [&gated](double p) { return gated[(size_t)std::lround(p * (double)(gated.size() - 1))]; };
+        info.range = percentile(0.95) - percentile(0.10);
+    }
+    info.valid = info.integrated > minimumLevel;
+    return info;
+}
@@ -0,0 +1,111 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef LOUDNESSMETER_H
+#define LOUDNESSMETER_H
+
+#include <QString>
+#include <QtGlobal>
+#include <vector>
+
+/**
+  Result of a loudness analysis. Loudness values are in LUFS,
+  the range in LU and the peaks in dBFS / dBTP.
+  */
+struct LoudnessInfo
+{
+    bool valid = false;
+    double integrated = 0;
+    double momentaryMax = 0;
+    double shortTermMax = 0;
+    double range = 0;
+    double truePeak = 0;
+    double samplePeak = 0;
+
+    /// Writes the result to a cache file, returns false on failure.
+    bool save(const QString &path) const;
+    /// Reads a result written by save(), returns an invalid result if the file is missing or broken.
+    static LoudnessInfo load(const QString &path);
+};
+
+/**
+  Loudness meter following EBU R128 / ITU-R BS.1770-4.
+
+  Samples are pushed in any block size with one of the add*() functions,
+  then result() computes the integrated, momentary and short-term loudness,
+  the loudness range (EBU Tech 3342) and the true peak.
+
+  The meter only keeps the K-weighted energy of every 100 ms block, so that
+  memory stays small even for long clips (10 values per second).
+  */
+class LoudnessMeter
+{
+public:
+    LoudnessMeter(int channels, int frequency);
+
+    /// Adds interleaved 16 bit samples, \a frames is the number of samples per channel.
+    void addInterleaved(const qint16 *samples, int frames);
+    /// Adds interleaved float samples in the -1 / 1 range.
+    void addInterleaved(const float *samples, int frames);
+    /// Adds 16 bit samples stored in one buffer per channel.
+    void addPlanar(const qint16 *const *channels, int frames);
+
+    /// Returns true if samples were added since the meter was created or reset.
+    bool hasData() const;
+    void reset();
+
+    LoudnessInfo result() const;
+
+private:
+    struct Biquad
+    {
+        double b0, b1, b2, a1, a2;
+    };
+    struct ChannelState
+    {
+        double weight;
+        // K-weighting filter states, one pair per stage
+        double z[2][2];
+        // Last input samples for the true peak interpolation, most recent first
+        std::vector<double> history;
+        double samplePeak;
+        double truePeak;
+    };
+
+    int m_channels;
+    int m_frequency;
+    int m_blockSize;
+    int m_oversampling;
+    int m_taps;
+    Biquad m_stages[2];
+    std::vector<double> m_interpolation;
+    std::vector<ChannelState> m_state;
+    // Weighted mean square of every complete 100 ms block
+    std::vector<double> m_blocks;
+    double m_blockSum;
+    int m_blockFill;
+
+    template <typename Reader> void process(int frames, Reader read);
+    double filter(ChannelState &state, double sample) const;
+    void updatePeaks(ChannelState &state, double sample) const;
+};
+
+#endif // LOUDNESSMETER_H
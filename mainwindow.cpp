@@ -39,6 +39,7 @@
 #include "effectslist/initeffects.h"
 #include "hidetitlebars.h"
 #include "jobs/jobmanager.h"
+#include "jobs/legalityjob.hpp"
 #include "jobs/scenesplitjob.hpp"
 #include "jobs/stabilizejob.hpp"
 #include "kdenlivesettings.h"
@@ -3099,22 +3100,12 @@ void MainWindow::slotSplitAudio()
 
 void MainWindow::slotSetAudioAlignReference()
 {
-    // TODO refac
-    /*
-    if (pCore->projectManager()->currentTimeline()) {
-        pCore->projectManager()->currentTimeline()->projectView()->setAudioAlignReference();
-    }
-    */
+    getMainTimeline()->controller()->setAudioRef();
 }
 
 void MainWindow::slotAlignAudio()
 {
-    // TODO refac
-    /*
-    if (pCore->projectManager()->currentTimeline()) {
-        pCore->projectManager()->currentTimeline()->projectView()->alignAudio();
-    }
-    */
+    getMainTimeline()->controller()->alignAudio();
 }
 
 void MainWindow::slotUpdateClipType(QAction *action)
@@ -3217,6 +3208,14 @@ void MainWindow::buildDynamicActions()
                     [&]() { pCore->jobManager()->startJob<SceneSplitJob>(pCore->bin()->selectedClipsIds(), {}, i18n("Stabilize clips")); });
         }
     }
+    QAction *legalityAction = new QAction(i18n("Check broadcast legality"), m_extraFactory->actionCollection());
+    ts->addAction(legalityAction->text(), legalityAction);
+    connect(legalityAction, &QAction::triggered,
+            [&]() { pCore->jobManager()->startJob<LegalityJob>(pCore->bin()->selectedClipsIds(), -1, i18n("Check broadcast legality"), false); });
+    legalityAction = new QAction(i18n("Check broadcast legality of zone"), m_extraFactory->actionCollection());
+    ts->addAction(legalityAction->text(), legalityAction);
+    connect(legalityAction, &QAction::triggered,
+            [&]() { pCore->jobManager()->startJob<LegalityJob>(pCore->bin()->selectedClipsIds(), -1, i18n("Check broadcast legality"), true); });
     // TODO refac see if we want to reimplement speed change job. If so, maybe use better algorithm?
     /*
     if (KdenliveSettings::producerslist().contains(QStringLiteral("timewarp"))) {
@@ -1,12 +1,113 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
 #include "audiomixer.h"
+#include "mixerengine.h"
+#include "mixerstripwidget.h"
+#include "timeline2/model/timelineitemmodel.hpp"
+
+#include <QFrame>
+#include <QHBoxLayout>
+#include <QScrollArea>
+
+// Meters are refreshed at display rate, the audio thread only accumulates values
+static const int meterInterval = 40;
 
 AudioMixer::AudioMixer(QWidget *parent)
     : QWidget(parent)
+    , m_engine(new MixerEngine(this))
+    , m_master(nullptr)
 {
+    auto *lay = new QHBoxLayout(this);
+    lay->setContentsMargins(0, 0, 0, 0);
+    auto *scroll = new QScrollArea(this);
+    scroll->setWidgetResizable(true);
+    scroll->setFrameShape(QFrame::NoFrame);
+    auto *container = new QWidget(scroll);
+    m_stripLayout = new QHBoxLayout(container);
+    m_stripLayout->setContentsMargins(0, 0, 0, 0);
+    m_stripLayout->addStretch(1);
+    scroll->setWidget(container);
+    lay->addWidget(scroll, 1);
+
+    auto *separator = new QFrame(this);
+    separator->setFrameShape(QFrame::VLine);
+    lay->addWidget(separator);
+
+    m_meterTimer.setInterval(meterInterval);
+    connect(&m_meterTimer, &QTimer::timeout, this, &AudioMixer::updateMeters);
+    connect(m_engine, &MixerEngine::stripsChanged, this, &AudioMixer::rebuildStrips);
 }
 
+AudioMixer::~AudioMixer() = default;
 
-AudioMixer::~AudioMixer()
+MixerEngine *AudioMixer::engine() const
 {
+    return m_engine;
+}
 
+void AudioMixer::setModel(const std::shared_ptr<TimelineItemModel> &model)
+{
+    m_engine->setModel(model);
+}
+
+void AudioMixer::rebuildStrips()
+{
+    qDeleteAll(m_strips);
+    m_strips.clear();
+    delete m_master;
+    m_master = nullptr;
+    if (!m_engine->strip(MixerEngine::MasterId)) {
+        return;
+    }
+    QWidget *container = m_stripLayout->parentWidget();
+    const QVector<int> ids = m_engine->trackIds();
+    // Display tracks in the same order as the timeline headers: top track first
+    for (int i = ids.size() - 1; i >= 0; --i) {
+        auto *strip = new MixerStripWidget(m_engine, ids.at(i), container);
+        m_stripLayout->insertWidget(m_strips.size(), strip);
+        m_strips << strip;
+    }
+    m_master = new MixerStripWidget(m_engine, MixerEngine::MasterId, this);
+    layout()->addWidget(m_master);
+}
+
+void AudioMixer::updateMeters()
+{
+    for (MixerStripWidget *strip : m_strips) {
+        strip->updateMeter();
+    }
+    if (m_master) {
+        m_master->updateMeter();
+    }
+}
+
+void AudioMixer::showEvent(QShowEvent *event)
+{
+    m_meterTimer.start();
+    QWidget::showEvent(event);
+}
+
+void AudioMixer::hideEvent(QHideEvent *event)
+{
+    m_meterTimer.stop();
+    QWidget::hideEvent(event);
 }
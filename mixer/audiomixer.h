@@ -1,47 +1,64 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
 #ifndef AUDIOMIXER_H
 #define AUDIOMIXER_H
 
-#include"/home/mahesh/devel/src/kdenlive_git/kdenlive/src/timeline2/model/timelineitemmodel.hpp"
-#include "/home/mahesh/devel/src/kdenlive_git/kdenlive/src/timeline2/model/timelinemodel.hpp"
-#include "/home/mahesh/devel/src/kdenlive_git/kdenlive/src/timeline2/model/trackmodel.hpp"
-
-
+#include <QTimer>
 #include <QWidget>
+#include <memory>
 
-class audioMixer
-{
-
-public:
-    audioMixer(QWidget *parent = 0);
-    ~audioMixer();
-};
-
+class MixerEngine;
+class MixerStripWidget;
+class TimelineItemModel;
+class QHBoxLayout;
 
+/* @brief The project mixer dock: one strip per timeline track, plus the master strip.
+   All the audio work is done by the MixerEngine, this widget only displays its state.
+*/
 class AudioMixer : public QWidget
 {
-   public:
-   void setModel(std::shared_ptr<TimelineItemModel> model)
-   {
-       int pos;
-       int ix;
-       std::shared_ptr<TrackModel> ob1;
-
-
-        int tracksCount = model->getTracksCount();
-        int position = model->getTrackIndexFromPosition(pos);
-
-        ob1->getProperty(QStringLiteral("kdenlive:track_name"));
-    }
-
-
-
+    Q_OBJECT
 
 public:
-    AudioMixer(QWidget *parent = 0);
+    explicit AudioMixer(QWidget *parent = nullptr);
     ~AudioMixer();
+    /* @brief Attach the mixer to the timeline of the current project */
+    void setModel(const std::shared_ptr<TimelineItemModel> &model);
+    MixerEngine *engine() const;
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private slots:
+    void rebuildStrips();
+    void updateMeters();
+
+private:
+    MixerEngine *m_engine;
+    QHBoxLayout *m_stripLayout;
+    MixerStripWidget *m_master;
+    QList<MixerStripWidget *> m_strips;
+    QTimer m_meterTimer;
 };
 
-
-
-
 #endif // AUDIOMIXER_H
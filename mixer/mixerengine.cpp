@@ -0,0 +1,470 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "mixerengine.h"
+#include "core.h"
+#include "profiles/profilemodel.hpp"
+#include "timeline2/model/timelineitemmodel.hpp"
+
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <klocalizedstring.h>
+#include <limits>
+#include <mlt++/MltProfile.h>
+#include <mlt++/MltTractor.h>
+
+namespace {
+void accumulateMax(std::atomic<float> &target, float value)
+{
+    float current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+/* Measures peak / sum of squares of interleaved or planar samples.
+   scale is the full scale value of the sample type, so that all meters are in the 0 - 1 range */
+template <typename T> void measureSamples(const T *data, bool planar, int channels, int samples, float scale, float *peaks, double *sums)
+{
+    const float inv = 1.f / scale;
+    for (int c = 0; c < channels; ++c) {
+        const int meterChannel = std::min(c, MixerStrip::MaxChannels - 1);
+        const int stride = planar ? 1 : channels;
+        const T *sample = planar ? data + c * samples : data + c;
+        float peak = 0.f;
+        double sum = 0.;
+        for (int i = 0; i < samples; ++i, sample += stride) {
+            const float value = (float)*sample * inv;
+            const float level = std::fabs(value);
+            if (level > peak) {
+                peak = level;
+            }
+            sum += (double)(value * value);
+        }
+        peaks[meterChannel] = std::max(peaks[meterChannel], peak);
+        sums[meterChannel] += sum;
+    }
+}
+
+int mixer_get_audio(mlt_frame frame, void **buffer, mlt_audio_format *format, int *frequency, int *channels, int *samples)
+{
+    auto *strip = static_cast<std::shared_ptr<MixerStrip> *>(mlt_frame_pop_audio(frame));
+    int error = mlt_frame_get_audio(frame, buffer, format, frequency, channels, samples);
+    if (error == 0 && strip != nullptr && *buffer != nullptr && *samples > 0) {
+        (*strip)->measure(*buffer, *format, *channels, *samples);
+    }
+    return error;
+}
+
+void mixer_delete_strip(void *strip)
+{
+    delete static_cast<std::shared_ptr<MixerStrip> *>(strip);
+}
+
+mlt_frame mixer_process(mlt_filter filter, mlt_frame frame)
+{
+    // The frame holds its own reference on the strip, so that it stays valid if the filter is closed while the frame is queued
+    auto *strip = new std::shared_ptr<MixerStrip>(*static_cast<std::shared_ptr<MixerStrip> *>(filter->child));
+    char key[64];
+    snprintf(key, sizeof(key), "_kdenlive_mixer.%p", (void *)filter);
+    mlt_properties_set_data(MLT_FRAME_PROPERTIES(frame), key, strip, 0, mixer_delete_strip, nullptr);
+    mlt_frame_push_audio(frame, strip);
+    mlt_frame_push_audio(frame, (void *)mixer_get_audio);
+    return frame;
+}
+
+void mixer_close(mlt_filter filter)
+{
+    delete static_cast<std::shared_ptr<MixerStrip> *>(filter->child);
+    filter->child = nullptr;
+    filter->close = nullptr;
+    filter->parent.close = nullptr;
+    mlt_service_close(&filter->parent);
+}
+} // namespace
+
+MixerStrip::MixerStrip()
+    : gain(1.f)
+    , pan(0.f)
+    , mute(false)
+    , solo(false)
+    , channels(2)
+{
+    for (int i = 0; i < MaxChannels; ++i) {
+        m_peak[i].store(0.f);
+        m_rms[i].store(0.f);
+    }
+}
+
+bool MixerStrip::isSilenced() const
+{
+    return mute.load() || (soloBus && soloBus->load() > 0 && !solo.load());
+}
+
+void MixerStrip::measure(const void *buffer, mlt_audio_format format, int frameChannels, int samples)
+{
+    if (frameChannels <= 0) {
+        return;
+    }
+    float peaks[MaxChannels] = {0.f};
+    double sums[MaxChannels] = {0.};
+    switch (format) {
+    case mlt_audio_s16:
+        measureSamples(static_cast<const int16_t *>(buffer), false, frameChannels, samples, 32768.f, peaks, sums);
+        break;
+    case mlt_audio_s32le:
+        measureSamples(static_cast<const int32_t *>(buffer), false, frameChannels, samples, 2147483648.f, peaks, sums);
+        break;
+    case mlt_audio_s32:
+        measureSamples(static_cast<const int32_t *>(buffer), true, frameChannels, samples, 2147483648.f, peaks, sums);
+        break;
+    case mlt_audio_f32le:
+        measureSamples(static_cast<const float *>(buffer), false, frameChannels, samples, 1.f, peaks, sums);
+        break;
+    case mlt_audio_float:
+        measureSamples(static_cast<const float *>(buffer), true, frameChannels, samples, 1.f, peaks, sums);
+        break;
+    default:
+        // Unsupported format (u8, none)
+        return;
+    }
+    const int metered = std::min(frameChannels, (int)MaxChannels);
+    for (int c = 0; c < metered; ++c) {
+        accumulateMax(m_peak[c], peaks[c]);
+        accumulateMax(m_rms[c], (float)std::sqrt(sums[c] / samples));
+    }
+    channels.store(metered, std::memory_order_relaxed);
+}
+
+float MixerStrip::takePeak(int channel)
+{
+    if (channel < 0 || channel >= MaxChannels) {
+        return 0.f;
+    }
+    return m_peak[channel].exchange(0.f, std::memory_order_relaxed);
+}
+
+float MixerStrip::takeRms(int channel)
+{
+    if (channel < 0 || channel >= MaxChannels) {
+        return 0.f;
+    }
+    return m_rms[channel].exchange(0.f, std::memory_order_relaxed);
+}
+
+MixerEngine::MixerEngine(QObject *parent)
+    : QObject(parent)
+    , m_soloCount(std::make_shared<std::atomic<int>>(0))
+{
+}
+
+MixerEngine::~MixerEngine()
+{
+    detachAll();
+}
+
+void MixerEngine::setModel(const std::shared_ptr<TimelineItemModel> &model)
+{
+    if (auto previous = m_model.lock()) {
+        disconnect(previous.get(), nullptr, this, nullptr);
+    }
+    detachAll();
+    m_model = model;
+    if (!model) {
+        emit stripsChanged();
+        return;
+    }
+    auto tracksChanged = [this](const QModelIndex &parent) {
+        if (!parent.isValid()) {
+            rebuildStrips();
+        }
+    };
+    connect(model.get(), &QAbstractItemModel::rowsInserted, this, tracksChanged);
+    connect(model.get(), &QAbstractItemModel::rowsRemoved, this, tracksChanged);
+    connect(model.get(), &QAbstractItemModel::modelReset, this, &MixerEngine::rebuildStrips);
+    connect(model.get(), &QAbstractItemModel::dataChanged, this, [this](const QModelIndex &topLeft, const QModelIndex &, const QVector<int> &roles) {
+        if (!topLeft.parent().isValid() && (roles.isEmpty() || roles.contains(TimelineModel::NameRole))) {
+            emit stripsChanged();
+        }
+    });
+
+    m_master.strip = std::make_shared<MixerStrip>();
+    loadState(MasterId, m_master.strip);
+    attach(m_master, new Mlt::Producer(*model->tractor()));
+    rebuildStrips();
+}
+
+void MixerEngine::rebuildStrips()
+{
+    auto model = m_model.lock();
+    if (!model) {
+        return;
+    }
+    std::map<int, Binding> previous;
+    previous.swap(m_strips);
+    m_order.clear();
+    int soloed = 0;
+    Mlt::Tractor *tractor = model->tractor();
+    for (int i = 0; i < model->getTracksCount(); ++i) {
+        int tid = model->getTrackIndexFromPosition(i);
+        auto it = previous.find(tid);
+        if (it != previous.end()) {
+            m_strips[tid] = std::move(it->second);
+            previous.erase(it);
+        } else {
+            Binding binding;
+            binding.strip = std::make_shared<MixerStrip>();
+            binding.strip->soloBus = m_soloCount;
+            loadState(tid, binding.strip);
+            attach(binding, tractor->track(model->getTrackMltIndex(tid)));
+            m_strips[tid] = std::move(binding);
+        }
+        if (m_strips[tid].strip->solo.load()) {
+            soloed++;
+        }
+        m_order << tid;
+    }
+    for (auto &binding : previous) {
+        detach(binding.second);
+    }
+    if (m_soloCount->exchange(soloed) != soloed) {
+        for (const auto &binding : m_strips) {
+            applyStrip(binding.second);
+        }
+    }
+    emit stripsChanged();
+}
+
+QVector<int> MixerEngine::trackIds() const
+{
+    return m_order;
+}
+
+QString MixerEngine::stripName(int trackId) const
+{
+    if (trackId == MasterId) {
+        return i18n("Master");
+    }
+    if (auto model = m_model.lock()) {
+        if (model->isTrack(trackId)) {
+            return model->getTrackProperty(trackId, QStringLiteral("kdenlive:track_name")).toString();
+        }
+    }
+    return QString();
+}
+
+std::shared_ptr<MixerStrip> MixerEngine::strip(int trackId) const
+{
+    if (trackId == MasterId) {
+        return m_master.strip;
+    }
+    auto it = m_strips.find(trackId);
+    return it == m_strips.end() ? nullptr : it->second.strip;
+}
+
+void MixerEngine::setGain(int trackId, double db)
+{
+    if (auto s = strip(trackId)) {
+        s->gain.store((float)std::pow(10., db / 20.));
+        updateFilters(trackId);
+        storeProperty(trackId, "kdenlive:mixer_gain", QString::number(db));
+    }
+}
+
+double MixerEngine::gainDb(int trackId) const
+{
+    if (auto s = strip(trackId)) {
+        float g = s->gain.load();
+        return g > 0.f ? 20. * std::log10((double)g) : -std::numeric_limits<double>::infinity();
+    }
+    return 0.;
+}
+
+void MixerEngine::setPan(int trackId, double pan)
+{
+    if (auto s = strip(trackId)) {
+        s->pan.store((float)qBound(-1., pan, 1.));
+        updateFilters(trackId);
+        storeProperty(trackId, "kdenlive:mixer_pan", QString::number(pan));
+    }
+}
+
+void MixerEngine::setMute(int trackId, bool mute)
+{
+    if (auto s = strip(trackId)) {
+        s->mute.store(mute);
+        updateFilters(trackId);
+        storeProperty(trackId, "kdenlive:mixer_mute", mute ? QStringLiteral("1") : QStringLiteral("0"));
+    }
+}
+
+void MixerEngine::setSolo(int trackId, bool solo)
+{
+    auto s = strip(trackId);
+    if (!s || trackId == MasterId || s->solo.load() == solo) {
+        return;
+    }
+    s->solo.store(solo);
+    m_soloCount->fetch_add(solo ? 1 : -1);
+    // Soloing a strip silences all the others
+    for (const auto &binding : m_strips) {
+        updateFilters(binding.first);
+    }
+    storeProperty(trackId, "kdenlive:mixer_solo", solo ? QStringLiteral("1") : QStringLiteral("0"));
+}
+
+Mlt::Filter *MixerEngine::createMeter(const std::shared_ptr<MixerStrip> &strip)
+{
+    mlt_filter filter = mlt_filter_new();
+    if (filter == nullptr) {
+        return nullptr;
+    }
+    filter->child = new std::shared_ptr<MixerStrip>(strip);
+    filter->process = mixer_process;
+    filter->close = mixer_close;
+    mlt_properties properties = MLT_FILTER_PROPERTIES(filter);
+    // The meter only reads the samples: as a _loader filter it is not serialized, and without kdenlive_id the effect stack ignores it
+    mlt_properties_set_int(properties, "_loader", 1);
+    mlt_properties_set(properties, "mlt_service", "kdenlive_mixer");
+    auto *result = new Mlt::Filter(filter);
+    mlt_filter_close(filter);
+    return result;
+}
+
+void MixerEngine::attach(Binding &binding, Mlt::Producer *service)
+{
+    binding.service.reset(service);
+    if (!service || !service->is_valid()) {
+        qDebug() << "// Mixer cannot attach strip, invalid service";
+        return;
+    }
+    // Gain and pan are applied by regular MLT filters, that are saved with the project so that the render uses them.
+    // They have no kdenlive_id, so the effect stack ignores them.
+    Mlt::Profile &profile = pCore->getCurrentProfile()->profile();
+    binding.volume.reset(new Mlt::Filter(profile, "volume"));
+    binding.panner.reset(new Mlt::Filter(profile, "panner"));
+    for (Mlt::Filter *filter : {binding.volume.get(), binding.panner.get()}) {
+        if (filter->is_valid()) {
+            filter->set("kdenlive:mixer", 1);
+            binding.service->attach(*filter);
+        }
+    }
+    if (binding.panner->is_valid()) {
+        // Stereo balance
+        binding.panner->set("channel", -1);
+    }
+    applyStrip(binding);
+    // The meter comes last, so that it measures the mixed signal
+    binding.meter.reset(createMeter(binding.strip));
+    if (binding.meter) {
+        binding.service->attach(*binding.meter.get());
+    }
+}
+
+void MixerEngine::detach(Binding &binding)
+{
+    if (binding.service) {
+        for (Mlt::Filter *filter : {binding.volume.get(), binding.panner.get(), binding.meter.get()}) {
+            if (filter && filter->is_valid()) {
+                binding.service->detach(*filter);
+            }
+        }
+    }
+    binding.meter.reset();
+    binding.panner.reset();
+    binding.volume.reset();
+    binding.service.reset();
+}
+
+void MixerEngine::applyStrip(const Binding &binding)
+{
+    if (!binding.strip) {
+        return;
+    }
+    if (binding.volume && binding.volume->is_valid()) {
+        binding.volume->set("gain", binding.strip->isSilenced() ? 0. : (double)binding.strip->gain.load());
+    }
+    if (binding.panner && binding.panner->is_valid()) {
+        binding.panner->set("start", (binding.strip->pan.load() + 1.) / 2.);
+    }
+}
+
+void MixerEngine::updateFilters(int trackId)
+{
+    if (trackId == MasterId) {
+        applyStrip(m_master);
+        return;
+    }
+    auto it = m_strips.find(trackId);
+    if (it != m_strips.end()) {
+        applyStrip(it->second);
+    }
+}
+
+void MixerEngine::detachAll()
+{
+    for (auto &binding : m_strips) {
+        detach(binding.second);
+    }
+    m_strips.clear();
+    m_order.clear();
+    detach(m_master);
+    m_master.strip.reset();
+    m_soloCount->store(0);
+}
+
+void MixerEngine::loadState(int trackId, const std::shared_ptr<MixerStrip> &strip)
+{
+    auto model = m_model.lock();
+    if (!model) {
+        return;
+    }
+    auto property = [&](const char *name) -> QString {
+        if (trackId == MasterId) {
+            return QString::fromUtf8(model->tractor()->get(name));
+        }
+        return model->getTrackProperty(trackId, QString::fromLatin1(name)).toString();
+    };
+    QString value = property("kdenlive:mixer_gain");
+    if (!value.isEmpty()) {
+        strip->gain.store((float)std::pow(10., value.toDouble() / 20.));
+    }
+    value = property("kdenlive:mixer_pan");
+    if (!value.isEmpty()) {
+        strip->pan.store((float)qBound(-1., value.toDouble(), 1.));
+    }
+    strip->mute.store(property("kdenlive:mixer_mute").toInt() == 1);
+    strip->solo.store(trackId != MasterId && property("kdenlive:mixer_solo").toInt() == 1);
+}
+
+void MixerEngine::storeProperty(int trackId, const char *name, const QString &value)
+{
+    auto model = m_model.lock();
+    if (!model) {
+        return;
+    }
+    if (trackId == MasterId) {
+        model->tractor()->set(name, value.toUtf8().constData());
+    } else {
+        model->setTrackProperty(trackId, QString::fromLatin1(name), value);
+    }
+}
@@ -0,0 +1,144 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef MIXERENGINE_H
+#define MIXERENGINE_H
+
+#include <QObject>
+#include <QVector>
+#include <atomic>
+#include <map>
+#include <memory>
+
+#include <mlt++/MltFilter.h>
+#include <mlt++/MltProducer.h>
+
+class TimelineItemModel;
+
+/* @brief This struct holds the state of one channel strip of the mixer.
+   It is shared between the GUI thread, which writes the parameters and reads the meters,
+   and the MLT consumer thread, which writes the meters.
+   All the members are atomics so that none of the two sides ever needs to take a lock.
+*/
+struct MixerStrip
+{
+    static const int MaxChannels = 8;
+
+    MixerStrip();
+
+    std::atomic<float> gain;  // linear gain
+    std::atomic<float> pan;   // -1 (left) to 1 (right), only used for stereo
+    std::atomic<bool> mute;
+    std::atomic<bool> solo;
+    std::atomic<int> channels; // channel count of the last processed frame
+
+    /* @brief Number of soloed strips on the bus this strip belongs to, nullptr for the master strip */
+    std::shared_ptr<std::atomic<int>> soloBus;
+
+    /* @brief Returns true if the strip is muted, or if another strip of its bus is soloed */
+    bool isSilenced() const;
+
+    /* @brief Accumulates the meters from an audio buffer.
+       Called from the consumer thread only
+    */
+    void measure(const void *buffer, mlt_audio_format format, int frameChannels, int samples);
+
+    /* @brief Returns the highest peak (0 - 1 range) measured since the last call, and resets it
+       Called from the GUI thread only
+    */
+    float takePeak(int channel);
+    /* @brief Returns the highest RMS level (0 - 1 range) measured since the last call, and resets it */
+    float takeRms(int channel);
+
+private:
+    std::atomic<float> m_peak[MaxChannels];
+    std::atomic<float> m_rms[MaxChannels];
+};
+
+/* @brief This class attaches one MixerStrip to each track of a timeline, plus a master strip on the timeline tractor.
+   A strip is plugged in MLT as a volume and a panner filter, that are saved with the project so that the render applies them,
+   followed by an internal meter filter that is not saved. None of them is shown in the effect stack, and changing a parameter
+   only changes a filter property, it never requires to rebuild the tractor or refresh a producer.
+   The parameters are stored as track properties so that they survive a project reload.
+*/
+class MixerEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    /* @brief Id used to address the master strip */
+    static const int MasterId = -1;
+
+    explicit MixerEngine(QObject *parent = nullptr);
+    ~MixerEngine();
+
+    /* @brief Attach the mixer to a new timeline, detaching it from the previous one */
+    void setModel(const std::shared_ptr<TimelineItemModel> &model);
+
+    /* @brief Returns the ids of the tracks that have a strip, in timeline order (bottom to top) */
+    QVector<int> trackIds() const;
+    /* @brief Returns the display name of a strip */
+    QString stripName(int trackId) const;
+    /* @brief Returns the strip of a given track, or the master strip for MasterId. Returns nullptr if not found */
+    std::shared_ptr<MixerStrip> strip(int trackId) const;
+
+    void setGain(int trackId, double db);
+    void setPan(int trackId, double pan);
+    void setMute(int trackId, bool mute);
+    void setSolo(int trackId, bool solo);
+    double gainDb(int trackId) const;
+
+public slots:
+    /* @brief Synchronize the strips with the tracks of the timeline. Existing strips keep their state */
+    void rebuildStrips();
+
+signals:
+    /* @brief Emitted when strips are added or removed */
+    void stripsChanged();
+
+private:
+    struct Binding
+    {
+        std::shared_ptr<MixerStrip> strip;
+        std::unique_ptr<Mlt::Producer> service;
+        std::unique_ptr<Mlt::Filter> volume;
+        std::unique_ptr<Mlt::Filter> panner;
+        std::unique_ptr<Mlt::Filter> meter;
+    };
+    std::weak_ptr<TimelineItemModel> m_model;
+    std::map<int, Binding> m_strips;
+    Binding m_master;
+    QVector<int> m_order;
+    std::shared_ptr<std::atomic<int>> m_soloCount;
+
+    /* @brief Create the internal MLT filter that measures the levels of the given strip */
+    static Mlt::Filter *createMeter(const std::shared_ptr<MixerStrip> &strip);
+    void attach(Binding &binding, Mlt::Producer *service);
+    void detach(Binding &binding);
+    /* @brief Copy the strip parameters to its volume and panner filters */
+    static void applyStrip(const Binding &binding);
+    void updateFilters(int trackId);
+    void detachAll();
+    void loadState(int trackId, const std::shared_ptr<MixerStrip> &strip);
+    void storeProperty(int trackId, const char *name, const QString &value);
+};
+
+#endif
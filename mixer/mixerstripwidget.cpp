@@ -0,0 +1,193 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "mixerstripwidget.h"
+#include "mixerengine.h"
+
+#include <QDial>
+#include <QLabel>
+#include <QPainter>
+#include <QSlider>
+#include <QToolButton>
+#include <QVBoxLayout>
+#include <cmath>
+#include <klocalizedstring.h>
+#include <limits>
+
+// Lowest level displayed on meters, in dB
+static const double meterFloor = -60.;
+// Fader range, in tenth of dB
+static const int faderMin = -600;
+static const int faderMax = 120;
+
+static double toDb(float level)
+{
+    return level > 0.f ? qMax(meterFloor, 20. * std::log10((double)level)) : meterFloor;
+}
+
+MixerMeter::MixerMeter(QWidget *parent)
+    : QWidget(parent)
+{
+    setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Expanding);
+}
+
+QSize MixerMeter::sizeHint() const
+{
+    return QSize(qMax(2, m_peaks.size()) * 6, 120);
+}
+
+void MixerMeter::setLevels(const QVector<double> &peaks, const QVector<double> &rms)
+{
+    if (m_holds.size() != peaks.size()) {
+        m_holds = peaks;
+        updateGeometry();
+    }
+    for (int i = 0; i < peaks.size(); i++) {
+        // Slowly release the peak hold marker
+        m_holds[i] = qMax(peaks.at(i), m_holds.at(i) - 0.5);
+    }
+    m_peaks = peaks;
+    m_rms = rms;
+    update();
+}
+
+void MixerMeter::paintEvent(QPaintEvent *)
+{
+    QPainter p(this);
+    p.fillRect(rect(), palette().dark());
+    int channels = m_peaks.size();
+    if (channels == 0) {
+        return;
+    }
+    int barWidth = (width() - (channels - 1)) / channels;
+    int h = height();
+    auto levelToY = [h](double db) { return (int)(h * (db / meterFloor)); };
+    QLinearGradient gradient(0, h, 0, 0);
+    gradient.setColorAt(0.0, Qt::darkGreen);
+    gradient.setColorAt(1. - (-18. / meterFloor), Qt::green);
+    gradient.setColorAt(1. - (-6. / meterFloor), Qt::yellow);
+    gradient.setColorAt(1.0, Qt::red);
+    for (int i = 0; i < channels; i++) {
+        int x = i * (barWidth + 1);
+        int peakY = levelToY(m_peaks.at(i));
+        p.setOpacity(0.5);
+        p.fillRect(x, peakY, barWidth, h - peakY, QBrush(gradient));
+        p.setOpacity(1);
+        int rmsY = levelToY(m_rms.at(i));
+        p.fillRect(x, rmsY, barWidth, h - rmsY, QBrush(gradient));
+        int holdY = levelToY(m_holds.at(i));
+        p.fillRect(x, holdY, barWidth, 1, palette().text());
+    }
+}
+
+MixerStripWidget::MixerStripWidget(MixerEngine *engine, int trackId, QWidget *parent)
+    : QWidget(parent)
+    , m_engine(engine)
+    , m_trackId(trackId)
+    , m_strip(engine->strip(trackId))
+{
+    auto *lay = new QVBoxLayout(this);
+    lay->setContentsMargins(2, 2, 2, 2);
+    m_name = new QLabel(this);
+    m_name->setAlignment(Qt::AlignCenter);
+    lay->addWidget(m_name);
+
+    m_pan = new QDial(this);
+    m_pan->setRange(-100, 100);
+    m_pan->setNotchesVisible(true);
+    m_pan->setFixedSize(32, 32);
+    m_pan->setToolTip(i18n("Pan"));
+    lay->addWidget(m_pan, 0, Qt::AlignHCenter);
+
+    auto *faderLay = new QHBoxLayout;
+    m_meter = new MixerMeter(this);
+    m_fader = new QSlider(Qt::Vertical, this);
+    m_fader->setRange(faderMin, faderMax);
+    m_fader->setPageStep(10);
+    m_fader->setTickPosition(QSlider::TicksBothSides);
+    m_fader->setTickInterval(60);
+    faderLay->addWidget(m_meter);
+    faderLay->addWidget(m_fader);
+    lay->addLayout(faderLay, 1);
+
+    m_gainLabel = new QLabel(this);
+    m_gainLabel->setAlignment(Qt::AlignCenter);
+    lay->addWidget(m_gainLabel);
+
+    auto *buttonLay = new QHBoxLayout;
+    m_mute = new QToolButton(this);
+    m_mute->setText(i18nc("Mute track, keep short", "M"));
+    m_mute->setToolTip(i18n("Mute"));
+    m_mute->setCheckable(true);
+    buttonLay->addWidget(m_mute);
+    m_solo = new QToolButton(this);
+    m_solo->setText(i18nc("Solo track, keep short", "S"));
+    m_solo->setToolTip(i18n("Solo"));
+    m_solo->setCheckable(true);
+    m_solo->setVisible(trackId != MixerEngine::MasterId);
+    buttonLay->addWidget(m_solo);
+    lay->addLayout(buttonLay);
+
+    if (m_strip) {
+        double db = engine->gainDb(trackId);
+        m_fader->setValue(std::isinf(db) ? faderMin : qBound(faderMin, (int)std::lround(db * 10), faderMax));
+        m_pan->setValue((int)std::lround(m_strip->pan.load() * 100));
+        m_mute->setChecked(m_strip->mute.load());
+        m_solo->setChecked(m_strip->solo.load());
+    }
+    m_gainLabel->setText(i18n("%1 dB", QString::number(m_fader->value() / 10., 'f', 1)));
+    setName(engine->stripName(trackId));
+
+    connect(m_fader, &QSlider::valueChanged, this, [this](int value) {
+        m_gainLabel->setText(i18n("%1 dB", QString::number(value / 10., 'f', 1)));
+        // The lowest fader position means silence
+        m_engine->setGain(m_trackId, value <= faderMin ? -std::numeric_limits<double>::infinity() : value / 10.);
+    });
+    connect(m_pan, &QDial::valueChanged, this, [this](int value) { m_engine->setPan(m_trackId, value / 100.); });
+    connect(m_mute, &QToolButton::toggled, this, [this](bool checked) { m_engine->setMute(m_trackId, checked); });
+    connect(m_solo, &QToolButton::toggled, this, [this](bool checked) { m_engine->setSolo(m_trackId, checked); });
+}
+
+int MixerStripWidget::trackId() const
+{
+    return m_trackId;
+}
+
+void MixerStripWidget::setName(const QString &name)
+{
+    m_name->setText(name);
+    m_name->setToolTip(name);
+}
+
+void MixerStripWidget::updateMeter()
+{
+    if (!m_strip) {
+        return;
+    }
+    int channels = m_strip->channels.load();
+    QVector<double> peaks(channels);
+    QVector<double> rms(channels);
+    for (int i = 0; i < channels; i++) {
+        peaks[i] = toDb(m_strip->takePeak(i));
+        rms[i] = toDb(m_strip->takeRms(i));
+    }
+    m_meter->setLevels(peaks, rms);
+}
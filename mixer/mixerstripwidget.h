@@ -0,0 +1,81 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef MIXERSTRIPWIDGET_H
+#define MIXERSTRIPWIDGET_H
+
+#include <QVector>
+#include <QWidget>
+#include <memory>
+
+class MixerEngine;
+struct MixerStrip;
+class QLabel;
+class QSlider;
+class QDial;
+class QToolButton;
+
+/* @brief Vertical peak / RMS meter, one bar per channel */
+class MixerMeter : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit MixerMeter(QWidget *parent = nullptr);
+    /* @brief Set the current levels, in dB */
+    void setLevels(const QVector<double> &peaks, const QVector<double> &rms);
+    QSize sizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    QVector<double> m_peaks;
+    QVector<double> m_rms;
+    QVector<double> m_holds;
+};
+
+/* @brief The GUI of one mixer strip: name, meter, gain fader, pan, mute and solo */
+class MixerStripWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    MixerStripWidget(MixerEngine *engine, int trackId, QWidget *parent = nullptr);
+    int trackId() const;
+    /* @brief Read the meters of the strip. Called at display rate */
+    void updateMeter();
+    void setName(const QString &name);
+
+private:
+    MixerEngine *m_engine;
+    int m_trackId;
+    std::shared_ptr<MixerStrip> m_strip;
+    QLabel *m_name;
+    QLabel *m_gainLabel;
+    MixerMeter *m_meter;
+    QSlider *m_fader;
+    QDial *m_pan;
+    QToolButton *m_mute;
+    QToolButton *m_solo;
+};
+
+#endif
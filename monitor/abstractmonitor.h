@@ -21,6 +21,8 @@
 #define ABSTRACTMONITOR_H
 
 #include "definitions.h"
+#include "scopes/audioblock.h"
+#include "scopes/scopeframe.h"
 
 #include <stdint.h>
 
@@ -68,7 +70,7 @@ signals:
     void frameUpdated(const QImage &);
 
     /** @brief This signal contains the audio of the current frame. */
-    void audioSamplesSignal(const audioShortVector &, int, int, int);
+    void audioSamplesSignal(const AudioBlock &);
     /** @brief Scopes are ready to receive a new frame. */
     void scopesClear();
 };
@@ -99,8 +101,10 @@ protected:
 signals:
     /** @brief Send a frame for analysis or title background display. */
     void frameUpdated(const QImage &);
+    /** @brief Send the YUV planes of the displayed frame to the color scopes. */
+    void scopeFrameUpdated(const ScopeFrame &);
     /** @brief This signal contains the audio of the current frame. */
-    void audioSamplesSignal(const audioShortVector &, int, int, int);
+    void audioSamplesSignal(const AudioBlock &);
     /** @brief Scopes are ready to receive a new frame. */
     void scopesClear();
 };
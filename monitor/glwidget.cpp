@@ -31,6 +31,7 @@
 #include "core.h"
 #include "glwidget.h"
 #include "kdenlivesettings.h"
+#include "lib/audio/audioPeaks.h"
 #include "mltcontroller/bincontroller.h"
 #include "profiles/profilemodel.hpp"
 #include "qml/qmlaudiothumb.h"
@@ -82,6 +83,7 @@ GLWidget::GLWidget(int id, QObject *parent)
     , m_shader(nullptr)
     , m_initSem(0)
     , m_analyseSem(1)
+    , m_scopesAnalysis(false)
     , m_isInitialized(false)
     , m_threadStartEvent(nullptr)
     , m_threadStopEvent(nullptr)
@@ -173,6 +175,17 @@ void GLWidget::updateAudioForAnalysis()
     }
 }
 
+void GLWidget::setScopesAnalysis(bool analyse)
+{
+    m_scopesAnalysis = analyse;
+    if (m_glslManager) {
+        // GPU frames only exist as textures, the scopes get a readback of the rendered image
+        sendFrameForAnalysis = analyse;
+    } else if (m_frameRenderer) {
+        m_frameRenderer->sendFrameForScopes = analyse;
+    }
+}
+
 void GLWidget::initializeGL()
 {
     if (m_isInitialized || !isVisible() || (openglContext() == nullptr)) return;
@@ -229,12 +242,14 @@ void GLWidget::initializeGL()
     }
     m_frameRenderer = new FrameRenderer(openglContext(), &m_offscreenSurface);
     m_frameRenderer->sendAudioForAnalysis = KdenliveSettings::monitor_audio();
+    m_frameRenderer->sendFrameForScopes = m_scopesAnalysis && m_glslManager == nullptr;
     openglContext()->makeCurrent(this);
     // openglContext()->blockSignals(false);
     connect(m_frameRenderer, &FrameRenderer::frameDisplayed, this, &GLWidget::frameDisplayed, Qt::QueuedConnection);
     connect(m_frameRenderer, &FrameRenderer::textureReady, this, &GLWidget::updateTexture, Qt::DirectConnection);
     connect(m_frameRenderer, &FrameRenderer::frameDisplayed, this, &GLWidget::onFrameDisplayed, Qt::QueuedConnection);
 
+    connect(m_frameRenderer, &FrameRenderer::scopeFrameUpdated, this, &GLWidget::scopeFrameUpdated, Qt::QueuedConnection);
     connect(m_frameRenderer, &FrameRenderer::audioSamplesSignal, this, &GLWidget::audioSamplesSignal, Qt::QueuedConnection);
     connect(this, &GLWidget::textureUpdated, this, &GLWidget::update, Qt::QueuedConnection);
     m_initSem.release();
@@ -409,6 +424,9 @@ void GLWidget::clear()
 void GLWidget::releaseAnalyse()
 {
     m_analyseSem.release();
+    if (m_frameRenderer) {
+        m_frameRenderer->releaseScopes();
+    }
 }
 
 void GLWidget::paintGL()
@@ -1480,10 +1498,12 @@ void RenderThread::run()
 FrameRenderer::FrameRenderer(QOpenGLContext *shareContext, QSurface *surface)
     : QThread(nullptr)
     , m_semaphore(3)
+    , m_scopesReady(true)
     , m_context(nullptr)
     , m_surface(surface)
     , m_gl32(nullptr)
     , sendAudioForAnalysis(false)
+    , sendFrameForScopes(false)
 {
     Q_ASSERT(shareContext);
     m_renderTexture[0] = m_renderTexture[1] = m_renderTexture[2] = 0;
@@ -1533,6 +1553,8 @@ void FrameRenderer::showFrame(Mlt::Frame frame)
     // The frame is now done being modified and can be shared with the rest
     // of the application.
     emit frameDisplayed(m_displayFrame);
+    sendAudio();
+    sendScopeFrame();
     m_semaphore.release();
 }
 
@@ -1577,6 +1599,7 @@ void FrameRenderer::showGLFrame(Mlt::Frame frame)
     // The frame is now done being modified and can be shared with the rest
     // of the application.
     emit frameDisplayed(m_displayFrame);
+    sendAudio();
     m_semaphore.release();
 }
 
@@ -1600,9 +1623,41 @@ void FrameRenderer::showGLNoSyncFrame(Mlt::Frame frame)
     // The frame is now done being modified and can be shared with the rest
     // of the application.
     emit frameDisplayed(m_displayFrame);
+    sendAudio();
     m_semaphore.release();
 }
 
+void FrameRenderer::sendAudio()
+{
+    if (!sendAudioForAnalysis) {
+        return;
+    }
+    // The block references the audio of the displayed frame, nothing is copied for the scopes
+    AudioBlock block(m_displayFrame);
+    if (block.isValid()) {
+        emit audioSamplesSignal(block);
+    }
+}
+
+void FrameRenderer::sendScopeFrame()
+{
+    if (!sendFrameForScopes || !m_scopesReady.exchange(false)) {
+        return;
+    }
+    // The scopes read the planes of the displayed frame, there is no readback nor RGB conversion
+    ScopeFrame scopeFrame(m_displayFrame);
+    if (scopeFrame.isValid()) {
+        emit scopeFrameUpdated(scopeFrame);
+    } else {
+        m_scopesReady = true;
+    }
+}
+
+void FrameRenderer::releaseScopes()
+{
+    m_scopesReady = true;
+}
+
 void FrameRenderer::cleanup()
 {
     if ((m_renderTexture[0] != 0u) && (m_renderTexture[1] != 0u) && (m_renderTexture[2] != 0u)) {
@@ -1617,40 +1672,40 @@ void FrameRenderer::cleanup()
     }
 }
 
-void GLWidget::setAudioThumb(int channels, const QVariantList &audioCache)
+void GLWidget::setAudioThumb(const std::shared_ptr<const AudioPeaks> &peaks)
 {
     if (rootObject()) {
         QmlAudioThumb *audioThumbDisplay = rootObject()->findChild<QmlAudioThumb *>(QStringLiteral("audiothumb"));
         if (audioThumbDisplay) {
             QImage img(width(), height() / 6, QImage::Format_ARGB32_Premultiplied);
             img.fill(Qt::transparent);
-            if (!audioCache.isEmpty() && channels > 0) {
-                int audioLevelCount = audioCache.count() - 1;
+            if (peaks && peaks->count() > 0) {
+                int channels = peaks->channels();
+                int audioLevelCount = peaks->count() - 1;
+                auto levelAt = [&peaks, channels, audioLevelCount](int index) {
+                    index = qMin(index, audioLevelCount);
+                    double value = peaks->level(0, index);
+                    for (int channel = 1; channel < channels; channel++) {
+                        value = qMax(value, peaks->level(channel, index));
+                    }
+                    return value;
+                };
                 // simplified audio
                 QPainter painter(&img);
                 QRectF mappedRect(0, 0, img.width(), img.height());
                 int channelHeight = mappedRect.height();
-                double value;
-                double scale = (double)width() / (audioLevelCount / channels);
+                double scale = (double)width() / audioLevelCount;
                 if (scale < 1) {
                     painter.setPen(QColor(80, 80, 150, 200));
                     for (int i = 0; i < img.width(); i++) {
-                        int framePos = i / scale;
-                        value = audioCache.at(qMin(framePos * channels, audioLevelCount)).toDouble() / 256;
-                        for (int channel = 1; channel < channels; channel++) {
-                            value = qMax(value, audioCache.at(qMin(framePos * channels + channel, audioLevelCount)).toDouble() / 256);
-                        }
+                        double value = levelAt(i / scale);
                         painter.drawLine(i, mappedRect.bottom() - (value * channelHeight), i, mappedRect.bottom());
                     }
                 } else {
                     QPainterPath positiveChannelPath;
                     positiveChannelPath.moveTo(0, mappedRect.bottom());
-                    for (int i = 0; i < audioLevelCount / channels; i++) {
-                        value = audioCache.at(qMin(i * channels, audioLevelCount)).toDouble() / 256;
-                        for (int channel = 1; channel < channels; channel++) {
-                            value = qMax(value, audioCache.at(qMin(i * channels + channel, audioLevelCount)).toDouble() / 256);
-                        }
-                        positiveChannelPath.lineTo(i * scale, mappedRect.bottom() - (value * channelHeight));
+                    for (int i = 0; i < audioLevelCount; i++) {
+                        positiveChannelPath.lineTo(i * scale, mappedRect.bottom() - (levelAt(i) * channelHeight));
                     }
                     positiveChannelPath.lineTo(mappedRect.right(), mappedRect.bottom());
                     painter.setPen(Qt::NoPen);
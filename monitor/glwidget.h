@@ -33,9 +33,12 @@
 #include <QSemaphore>
 #include <QThread>
 #include <QTimer>
+#include <atomic>
 
 #include "bin/model/markerlistmodel.hpp"
 #include "definitions.h"
+#include "scopes/audioblock.h"
+#include "scopes/scopeframe.h"
 #include "scopes/sharedframe.h"
 
 class QOpenGLFunctions_3_2_Core;
@@ -47,6 +50,7 @@ class Consumer;
 class Profile;
 }
 
+class AudioPeaks;
 class RenderThread;
 class FrameRenderer;
 class MonitorProxy;
@@ -96,13 +100,15 @@ public:
     QRect displayRect() const;
     /** @brief set to true if we want to emit a QImage of the frame for analysis */
     bool sendFrameForAnalysis;
+    /** @brief Enables the frames for the color scopes, read from the YUV planes in software mode or from the rendered image with GPU rendering */
+    void setScopesAnalysis(bool analyse);
     void updateGamma();
     Mlt::Profile *profile();
     void reloadProfile();
     void lockMonitor();
     void releaseMonitor();
     int realTime() const;
-    void setAudioThumb(int channels = 0, const QVariantList &audioCache = QList<QVariant>());
+    void setAudioThumb(const std::shared_ptr<const AudioPeaks> &peaks = nullptr);
     int droppedFrames() const;
     void resetDrops();
     bool checkFrameNumber(int pos);
@@ -164,7 +170,8 @@ signals:
     void mouseSeek(int eventDelta, uint modifiers);
     void startDrag();
     void analyseFrame(const QImage &);
-    void audioSamplesSignal(const audioShortVector &, int, int, int);
+    void scopeFrameUpdated(const ScopeFrame &);
+    void audioSamplesSignal(const AudioBlock &);
     void showContextMenu(const QPoint &);
     void lockMonitor(bool);
     void passKeyEvent(QKeyEvent *);
@@ -189,6 +196,7 @@ private:
     QPoint m_dragStart;
     QSemaphore m_initSem;
     QSemaphore m_analyseSem;
+    bool m_scopesAnalysis;
     bool m_isInitialized;
     Mlt::Event *m_threadStartEvent;
     Mlt::Event *m_threadStopEvent;
@@ -275,11 +283,18 @@ public slots:
 signals:
     void textureReady(GLuint yName, GLuint uName = 0, GLuint vName = 0);
     void frameDisplayed(const SharedFrame &frame);
-    void audioSamplesSignal(const audioShortVector &, int, int, int);
+    void scopeFrameUpdated(const ScopeFrame &);
+    void audioSamplesSignal(const AudioBlock &);
 
 private:
     QSemaphore m_semaphore;
     SharedFrame m_displayFrame;
+    /** @brief Set when the color scopes are done with the previous frame */
+    std::atomic<bool> m_scopesReady;
+    /** @brief Sends the audio of the displayed frame to the audio scopes if they requested it. */
+    void sendAudio();
+    /** @brief Sends the YUV planes of the displayed frame to the color scopes if they are ready for a new one. */
+    void sendScopeFrame();
     QOpenGLContext *m_context;
     QSurface *m_surface;
 
@@ -288,6 +303,9 @@ public:
     GLuint m_displayTexture[3];
     QOpenGLFunctions_3_2_Core *m_gl32;
     bool sendAudioForAnalysis;
+    bool sendFrameForScopes;
+    /** @brief Called when the color scopes finished processing the last frame */
+    void releaseScopes();
 };
 
 class MonitorProxy : public QObject
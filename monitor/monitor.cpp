@@ -292,6 +292,7 @@ Monitor::Monitor(Kdenlive::MonitorId id, MonitorManager *manager, QWidget *paren
 
     connect(this, &Monitor::scopesClear, m_glMonitor, &GLWidget::releaseAnalyse, Qt::DirectConnection);
     connect(m_glMonitor, &GLWidget::analyseFrame, this, &Monitor::frameUpdated);
+    connect(m_glMonitor, &GLWidget::scopeFrameUpdated, this, &Monitor::scopeFrameUpdated);
     connect(m_glMonitor, &GLWidget::audioSamplesSignal, this, &Monitor::audioSamplesSignal);
 
     if (id != Kdenlive::ClipMonitor) {
@@ -1641,7 +1642,7 @@ void Monitor::slotSetVolume(int volume)
 
 void Monitor::sendFrameForAnalysis(bool analyse)
 {
-    m_glMonitor->sendFrameForAnalysis = analyse;
+    m_glMonitor->setScopesAnalysis(analyse);
 }
 
 void Monitor::updateAudioForAnalysis()
@@ -2042,9 +2043,9 @@ void Monitor::slotEditInlineMarker()
     }
 }
 
-void Monitor::prepareAudioThumb(int channels, QVariantList &audioCache)
+void Monitor::prepareAudioThumb(const std::shared_ptr<const AudioPeaks> &peaks)
 {
-    m_glMonitor->setAudioThumb(channels, audioCache);
+    m_glMonitor->setAudioThumb(peaks);
 }
 
 void Monitor::slotUpdateQmlTimecode(const QString &tc)
@@ -36,6 +36,7 @@
 #include <memory>
 #include <unordered_set>
 
+class AudioPeaks;
 class SnapModel;
 class ProjectClip;
 class MonitorManager;
@@ -143,7 +144,7 @@ public:
     QAction *recAction();
     void refreshIcons();
     /** @brief Send audio thumb data to qml for on monitor display */
-    void prepareAudioThumb(int channels, QVariantList &audioCache);
+    void prepareAudioThumb(const std::shared_ptr<const AudioPeaks> &peaks);
     void connectAudioSpectrum(bool activate);
     /** @brief Set a property on the Qml scene **/
     void setQmlProperty(const QString &name, const QVariant &value);
@@ -0,0 +1,194 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "audioblock.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <vector>
+
+namespace {
+// Conversion buffers kept for reuse, a few frames are in flight at most
+const size_t maxPooledBuffers = 8;
+QMutex poolMutex;
+std::vector<std::vector<qint16>> bufferPool;
+
+std::vector<qint16> takeBuffer(size_t size)
+{
+    std::vector<qint16> buffer;
+    {
+        QMutexLocker lock(&poolMutex);
+        if (!bufferPool.empty()) {
+            buffer = std::move(bufferPool.back());
+            bufferPool.pop_back();
+        }
+    }
+    buffer.resize(size);
+    return buffer;
+}
+
+void releaseBuffer(std::vector<qint16> &&buffer)
+{
+    QMutexLocker lock(&poolMutex);
+    if (bufferPool.size() < maxPooledBuffers) {
+        bufferPool.push_back(std::move(buffer));
+    }
+}
+
+qint16 toShort(float value)
+{
+    return (qint16)qBound(-32768.f, value * 32768.f, 32767.f);
+}
+
+// Converts the frame audio to interleaved 16 bit, returns false for unsupported formats
+bool convert(mlt_audio_format format, const void *audio, int channels, int samples, qint16 *out)
+{
+    const int count = channels * samples;
+    switch (format) {
+    case mlt_audio_s32le: {
+        const auto *in = static_cast<const qint32 *>(audio);
+        for (int i = 0; i < count; ++i) {
+            out[i] = (qint16)(in[i] >> 16);
+        }
+        return true;
+    }
+    case mlt_audio_s32: {
+        // Planar
+        const auto *in = static_cast<const qint32 *>(audio);
+        for (int c = 0; c < channels; ++c) {
+            for (int s = 0; s < samples; ++s) {
+                out[s * channels + c] = (qint16)(in[c * samples + s] >> 16);
+            }
+        }
+        return true;
+    }
+    case mlt_audio_f32le: {
+        const auto *in = static_cast<const float *>(audio);
+        for (int i = 0; i < count; ++i) {
+            out[i] = toShort(in[i]);
+        }
+        return true;
+    }
+    case mlt_audio_float: {
+        // Planar
+        const auto *in = static_cast<const float *>(audio);
+        for (int c = 0; c < channels; ++c) {
+            for (int s = 0; s < samples; ++s) {
+                out[s * channels + c] = toShort(in[c * samples + s]);
+            }
+        }
+        return true;
+    }
+    case mlt_audio_u8: {
+        const auto *in = static_cast<const quint8 *>(audio);
+        for (int i = 0; i < count; ++i) {
+            out[i] = (qint16)((in[i] - 128) * 256);
+        }
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+} // namespace
+
+struct AudioBlock::Data
+{
+    // Keeps the frame audio alive when samples points into it
+    SharedFrame frame;
+    // Holds the samples when the frame audio had to be converted
+    std::vector<qint16> buffer;
+    const qint16 *samples = nullptr;
+    int frequency = 0;
+    int channels = 0;
+    int count = 0;
+
+    ~Data()
+    {
+        if (!buffer.empty()) {
+            releaseBuffer(std::move(buffer));
+        }
+    }
+};
+
+AudioBlock::AudioBlock() = default;
+
+AudioBlock::AudioBlock(const SharedFrame &frame)
+{
+    if (!frame.is_valid()) {
+        return;
+    }
+    mlt_audio_format format = frame.get_audio_format();
+    int channels = frame.get_audio_channels();
+    int samples = frame.get_audio_samples();
+    if (format == mlt_audio_none || channels <= 0 || samples <= 0) {
+        return;
+    }
+    const void *audio = frame.get_audio();
+    if (audio == nullptr) {
+        return;
+    }
+    auto data = std::make_shared<Data>();
+    data->frequency = frame.get_audio_frequency();
+    data->channels = channels;
+    data->count = samples;
+    if (format == mlt_audio_s16) {
+        data->frame = frame;
+        data->samples = static_cast<const qint16 *>(audio);
+    } else {
+        data->buffer = takeBuffer((size_t)(channels * samples));
+        if (!convert(format, audio, channels, samples, data->buffer.data())) {
+            return;
+        }
+        data->samples = data->buffer.data();
+    }
+    d = std::move(data);
+}
+
+bool AudioBlock::isValid() const
+{
+    return d != nullptr;
+}
+
+int AudioBlock::frequency() const
+{
+    return d ? d->frequency : 0;
+}
+
+int AudioBlock::channels() const
+{
+    return d ? d->channels : 0;
+}
+
+int AudioBlock::samples() const
+{
+    return d ? d->count : 0;
+}
+
+int AudioBlock::size() const
+{
+    return d ? d->count * d->channels : 0;
+}
+
+const qint16 *AudioBlock::data() const
+{
+    return d ? d->samples : nullptr;
+}
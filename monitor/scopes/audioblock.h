@@ -0,0 +1,72 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef AUDIOBLOCK_H
+#define AUDIOBLOCK_H
+
+#include "sharedframe.h"
+
+#include <QMetaType>
+#include <memory>
+
+/*!
+  \class AudioBlock
+  \brief The AudioBlock gives read-only access to the audio of a frame as
+  interleaved 16 bit samples.
+
+  \threadsafe
+
+  AudioBlock is a reference counted, immutable view on the audio of a
+  SharedFrame, with the frequency and channel count of the frame. When the
+  frame audio already is interleaved 16 bit, which is what the consumers
+  request, the block points into the frame and no sample is copied: every
+  scope receiving a copy of the block reads the same memory.
+
+  Other formats are converted once, into a buffer taken from a small pool
+  that gets it back when the last copy of the block is destroyed, so that
+  playback does not allocate once the pool is warm.
+*/
+
+class AudioBlock
+{
+public:
+    AudioBlock();
+    explicit AudioBlock(const SharedFrame &frame);
+
+    bool isValid() const;
+    int frequency() const;
+    int channels() const;
+    //! Number of samples per channel.
+    int samples() const;
+    //! Number of values, i.e. samples() * channels().
+    int size() const;
+    //! Interleaved samples: [ c0s0 c1s0 c0s1 c1s1 ... ] for 2 channels.
+    const qint16 *data() const;
+    qint16 operator[](int index) const { return data()[index]; }
+
+private:
+    struct Data;
+    std::shared_ptr<const Data> d;
+};
+
+Q_DECLARE_METATYPE(AudioBlock)
+
+#endif // AUDIOBLOCK_H
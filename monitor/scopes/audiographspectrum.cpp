@@ -30,12 +30,12 @@
 #include <QPainter>
 #include <QVBoxLayout>
 
-#include <KMessageWidget>
 #include <klocalizedstring.h>
 
 #include <math.h>
 
-#include <mlt++/Mlt.h>
+#include <algorithm>
+#include <limits>
 
 // Code borrowed from Shotcut's audiospectum by Brian Matherly <code@brianmatherly.com> (GPL)
 
@@ -274,6 +274,9 @@ void AudioGraphWidget::paintEvent(QPaintEvent *pe)
 AudioGraphSpectrum::AudioGraphSpectrum(MonitorManager *manager, QWidget *parent)
     : ScopeWidget(parent)
     , m_manager(manager)
+    , m_channels(0)
+    , m_frequency(0)
+    , m_filled(0)
 {
     auto *lay = new QVBoxLayout(this);
     m_graphWidget = new AudioGraphWidget(this);
@@ -284,20 +287,6 @@ AudioGraphSpectrum::AudioGraphSpectrum(MonitorManager *manager, QWidget *parent)
     lay->setStretchFactor(m_graphWidget, 5);
     lay->setStretchFactor(m_equalizer, 3);*/
 
-    m_filter = new Mlt::Filter(*(m_manager->projectMonitor()->profile()), "fft");
-    if (!m_filter->is_valid()) {
-        KdenliveSettings::setEnableaudiospectrum(false);
-        auto *mw = new KMessageWidget(this);
-        mw->setCloseButtonVisible(false);
-        mw->setWordWrap(true);
-        mw->setMessageType(KMessageWidget::Information);
-        mw->setText(i18n("MLT must be compiled with libfftw3 to enable Audio Spectrum"));
-        layout()->addWidget(mw);
-        mw->show();
-        setEnabled(false);
-        return;
-    }
-    m_filter->set("window_size", WINDOW_SIZE);
     QAction *a = new QAction(i18n("Enable Audio Spectrum"), this);
     a->setCheckable(true);
     a->setChecked(KdenliveSettings::enableaudiospectrum());
@@ -312,7 +301,6 @@ AudioGraphSpectrum::AudioGraphSpectrum(MonitorManager *manager, QWidget *parent)
 AudioGraphSpectrum::~AudioGraphSpectrum()
 {
     delete m_graphWidget;
-    delete m_filter;
 }
 
 void AudioGraphSpectrum::activate(bool enable)
@@ -335,31 +323,55 @@ void AudioGraphSpectrum::refreshPixmap()
 void AudioGraphSpectrum::refreshScope(const QSize & /*size*/, bool /*full*/)
 {
     SharedFrame sFrame;
-    while (m_queue.count() > 0) {
-        sFrame = m_queue.pop();
-        if (sFrame.is_valid() && sFrame.get_audio_samples() > 0) {
-            mlt_audio_format format = mlt_audio_s16;
-            int channels = sFrame.get_audio_channels();
-            int frequency = sFrame.get_audio_frequency();
-            int samples = sFrame.get_audio_samples();
-            Mlt::Frame mFrame = sFrame.clone(true, false, false);
-            m_filter->process(mFrame);
-            mFrame.get_audio(format, frequency, channels, samples);
-            if (samples == 0 || format == 0) {
-                // There was an error processing audio from frame
-                continue;
-            }
-            processSpectrum();
+    bool newData = false;
+    while (m_queue.tryPop(sFrame)) {
+        // The block reads the frame audio in place, no clone of the frame is needed
+        AudioBlock block(sFrame);
+        if (block.isValid()) {
+            appendAudio(block);
+            newData = true;
         }
     }
+    if (newData && m_filled > 0) {
+        processSpectrum();
+    }
+}
+
+void AudioGraphSpectrum::appendAudio(const AudioBlock &block)
+{
+    if (block.channels() != m_channels || block.frequency() != m_frequency) {
+        m_channels = block.channels();
+        m_frequency = block.frequency();
+        m_history.assign((size_t)m_channels * WINDOW_SIZE, 0.f);
+        m_filled = 0;
+    }
+    // Keep the last WINDOW_SIZE samples of each channel, oldest first
+    const int count = qMin(block.samples(), WINDOW_SIZE);
+    const int skip = block.samples() - count;
+    std::vector<float *> planes((size_t)m_channels);
+    for (int c = 0; c < m_channels; ++c) {
+        float *plane = m_history.data() + (size_t)c * WINDOW_SIZE;
+        std::move(plane + count, plane + WINDOW_SIZE, plane);
+        planes[(size_t)c] = plane + WINDOW_SIZE - count;
+    }
+    FFTTools::deinterleave(block.data() + (size_t)skip * m_channels, (uint)count, (uint)m_channels, planes.data());
+    m_filled = qMin(WINDOW_SIZE, m_filled + count);
 }
 
 void AudioGraphSpectrum::processSpectrum()
 {
-    QVector<double> bands(AUDIBLE_BAND_COUNT);
-    float *bins = (float *)m_filter->get_data("bins");
-    int bin_count = m_filter->get_int("bin_count");
-    double bin_width = m_filter->get_double("bin_width");
+    // Bands without any bin stay silent
+    QVector<double> bands(AUDIBLE_BAND_COUNT, -std::numeric_limits<double>::infinity());
+    // Spectrum of each channel, the bands show the loudest one
+    m_spectra.resize(m_channels);
+    for (int c = 0; c < m_channels; ++c) {
+        m_spectra[c].resize(WINDOW_SIZE / 2);
+        m_fftTools.fftNormalized(m_history.data() + (size_t)c * WINDOW_SIZE, WINDOW_SIZE, m_spectra[c].data(), FFTTools::Window_Hamming, WINDOW_SIZE);
+    }
+    const QVector<float> spectrum = FFTTools::maximum(m_spectra);
+    const float *bins = spectrum.constData();
+    int bin_count = spectrum.size();
+    double bin_width = (double)m_frequency / WINDOW_SIZE;
 
     int band = 0;
     bool firstBandFound = false;
@@ -391,10 +403,10 @@ void AudioGraphSpectrum::processSpectrum()
         }
     }
 
-    // At this point, bands contains the magnitude of the signal for each
-    // band. Convert to dB.
+    // At this point, bands contains the level in dBFS of each band.
+    // Convert to the magnitude of the signal, then to the display scale.
     for (band = 0; band < bands.size(); band++) {
-        double mag = bands[band];
+        double mag = pow(10.0, bands[band] / 20.0);
         double dB = mag > 0.0 ? levelToDB(mag) : -100.0;
         bands[band] = dB;
     }
@@ -28,6 +28,8 @@
 #ifndef AUDIOGRAPHSPECTRUM_H
 #define AUDIOGRAPHSPECTRUM_H
 
+#include "audioblock.h"
+#include "lib/audio/fftTools.h"
 #include "scopewidget.h"
 #include "sharedframe.h"
 
@@ -35,10 +37,6 @@
 #include <QVector>
 #include <QWidget>
 
-namespace Mlt {
-class Filter;
-}
-
 class MonitorManager;
 
 /*class EqualizerWidget : public QWidget
@@ -83,9 +81,16 @@ public:
 
 private:
     MonitorManager *m_manager;
-    Mlt::Filter *m_filter;
     AudioGraphWidget *m_graphWidget;
     // EqualizerWidget *m_equalizer;
+    FFTTools m_fftTools;
+    int m_channels;
+    int m_frequency;
+    /** @brief Last samples of each channel, as planar float. */
+    std::vector<float> m_history;
+    int m_filled;
+    QVector<QVector<float>> m_spectra;
+    void appendAudio(const AudioBlock &block);
     void processSpectrum();
     void refreshScope(const QSize &size, bool full) override;
 
@@ -0,0 +1,269 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef RINGQUEUE_H
+#define RINGQUEUE_H
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QWaitCondition>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/*!
+  \class RingQueue
+  \brief The RingQueue is a bounded, lock-free single producer / single consumer
+  queue with the same interface and overflow modes as DataQueue.
+
+  \threadsafe
+
+  One thread calls push() while another thread calls pop() or tryPop(). Items are
+  stored in a preallocated ring of slots, so pushing never allocates. The read and
+  write positions live on separate cache lines so that the producer and the
+  consumer do not invalidate each other's cache.
+
+  Each slot carries a sequence number that tells whether it holds an item or is
+  free, which allows the producer to drop the oldest item in
+  OverflowModeDiscardOldest while the consumer is popping, without any lock.
+
+  A mutex is only taken when a thread actually has to sleep: pop() on an empty
+  queue, or push() on a full queue in OverflowModeWait. The sleeping thread is
+  woken by the other side as soon as an item is pushed or popped.
+*/
+
+template <class T> class RingQueue
+{
+public:
+    //! Overflow behavior modes, identical to DataQueue.
+    typedef enum {
+        OverflowModeDiscardOldest = 0, //!< Discard oldest items
+        OverflowModeDiscardNewest,     //!< Discard newest items
+        OverflowModeWait               //!< Wait for space to be free
+    } OverflowMode;
+
+    /*!
+      Constructs a RingQueue.
+
+      The \a maxSize will be the maximum queue size and the \a mode will dictate
+      overflow behavior.
+    */
+    explicit RingQueue(int maxSize, OverflowMode mode);
+
+    /*!
+      Pushes an item into the queue. Must only be called from the producer thread.
+
+      If the queue is full and overflow mode is OverflowModeWait then this
+      function will block until an item is popped.
+    */
+    void push(const T &item);
+
+    /*!
+      Pops an item from the queue. Must only be called from the consumer thread.
+
+      If the queue is empty then this function will block. Use tryPop() if
+      blocking is undesired.
+    */
+    T pop();
+
+    //! Pops an item if one is available, returns false if the queue is empty.
+    bool tryPop(T &item);
+
+    //! Returns the number of items in the queue.
+    int count() const;
+
+private:
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+    enum PushResult { Pushed, Full, Busy };
+    // Size of the padding that keeps the producer and consumer positions on their own cache line
+    static const size_t CacheLine = 64;
+
+    static size_t ringCapacity(size_t size);
+    PushResult tryPushSlot(const T &item);
+    bool tryPopSlot(T &item);
+    void wakeWaiters();
+    template <typename Ready> void waitFor(Ready ready);
+
+    const size_t m_maxSize;
+    const size_t m_mask;
+    const OverflowMode m_mode;
+    std::vector<Slot> m_slots;
+
+    char m_padding0[CacheLine];
+    std::atomic<size_t> m_writePos;
+    char m_padding1[CacheLine - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> m_readPos;
+    char m_padding2[CacheLine - sizeof(std::atomic<size_t>)];
+    std::atomic<int> m_waiters;
+    QMutex m_mutex;
+    QWaitCondition m_condition;
+};
+
+template <class T> size_t RingQueue<T>::ringCapacity(size_t size)
+{
+    // Ring size is the next power of two, so that positions can be masked
+    size_t capacity = 2;
+    while (capacity < size) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+template <class T>
+RingQueue<T>::RingQueue(int maxSize, OverflowMode mode)
+    : m_maxSize(maxSize > 0 ? (size_t)maxSize : 1)
+    , m_mask(ringCapacity(m_maxSize) - 1)
+    , m_mode(mode)
+    , m_slots(m_mask + 1)
+    , m_writePos(0)
+    , m_readPos(0)
+    , m_waiters(0)
+{
+    for (size_t i = 0; i < m_slots.size(); ++i) {
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+template <class T> typename RingQueue<T>::PushResult RingQueue<T>::tryPushSlot(const T &item)
+{
+    size_t pos = m_writePos.load(std::memory_order_relaxed);
+    if (pos - m_readPos.load(std::memory_order_acquire) >= m_maxSize) {
+        return Full;
+    }
+    Slot &slot = m_slots[pos & m_mask];
+    if (slot.sequence.load(std::memory_order_acquire) != pos) {
+        // The consumer is still moving the previous item out of this slot
+        return Busy;
+    }
+    slot.value = item;
+    slot.sequence.store(pos + 1, std::memory_order_release);
+    m_writePos.store(pos + 1, std::memory_order_release);
+    return Pushed;
+}
+
+template <class T> bool RingQueue<T>::tryPopSlot(T &item)
+{
+    // In OverflowModeDiscardOldest, the producer also pops, so the read position must be claimed with a CAS
+    size_t pos = m_readPos.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot &slot = m_slots[pos & m_mask];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != pos + 1) {
+            if (sequence < pos + 1) {
+                // Empty
+                return false;
+            }
+            pos = m_readPos.load(std::memory_order_relaxed);
+            continue;
+        }
+        if (m_readPos.compare_exchange_weak(pos, pos + 1, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+            item = std::move(slot.value);
+            slot.value = T();
+            slot.sequence.store(pos + m_mask + 1, std::memory_order_release);
+            return true;
+        }
+    }
+}
+
+template <class T> void RingQueue<T>::wakeWaiters()
+{
+    // Pairs with the fence in waitFor(): either the waiter sees our update, or we see the waiter
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_waiters.load(std::memory_order_relaxed) > 0) {
+        // Taking the mutex ensures that the waiter is either before its check or inside wait()
+        QMutexLocker locker(&m_mutex);
+        m_condition.wakeAll();
+    }
+}
+
+template <class T> template <typename Ready> void RingQueue<T>::waitFor(Ready ready)
+{
+    QMutexLocker locker(&m_mutex);
+    m_waiters.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    while (!ready()) {
+        m_condition.wait(&m_mutex);
+    }
+    m_waiters.fetch_sub(1, std::memory_order_relaxed);
+}
+
+template <class T> void RingQueue<T>::push(const T &item)
+{
+    PushResult result;
+    while ((result = tryPushSlot(item)) != Pushed) {
+        if (result == Busy) {
+            // The consumer is moving out the slot we need, it will be free in a moment
+            QThread::yieldCurrentThread();
+            continue;
+        }
+        switch (m_mode) {
+        case OverflowModeDiscardOldest: {
+            T dropped;
+            tryPopSlot(dropped);
+            break;
+        }
+        case OverflowModeDiscardNewest:
+            // This item is the newest so discard it and exit
+            return;
+        case OverflowModeWait:
+            waitFor([this]() { return m_writePos.load(std::memory_order_acquire) - m_readPos.load(std::memory_order_acquire) < m_maxSize; });
+            break;
+        }
+    }
+    wakeWaiters();
+}
+
+template <class T> T RingQueue<T>::pop()
+{
+    T retVal;
+    while (!tryPopSlot(retVal)) {
+        waitFor([this]() { return m_writePos.load(std::memory_order_acquire) != m_readPos.load(std::memory_order_acquire); });
+    }
+    if (m_mode == OverflowModeWait) {
+        wakeWaiters();
+    }
+    return retVal;
+}
+
+template <class T> bool RingQueue<T>::tryPop(T &item)
+{
+    if (!tryPopSlot(item)) {
+        return false;
+    }
+    if (m_mode == OverflowModeWait) {
+        wakeWaiters();
+    }
+    return true;
+}
+
+template <class T> int RingQueue<T>::count() const
+{
+    size_t write = m_writePos.load(std::memory_order_acquire);
+    size_t read = m_readPos.load(std::memory_order_acquire);
+    return write > read ? (int)(write - read) : 0;
+}
+
+#endif // RINGQUEUE_H
@@ -0,0 +1,313 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "scopeframe.h"
+
+#include <vector>
+
+namespace {
+inline uchar clamp255(int value)
+{
+    return (uchar)(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+} // namespace
+
+struct ScopeFrame::Data
+{
+    // Keeps the image alive when the planes point into it
+    SharedFrame frame;
+    // Holds the planes of a converted image
+    std::vector<uchar> buffer;
+    const uchar *planes[3] = {nullptr, nullptr, nullptr};
+    int strides[3] = {0, 0, 0};
+    int width = 0;
+    int height = 0;
+    ColorSpace colorSpace = Rec601;
+    bool fullRange = false;
+    // Luma sample to full range luma
+    uchar fullLuma[256];
+    // YUV to RGB, in 1/256: R = ky * (Y - yOffset) + rv * V, G = ky * (Y - yOffset) - gu * U - gv * V, B = ky * (Y - yOffset) + bu * U
+    int yOffset = 16;
+    int ky = 298;
+    int rv = 409;
+    int gu = 100;
+    int gv = 208;
+    int bu = 516;
+    // Legal luma samples and R, G, B values (in 0-255, before clamping) according to EBU R 103
+    int lumaLow = 14;
+    int lumaHigh = 241;
+    int rgbLow = -13;
+    int rgbHigh = 268;
+
+    void setup()
+    {
+        yOffset = fullRange ? 0 : 16;
+        ky = fullRange ? 256 : 298;
+        if (colorSpace == Rec709) {
+            rv = fullRange ? 403 : 459;
+            gu = fullRange ? 48 : 55;
+            gv = fullRange ? 120 : 136;
+            bu = fullRange ? 475 : 541;
+        } else {
+            rv = fullRange ? 359 : 409;
+            gu = fullRange ? 88 : 100;
+            gv = fullRange ? 183 : 208;
+            bu = fullRange ? 454 : 516;
+        }
+        for (int i = 0; i < 256; ++i) {
+            fullLuma[i] = clamp255((ky * (i - yOffset) + 128) >> 8);
+        }
+        const int black = yOffset;
+        const int white = fullRange ? 255 : 235;
+        lumaLow = black - (white - black + 50) / 100;
+        lumaHigh = white + (3 * (white - black) + 50) / 100;
+    }
+
+    inline QRgb toRgb(int y, int u, int v) const
+    {
+        const int c = ky * (y - yOffset) + 128;
+        u -= 128;
+        v -= 128;
+        return qRgb(clamp255((c + rv * v) >> 8), clamp255((c - gu * u - gv * v) >> 8), clamp255((c + bu * u) >> 8));
+    }
+};
+
+ScopeFrame::ScopeFrame() = default;
+
+ScopeFrame::ScopeFrame(const SharedFrame &frame)
+{
+    if (!frame.is_valid() || frame.get_image_format() != mlt_image_yuv420p) {
+        return;
+    }
+    const int width = frame.get_image_width();
+    const int height = frame.get_image_height();
+    const uchar *image = frame.get_image();
+    if (image == nullptr || width < 2 || height < 2) {
+        return;
+    }
+    auto data = std::make_shared<Data>();
+    data->frame = frame;
+    // Chroma is subsampled on 2x2 blocks, an odd last line or column has no chroma of its own and is dropped
+    data->width = width & ~1;
+    data->height = height & ~1;
+    // Same layout as the textures uploaded by the monitor
+    data->planes[0] = image;
+    data->planes[1] = image + width * height;
+    data->planes[2] = data->planes[1] + width / 2 * height / 2;
+    data->strides[0] = width;
+    data->strides[1] = data->strides[2] = width / 2;
+    data->colorSpace = frame.get_int("colorspace") == 709 ? Rec709 : Rec601;
+    data->fullRange = frame.get_int("full_luma") != 0;
+    data->setup();
+    d = std::move(data);
+}
+
+ScopeFrame::ScopeFrame(const QImage &source)
+{
+    if (source.width() < 2 || source.height() < 2) {
+        return;
+    }
+    const QImage image = source.format() == QImage::Format_RGB32 || source.format() == QImage::Format_ARGB32 ? source
+                                                                                                              : source.convertToFormat(QImage::Format_RGB32);
+    auto data = std::make_shared<Data>();
+    // Chroma is subsampled on 2x2 blocks, an odd last line or column is dropped
+    const int width = image.width() & ~1;
+    const int height = image.height() & ~1;
+    const int cw = width / 2;
+    const int ch = height / 2;
+    data->buffer.resize((size_t)(width * height + 2 * cw * ch));
+    uchar *y = data->buffer.data();
+    uchar *u = y + width * height;
+    uchar *v = u + cw * ch;
+    for (int row = 0; row < height; row += 2) {
+        const auto *line0 = reinterpret_cast<const QRgb *>(image.constScanLine(row));
+        const auto *line1 = reinterpret_cast<const QRgb *>(image.constScanLine(row + 1));
+        uchar *y0 = y + row * width;
+        uchar *y1 = y0 + width;
+        uchar *uOut = u + row / 2 * cw;
+        uchar *vOut = v + row / 2 * cw;
+        for (int x = 0; x < width; x += 2) {
+            int r = 0, g = 0, b = 0;
+            const QRgb px[4] = {line0[x], line0[x + 1], line1[x], line1[x + 1]};
+            uchar *luma[4] = {y0 + x, y0 + x + 1, y1 + x, y1 + x + 1};
+            for (int i = 0; i < 4; ++i) {
+                const int pr = qRed(px[i]), pg = qGreen(px[i]), pb = qBlue(px[i]);
+                // Full range Rec. 601 coefficients, in 1/256
+                *luma[i] = (uchar)((77 * pr + 150 * pg + 29 * pb + 128) >> 8);
+                r += pr;
+                g += pg;
+                b += pb;
+            }
+            // Chroma of the average color of the block
+            uOut[x / 2] = clamp255(((-43 * r - 85 * g + 128 * b) / 4 + 128 * 256 + 128) >> 8);
+            vOut[x / 2] = clamp255(((128 * r - 107 * g - 21 * b) / 4 + 128 * 256 + 128) >> 8);
+        }
+    }
+    data->width = width;
+    data->height = height;
+    data->planes[0] = y;
+    data->planes[1] = u;
+    data->planes[2] = v;
+    data->strides[0] = width;
+    data->strides[1] = data->strides[2] = cw;
+    data->colorSpace = Rec601;
+    data->fullRange = true;
+    data->setup();
+    d = std::move(data);
+}
+
+bool ScopeFrame::isValid() const
+{
+    return d != nullptr;
+}
+
+int ScopeFrame::width() const
+{
+    return d ? d->width : 0;
+}
+
+int ScopeFrame::height() const
+{
+    return d ? d->height : 0;
+}
+
+int ScopeFrame::pixelCount() const
+{
+    return d ? d->width * d->height : 0;
+}
+
+int ScopeFrame::chromaWidth() const
+{
+    return d ? d->width / 2 : 0;
+}
+
+int ScopeFrame::chromaHeight() const
+{
+    return d ? d->height / 2 : 0;
+}
+
+ScopeFrame::ColorSpace ScopeFrame::colorSpace() const
+{
+    return d ? d->colorSpace : Rec601;
+}
+
+bool ScopeFrame::fullRange() const
+{
+    return d ? d->fullRange : false;
+}
+
+const uchar *ScopeFrame::yLine(int row) const
+{
+    return d->planes[0] + row * d->strides[0];
+}
+
+const uchar *ScopeFrame::uLine(int chromaRow) const
+{
+    return d->planes[1] + chromaRow * d->strides[1];
+}
+
+const uchar *ScopeFrame::vLine(int chromaRow) const
+{
+    return d->planes[2] + chromaRow * d->strides[2];
+}
+
+float ScopeFrame::chromaScale() const
+{
+    // Studio range chroma uses 16-240
+    return d && d->fullRange ? 1.0f / 255.0f : 1.0f / 224.0f;
+}
+
+void ScopeFrame::lumaLine(int row, ColorSpace space, uchar *out) const
+{
+    const uchar *y = yLine(row);
+    const int width = d->width;
+    if (space == d->colorSpace) {
+        // The frame luma already uses these coefficients, only the range is adjusted
+        const uchar *table = d->fullLuma;
+        for (int x = 0; x < width; ++x) {
+            out[x] = table[y[x]];
+        }
+        return;
+    }
+    // Other coefficients need the RGB color
+    const uchar *u = uLine(row / 2);
+    const uchar *v = vLine(row / 2);
+    const int kr = space == Rec709 ? 54 : 77;
+    const int kg = space == Rec709 ? 183 : 150;
+    const int kb = space == Rec709 ? 19 : 29;
+    for (int x = 0; x < width; ++x) {
+        const QRgb rgb = d->toRgb(y[x], u[x / 2], v[x / 2]);
+        out[x] = (uchar)((kr * qRed(rgb) + kg * qGreen(rgb) + kb * qBlue(rgb) + 128) >> 8);
+    }
+}
+
+void ScopeFrame::rgbLine(int row, QRgb *out) const
+{
+    const uchar *y = yLine(row);
+    const uchar *u = uLine(row / 2);
+    const uchar *v = vLine(row / 2);
+    const int width = d->width;
+    for (int x = 0; x < width; ++x) {
+        out[x] = d->toRgb(y[x], u[x / 2], v[x / 2]);
+    }
+}
+
+QRgb ScopeFrame::rgbAt(int x, int row) const
+{
+    return d->toRgb(yLine(row)[x], uLine(row / 2)[x / 2], vLine(row / 2)[x / 2]);
+}
+
+QRgb ScopeFrame::rgb(int y, int u, int v) const
+{
+    return d->toRgb(y, u, v);
+}
+
+void ScopeFrame::countIllegal(int row, uint &luma, uint &gamut) const
+{
+    const uchar *y = yLine(row);
+    const uchar *u = uLine(row / 2);
+    const uchar *v = vLine(row / 2);
+    const Data &data = *d;
+    uint lumaCount = 0;
+    uint gamutCount = 0;
+    for (int x = 0; x < data.width; ++x) {
+        const int c = data.ky * (y[x] - data.yOffset) + 128;
+        const int cu = u[x / 2] - 128;
+        const int cv = v[x / 2] - 128;
+        const int r = (c + data.rv * cv) >> 8;
+        const int g = (c - data.gu * cu - data.gv * cv) >> 8;
+        const int b = (c + data.bu * cu) >> 8;
+        lumaCount += (uint)(y[x] < data.lumaLow || y[x] > data.lumaHigh);
+        gamutCount += (uint)(qMin(r, qMin(g, b)) < data.rgbLow || qMax(r, qMax(g, b)) > data.rgbHigh);
+    }
+    luma += lumaCount;
+    gamut += gamutCount;
+}
+
+bool ScopeFrame::operator==(const ScopeFrame &other) const
+{
+    return d == other.d;
+}
+
+bool ScopeFrame::operator!=(const ScopeFrame &other) const
+{
+    return d != other.d;
+}
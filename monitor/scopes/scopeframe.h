@@ -0,0 +1,105 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef SCOPEFRAME_H
+#define SCOPEFRAME_H
+
+#include "sharedframe.h"
+
+#include <QImage>
+#include <QMetaType>
+#include <memory>
+
+/*!
+  \class ScopeFrame
+  \brief The ScopeFrame gives the color scopes read-only access to the Y, U and V
+  planes of a frame.
+
+  \threadsafe
+
+  ScopeFrame is a reference counted, immutable view on a planar 8 bit YUV 4:2:0
+  image. When built from a SharedFrame holding a yuv420p image, which is what the
+  monitor renders in software mode, the planes point into the frame and nothing is
+  copied or converted: the scopes read luma and chroma as they were decoded.
+
+  A ScopeFrame can also be built from an RGB QImage, for the sources that only
+  provide one (GPU rendering, capture devices). The image is then converted once
+  to full range Rec. 601 YUV.
+
+  The scopes work on lines: lumaLine() and rgbLine() convert a line into a buffer
+  owned by the caller, with integer arithmetic.
+*/
+
+class ScopeFrame
+{
+public:
+    enum ColorSpace { Rec601 = 601, Rec709 = 709 };
+
+    ScopeFrame();
+    explicit ScopeFrame(const SharedFrame &frame);
+    explicit ScopeFrame(const QImage &image);
+
+    bool isValid() const;
+    int width() const;
+    int height() const;
+    int pixelCount() const;
+    //! Number of chroma samples per line, one for two pixels.
+    int chromaWidth() const;
+    //! Number of chroma lines, one for two lines.
+    int chromaHeight() const;
+    ColorSpace colorSpace() const;
+    //! Returns true if luma uses 0-255, false for the studio range 16-235.
+    bool fullRange() const;
+
+    //! Luma samples of a line, as stored in the frame.
+    const uchar *yLine(int row) const;
+    //! Chroma samples of a chroma line (see chromaHeight()).
+    const uchar *uLine(int chromaRow) const;
+    const uchar *vLine(int chromaRow) const;
+    //! Factor converting a chroma sample minus 128 to Pb / Pr in the -0.5 / 0.5 range.
+    float chromaScale() const;
+
+    //! Writes the full range luma of a line, with the coefficients of the given color space.
+    void lumaLine(int row, ColorSpace space, uchar *out) const;
+    //! Writes the RGB color of each pixel of a line.
+    void rgbLine(int row, QRgb *out) const;
+    QRgb rgbAt(int x, int row) const;
+    //! Converts a Y, U, V sample to RGB with the coefficients of the frame.
+    QRgb rgb(int y, int u, int v) const;
+    /*!
+      Adds to \a luma the number of pixels of a line whose luma is outside the EBU R 103
+      range (-1% to 103%), and to \a gamut the ones with a R, G or B component outside
+      -5% to 105%.
+    */
+    void countIllegal(int row, uint &luma, uint &gamut) const;
+
+    //! Returns true if both objects view the same frame.
+    bool operator==(const ScopeFrame &other) const;
+    bool operator!=(const ScopeFrame &other) const;
+
+private:
+    struct Data;
+    std::shared_ptr<const Data> d;
+};
+
+Q_DECLARE_METATYPE(ScopeFrame)
+
+#endif // SCOPEFRAME_H
@@ -22,7 +22,7 @@
 
 ScopeWidget::ScopeWidget(QWidget *parent)
     : QWidget(parent)
-    , m_queue(3, DataQueue<SharedFrame>::OverflowModeDiscardOldest)
+    , m_queue(3, RingQueue<SharedFrame>::OverflowModeDiscardOldest)
     , m_future()
     , m_refreshPending(false)
     , m_mutex(QMutex::NonRecursive)
@@ -19,7 +19,7 @@
 #ifndef SCOPEWIDGET_H
 #define SCOPEWIDGET_H
 
-#include "dataqueue.h"
+#include "ringqueue.h"
 #include "sharedframe.h"
 #include <QFuture>
 #include <QMutex>
@@ -37,7 +37,7 @@
   is the ability to trigger the "heavy lifting" to be done in a worker thread.
 
   Frames are received by the onNewFrame() slot. The ScopeWidget automatically
-  places new frames in the DataQueue (m_queue). Subclasses shall implement the
+  places new frames in the RingQueue (m_queue). Subclasses shall implement the
   refreshScope() function and can check for new frames in m_queue.
 
   refreshScope() is run from a separate thread. Therefore, any members that are
@@ -108,7 +108,7 @@ protected:
       Subclasses should check this queue for new frames in the refreshScope()
       implementation.
     */
-    DataQueue<SharedFrame> m_queue;
+    RingQueue<SharedFrame> m_queue;
 
     void resizeEvent(QResizeEvent *) override;
     void changeEvent(QEvent *) override;
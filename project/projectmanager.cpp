@@ -12,11 +12,11 @@ the Free Software Foundation, either version 3 of the License, or
 #include "bin/bin.h"
 #include "bin/projectitemmodel.h"
 #include "core.h"
-#include "/home/mahesh/devel/src/kdenlive_git/kdenlive/src/mixer/audiomixer.h"
 #include "doc/kdenlivedoc.h"
 #include "jobs/jobmanager.h"
 #include "kdenlivesettings.h"
 #include "mainwindow.h"
+#include "mixer/audiomixer.h"
 #include "mltcontroller/bincontroller.h"
 #include "monitor/monitormanager.h"
 #include "profiles/profilemodel.hpp"
@@ -864,10 +864,13 @@ void ProjectManager::updateTimeline(int pos)
     Mlt::Service s(*xmlProd);
     Mlt::Tractor tractor(s);
     m_mainTimelineModel = TimelineItemModel::construct(&pCore->getCurrentProfile()->profile(), m_project->getGuideModel(), m_project->commandStack());
-    constructTimelineFromMelt(m_mainTimelineModel, tractor);
-    const QString groupsData = m_project->getDocumentProperty(QStringLiteral("groups"));
-    if (!groupsData.isEmpty()) {
-        m_mainTimelineModel->loadGroups(groupsData);
+    if (constructTimelineFromMelt(m_mainTimelineModel, tractor)) {
+        const QString groupsData = m_project->getDocumentProperty(QStringLiteral("groups"));
+        if (!groupsData.isEmpty()) {
+            m_mainTimelineModel->loadGroups(groupsData);
+        }
+    } else {
+        KMessageBox::sorry(pCore->window(), i18n("Cannot load the timeline of the project, it is opened empty."));
     }
 
     pCore->monitorManager()->projectMonitor()->setProducer(m_mainTimelineModel->producer(), pos);
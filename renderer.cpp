@@ -898,24 +898,18 @@ void Render::showAudio(Mlt::Frame &frame)
         return;
     }
 
+    // The consumer already fetched the audio, keep its frequency and channels and only ask for 16 bit samples
     mlt_audio_format audio_format = mlt_audio_s16;
-    // FIXME: should not be hardcoded..
-    int freq = 48000;
-    int num_channels = 2;
-    int samples = 0;
-    qint16 *data = (qint16 *)frame.get_audio(audio_format, freq, num_channels, samples);
-
-    if (!data) {
+    int freq = frame.get_int("audio_frequency");
+    int num_channels = frame.get_int("audio_channels");
+    int samples = frame.get_int("audio_samples");
+    if (frame.get_audio(audio_format, freq, num_channels, samples) == nullptr) {
         return;
     }
-
-    // Data format: [ c00 c10 c01 c11 c02 c12 c03 c13 ... c0{samples-1} c1{samples-1} for 2 channels.
-    // So the vector is of size samples*channels.
-    audioShortVector sampleVector(samples * num_channels);
-    memcpy(sampleVector.data(), data, (unsigned) (samples * num_channels) * sizeof(qint16));
-
-    if (samples > 0) {
-        emit audioSamplesSignal(sampleVector, freq, num_channels, samples);
+    // The block shares the frame audio, the scopes read it without any copy
+    AudioBlock block{SharedFrame(frame)};
+    if (block.isValid()) {
+        emit audioSamplesSignal(block);
     }
 }
 
@@ -129,6 +129,7 @@ void AbstractScopeWidget::readConfig()
     KConfigGroup scopeConfig(config, configName());
     m_aAutoRefresh->setChecked(scopeConfig.readEntry("autoRefresh", true));
     m_aRealtime->setChecked(scopeConfig.readEntry("realtime", false));
+    m_scopeScheduler.setBudget(scopeConfig.readEntry("renderBudget", (int)ScopeScheduler::DefaultBudget));
     scopeConfig.sync();
 }
 
@@ -138,6 +139,7 @@ void AbstractScopeWidget::writeConfig()
     KConfigGroup scopeConfig(config, configName());
     scopeConfig.writeEntry("autoRefresh", m_aAutoRefresh->isChecked());
     scopeConfig.writeEntry("realtime", m_aRealtime->isChecked());
+    scopeConfig.writeEntry("renderBudget", m_scopeScheduler.budget());
     scopeConfig.sync();
 }
 
@@ -192,6 +194,8 @@ void AbstractScopeWidget::prodScopeThread()
 
             Q_ASSERT(m_accelFactorScope > 0);
 
+            // Frames received since the last render are dropped, only the newest one is rendered
+            m_scopeScheduler.renderStarted(m_accelFactorScope);
             // See http://doc.qt.nokia.com/latest/qtconcurrentrun.html#run about
             // running member functions in a thread
             m_threadScope = QtConcurrent::run(this, &AbstractScopeWidget::renderScope, m_accelFactorScope);
@@ -387,9 +391,9 @@ uint AbstractScopeWidget::calculateAccelFactorHUD(uint oldMseconds, uint)
 {
     return ceil((float)oldMseconds * REALTIME_FPS / 1000);
 }
-uint AbstractScopeWidget::calculateAccelFactorScope(uint oldMseconds, uint)
+uint AbstractScopeWidget::calculateAccelFactorScope(uint, uint)
 {
-    return ceil((float)oldMseconds * REALTIME_FPS / 1000);
+    return m_scopeScheduler.accelFactor();
 }
 uint AbstractScopeWidget::calculateAccelFactorBackground(uint oldMseconds, uint)
 {
@@ -435,12 +439,20 @@ void AbstractScopeWidget::slotScopeRenderingFinished(uint mseconds, uint oldFact
     qCDebug(KDENLIVE_LOG) << "Scope rendering has finished in " << mseconds << " ms, waiting for termination in " << m_widgetName;
 #endif
     m_threadScope.waitForFinished();
-    m_imgScope = m_threadScope.result();
+    // Results more than one frame behind the monitor are not shown, a newer frame is rendered instead
+    if (m_scopeScheduler.renderFinished(mseconds)) {
+        m_imgScope = m_threadScope.result();
+        this->update();
+    }
+#ifdef DEBUG_ASW
+    else {
+        qCDebug(KDENLIVE_LOG) << "Scope rendering is outdated, discarding it in " << m_widgetName;
+    }
+#endif
 
     // The scope thread has finished. Now we can release the semaphore, allowing a new thread.
     // See prodScopeThread where the semaphore is acquired again.
     m_semaphoreScope.release(1);
-    this->update();
 
     // Calculate the acceleration factor hint to get «realtime» updates.
     if (m_aRealtime->isChecked()) {
@@ -511,6 +523,7 @@ void AbstractScopeWidget::slotRenderZoneUpdated()
 #endif
     } else {
         if (m_aAutoRefresh->isChecked()) {
+            m_scopeScheduler.frameReceived();
             prodHUDThread();
             prodScopeThread();
             prodBackgroundThread();
@@ -525,6 +538,22 @@ void AbstractScopeWidget::slotResetRealtimeFactor(bool realtimeChecked)
         m_accelFactorScope = 1;
         m_accelFactorBackground = 1;
     }
+    m_scopeScheduler.setAdaptive(realtimeChecked);
+}
+
+ScopeScheduler::Stats AbstractScopeWidget::renderStats() const
+{
+    return m_scopeScheduler.stats();
+}
+
+int AbstractScopeWidget::renderBudget() const
+{
+    return m_scopeScheduler.budget();
+}
+
+void AbstractScopeWidget::setRenderBudget(int mseconds)
+{
+    m_scopeScheduler.setBudget(mseconds);
 }
 
 bool AbstractScopeWidget::autoRefreshEnabled() const
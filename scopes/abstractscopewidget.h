@@ -15,6 +15,8 @@
 #include <QMenu>
 #include <QSemaphore>
 #include <QWidget>
+
+#include "scopescheduler.h"
 /**
   \brief Abstract class for audio/colour scopes (receive data and paint it).
 
@@ -82,6 +84,12 @@ public:
 
     bool needsSingleFrame();
 
+    /** @brief Render statistics of the scope layer: render times, dropped frames and acceleration factor. */
+    ScopeScheduler::Stats renderStats() const;
+    /** @brief Time in milliseconds the scope layer should take at most in realtime mode. */
+    int renderBudget() const;
+    void setRenderBudget(int mseconds);
+
     ///// Unimplemented /////
 
     virtual QString widgetName() const = 0;
@@ -187,6 +195,7 @@ protected:
 
     ///// Can be reimplemented /////
     /** Calculates the acceleration factor to be used by the render thread.
+        By default, the scope layer uses the factor adapted to its render budget by its scheduler.
         This method can be refined in the subclass if required. */
     virtual uint calculateAccelFactorHUD(uint oldMseconds, uint oldFactor);
     virtual uint calculateAccelFactorScope(uint oldMseconds, uint oldFactor);
@@ -256,6 +265,9 @@ private:
     QSemaphore m_semaphoreScope;
     QSemaphore m_semaphoreBackground;
 
+    /** Keeps track of the frames and render times of the scope layer. */
+    ScopeScheduler m_scopeScheduler;
+
     QFuture<QImage> m_threadHUD;
     QFuture<QImage> m_threadScope;
     QFuture<QImage> m_threadBackground;
@@ -294,7 +306,8 @@ protected slots:
     void slotScopeRenderingFinished(uint mseconds, uint accelerationFactor);
     void slotBackgroundRenderingFinished(uint mseconds, uint accelerationFactor);
 
-    /** Resets the acceleration factors to 1 when realtime rendering is disabled. */
+    /** Resets the acceleration factors to 1 when realtime rendering is disabled,
+        and enables the adaptation of the scope layer factor to its budget otherwise. */
     void slotResetRealtimeFactor(bool realtimeChecked);
 };
 
@@ -30,15 +30,17 @@ AbstractAudioScopeWidget::AbstractAudioScopeWidget(bool trackMouse, QWidget *par
 {
 }
 
-void AbstractAudioScopeWidget::slotReceiveAudio(const audioShortVector &sampleData, int freq, int num_channels, int num_samples)
+void AbstractAudioScopeWidget::slotReceiveAudio(const AudioBlock &block)
 {
 #ifdef DEBUG_AASW
     qCDebug(KDENLIVE_LOG) << "Received audio for " << widgetName() << '.';
 #endif
-    m_audioFrame = sampleData;
-    m_freq = freq;
-    m_nChannels = num_channels;
-    m_nSamples = num_samples;
+    m_frameMutex.lock();
+    m_audioFrame = block;
+    m_freq = block.frequency();
+    m_nChannels = block.channels();
+    m_nSamples = block.samples();
+    m_frameMutex.unlock();
 
     m_newData.fetchAndAddAcquire(1);
 
@@ -50,8 +52,15 @@ AbstractAudioScopeWidget::~AbstractAudioScopeWidget() = default;
 QImage AbstractAudioScopeWidget::renderScope(uint accelerationFactor)
 {
     const int newData = m_newData.fetchAndStoreAcquire(0);
+    // The rendering thread keeps its own reference on the block, slotReceiveAudio() can replace the member meanwhile
+    m_frameMutex.lock();
+    const AudioBlock frame = m_audioFrame;
+    const int freq = m_freq;
+    const int channels = m_nChannels;
+    const int samples = m_nSamples;
+    m_frameMutex.unlock();
 
-    return renderAudioScope(accelerationFactor, m_audioFrame, m_freq, m_nChannels, m_nSamples, newData);
+    return renderAudioScope(accelerationFactor, frame, freq, channels, samples, newData);
 }
 
 #ifdef DEBUG_AASW
@@ -11,12 +11,14 @@
 #ifndef ABSTRACTAUDIOSCOPEWIDGET_H
 #define ABSTRACTAUDIOSCOPEWIDGET_H
 
+#include <QMutex>
 #include <QWidget>
 
 #include <stdint.h>
 
 #include "../../definitions.h"
 #include "../abstractscopewidget.h"
+#include "monitor/scopes/audioblock.h"
 
 class Render;
 
@@ -31,7 +33,7 @@ public:
     virtual ~AbstractAudioScopeWidget();
 
 public slots:
-    void slotReceiveAudio(const audioShortVector &sampleData, int freq, int num_channels, int num_samples);
+    void slotReceiveAudio(const AudioBlock &block);
 
 protected:
     /** @brief This is just a wrapper function, subclasses can use renderAudioScope. */
@@ -41,7 +43,7 @@ protected:
     /** @brief Scope renderer. Must emit signalScopeRenderingFinished()
         when calculation has finished, to allow multi-threading.
         accelerationFactor hints how much faster than usual the calculation should be accomplished, if possible. */
-    virtual QImage renderAudioScope(uint accelerationFactor, const audioShortVector &audioFrame, const int freq, const int num_channels, const int num_samples,
+    virtual QImage renderAudioScope(uint accelerationFactor, const AudioBlock &audioFrame, const int freq, const int num_channels, const int num_samples,
                                     const int newData) = 0;
 
     int m_freq;
@@ -49,7 +51,10 @@ protected:
     int m_nSamples;
 
 private:
-    audioShortVector m_audioFrame;
+    // Shares the audio of the last frame, no samples are copied
+    AudioBlock m_audioFrame;
+    // Protects the audio frame and its properties, that are written and read from different threads
+    QMutex m_frameMutex;
     QAtomicInt m_newData;
 };
 
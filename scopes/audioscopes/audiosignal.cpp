@@ -37,7 +37,7 @@ AudioSignal::AudioSignal(QWidget *parent)
 
 AudioSignal::~AudioSignal() = default;
 
-QImage AudioSignal::renderAudioScope(uint, const audioShortVector &audioFrame, const int, const int num_channels, const int samples, const int)
+QImage AudioSignal::renderAudioScope(uint, const AudioBlock &audioFrame, const int, const int num_channels, const int samples, const int)
 {
     QTime start = QTime::currentTime();
 
@@ -153,9 +153,10 @@ QImage AudioSignal::renderBackground(uint)
     return QImage();
 }
 
-void AudioSignal::slotReceiveAudio(audioShortVector audioSamples, int, int num_channels, int samples)
+void AudioSignal::slotReceiveAudio(const AudioBlock &audioSamples)
 {
-
+    const int num_channels = audioSamples.channels();
+    const int samples = audioSamples.samples();
     int num_samples = samples > 200 ? 200 : samples;
 
     QByteArray chanSignal;
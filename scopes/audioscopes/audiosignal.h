@@ -42,7 +42,7 @@ public:
     QRect scopeRect() override;
     QImage renderHUD(uint accelerationFactor) override;
     QImage renderBackground(uint accelerationFactor) override;
-    QImage renderAudioScope(uint accelerationFactor, const audioShortVector &audioFrame, const int, const int num_channels, const int samples,
+    QImage renderAudioScope(uint accelerationFactor, const AudioBlock &audioFrame, const int, const int num_channels, const int samples,
                             const int) override;
 
     QString widgetName() const override { return QStringLiteral("audioSignal"); }
@@ -58,7 +58,7 @@ private:
 
 public slots:
     void showAudio(const QByteArray &);
-    void slotReceiveAudio(audioShortVector audioSamples, int, int num_channels, int samples);
+    void slotReceiveAudio(const AudioBlock &audioSamples);
 private slots:
     void slotNoAudioTimeout();
 
@@ -155,7 +155,7 @@ QImage AudioSpectrum::renderBackground(uint)
     return QImage();
 }
 
-QImage AudioSpectrum::renderAudioScope(uint, const audioShortVector &audioFrame, const int freq, const int num_channels, const int num_samples, const int)
+QImage AudioSpectrum::renderAudioScope(uint, const AudioBlock &audioFrame, const int freq, const int num_channels, const int num_samples, const int)
 {
     if (audioFrame.size() > 63 && m_innerScopeRect.width() > 0 && m_innerScopeRect.height() > 0 // <= 0 if widget is too small (resized by user)
         ) {
@@ -208,18 +208,17 @@ QImage AudioSpectrum::renderAudioScope(uint, const audioShortVector &audioFrame,
         // Show the window size used, for information
         ui->labelFFTSizeNumber->setText(QVariant(fftWindow).toString());
 
-        // Get the spectral power distribution of the input samples,
+        // Get the spectral power distribution of every channel of the input samples,
         // using the given window size and function
-        float freqSpectrum[fftWindow / 2];
         FFTTools::WindowType windowType = (FFTTools::WindowType)ui->windowFunction->itemData(ui->windowFunction->currentIndex()).toInt();
-        m_fftTools.fftNormalized(audioFrame, 0, num_channels, freqSpectrum, windowType, fftWindow, 0);
+        m_fftTools.spectra(audioFrame.data(), (uint)audioFrame.samples(), (uint)num_channels, m_channelSpectra, windowType, (uint)fftWindow, 0);
 
         // Store the current FFT window (for the HUD) and run the interpolation
-        // for easy pixel-based dB value access
+        // for easy pixel-based dB value access. A sound on any channel is shown,
+        // so keep the loudest value of each bin.
         QVector<float> dbMap;
         m_lastFFTLock.acquire();
-        m_lastFFT = QVector<float>(fftWindow / 2);
-        memcpy(m_lastFFT.data(), &(freqSpectrum[0]), fftWindow / 2 * sizeof(float));
+        m_lastFFT = FFTTools::maximum(m_channelSpectra);
 
         uint right = ((float)m_freqMax) / (m_freq / 2) * (m_lastFFT.size() - 1);
         dbMap = FFTTools::interpolatePeakPreserving(m_lastFFT, m_innerScopeRect.width(), 0, right, -180);
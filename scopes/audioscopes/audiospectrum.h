@@ -49,7 +49,7 @@ protected:
     ///// Implemented methods /////
     QRect scopeRect() override;
     QImage renderHUD(uint accelerationFactor) override;
-    QImage renderAudioScope(uint accelerationFactor, const audioShortVector &audioFrame, const int freq, const int num_channels, const int num_samples,
+    QImage renderAudioScope(uint accelerationFactor, const AudioBlock &audioFrame, const int freq, const int num_channels, const int num_samples,
                             const int newData) override;
     QImage renderBackground(uint accelerationFactor) override;
     void readConfig() override;
@@ -65,6 +65,7 @@ private:
     QAction *m_aShowMax;
 
     FFTTools m_fftTools;
+    QVector<QVector<float>> m_channelSpectra;
     QVector<float> m_lastFFT;
     QSemaphore m_lastFFTLock;
 
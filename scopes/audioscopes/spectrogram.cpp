@@ -13,6 +13,8 @@
 #include <QPainter>
 #include <QTime>
 
+#include <algorithm>
+
 #include "klocalizedstring.h"
 #include <KConfigGroup>
 #include <KSharedConfig>
@@ -37,8 +39,12 @@
 Spectrogram::Spectrogram(QWidget *parent)
     : AbstractAudioScopeWidget(true, parent)
     , m_fftTools()
-    , m_fftHistory()
-    , m_fftHistoryImg()
+    , m_fftHistory(SPECTROGRAM_HISTORY_SIZE)
+    , m_historyHead(0)
+    , m_historyCount(0)
+    , m_rowHead(0)
+    , m_rowsFreqMax(0)
+    , m_rowsFreq(0)
     , m_dBmin(-70)
     , m_dBmax(0)
     , m_freqMax(0)
@@ -295,7 +301,7 @@ QImage Spectrogram::renderHUD(uint)
     emit signalHUDRenderingFinished(0, 1);
     return QImage();
 }
-QImage Spectrogram::renderAudioScope(uint, const audioShortVector &audioFrame, const int freq, const int num_channels, const int num_samples, const int newData)
+QImage Spectrogram::renderAudioScope(uint, const AudioBlock &audioFrame, const int freq, const int num_channels, const int num_samples, const int newData)
 {
     if (audioFrame.size() > 63 && m_innerScopeRect.width() > 0 && m_innerScopeRect.height() > 0) {
         if (!m_customFreq) {
@@ -322,18 +328,17 @@ QImage Spectrogram::renderAudioScope(uint, const audioShortVector &audioFrame, c
 
         if (newDataAvailable) {
 
-            float freqSpectrum[fftWindow / 2];
-
-            // Get the spectral power distribution of the input samples,
+            // Get the spectral power distribution of every channel of the input samples,
             // using the given window size and function
             FFTTools::WindowType windowType = (FFTTools::WindowType)ui->windowFunction->itemData(ui->windowFunction->currentIndex()).toInt();
-            m_fftTools.fftNormalized(audioFrame, 0, num_channels, freqSpectrum, windowType, fftWindow, 0);
+            m_fftTools.spectra(audioFrame.data(), (uint)audioFrame.samples(), (uint)num_channels, m_channelSpectra, windowType, (uint)fftWindow, 0);
 
             // This methid might be called also when a simple refresh is required.
             // In this case there is no data to append to the history. Only append new data.
-            QVector<float> spectrumVector(fftWindow / 2);
-            memcpy(spectrumVector.data(), &freqSpectrum[0], fftWindow / 2 * sizeof(float));
-            m_fftHistory.prepend(spectrumVector);
+            // A sound on any channel is shown, so keep the loudest value of each bin.
+            m_historyHead = (m_historyHead + 1) % SPECTROGRAM_HISTORY_SIZE;
+            m_fftHistory[m_historyHead] = FFTTools::maximum(m_channelSpectra);
+            m_historyCount = qMin(m_historyCount + 1, SPECTROGRAM_HISTORY_SIZE);
         }
 #ifdef DEBUG_SPECTROGRAM
         else {
@@ -341,98 +346,87 @@ QImage Spectrogram::renderAudioScope(uint, const audioShortVector &audioFrame, c
         }
 #endif
 
-        // Limit the maximum history size to avoid wasting space
-        while (m_fftHistory.size() > SPECTROGRAM_HISTORY_SIZE) {
-            m_fftHistory.removeLast();
+        const int w = m_innerScopeRect.width();
+        const int h = m_innerScopeRect.height();
+        const int leftDist = m_innerScopeRect.left() - m_scopeRect.left();
+        const int topDist = m_innerScopeRect.top() - m_scopeRect.top();
+
+        if (m_rows.width() != w || m_rows.height() != h || m_rowsFreqMax != m_freqMax || m_rowsFreq != m_freq) {
+            m_parameterChanged = true;
+        }
+        if (m_parameterChanged) {
+            // Size or scale changed, colorize all the stored history again
+            m_parameterChanged = false;
+            m_rows = QImage(w, h, QImage::Format_ARGB32);
+            m_rows.fill(qRgba(0, 0, 0, 0));
+            m_rowsFreqMax = m_freqMax;
+            m_rowsFreq = m_freq;
+            const int count = qMin(m_historyCount, h);
+            // Oldest first, so that the newest row ends at m_rowHead
+            for (int i = count - 1; i >= 0; --i) {
+                m_rowHead = (count - 1 - i) % h;
+                renderRow(historyAt(i), m_rowHead);
+            }
+            if (count == 0) {
+                m_rowHead = h - 1;
+            }
+        } else if (newDataAvailable && m_historyCount > 0) {
+            // Only the new line is computed, scrolling just moves the ring position
+            m_rowHead = (m_rowHead + 1) % h;
+            renderRow(historyAt(0), m_rowHead);
         }
 
-        // Draw the spectrum
+        // Compose the ring: rows after the head are the oldest ones and go to the top
         QImage spectrum(m_scopeRect.size(), QImage::Format_ARGB32);
         spectrum.fill(qRgba(0, 0, 0, 0));
         QPainter davinci(&spectrum);
-        const uint h = m_innerScopeRect.height();
-        const uint leftDist = m_innerScopeRect.left() - m_scopeRect.left();
-        const uint topDist = m_innerScopeRect.top() - m_scopeRect.top();
-        uint windowSize;
-        uint y;
-        bool completeRedraw = true;
-
-        if (m_fftHistoryImg.size() == m_scopeRect.size() && !m_parameterChanged) {
-            // The size of the widget and the parameters (like min/max dB) have not changed since last time,
-            // so we can re-use it, shift it by one pixel, and render the single remaining line. Usually about
-            // 10 times faster for a widget height of around 400 px.
-            if (newDataAvailable) {
-                davinci.drawImage(0, -1, m_fftHistoryImg);
-            } else {
-                // spectrum = m_fftHistoryImg does NOT work, leads to segfaults (anyone knows why, please tell me)
-                davinci.drawImage(0, 0, m_fftHistoryImg);
-            }
-            completeRedraw = false;
-        }
-
-        y = 0;
-        if ((newData != 0) || m_parameterChanged) {
-            m_parameterChanged = false;
-            bool peak = false;
-
-            QVector<float> dbMap;
-            uint right;
-            ////////////////FIXME
-            for (QList<QVector<float>>::iterator it = m_fftHistory.begin(); it != m_fftHistory.end(); ++it) {
-
-                windowSize = (*it).size();
-
-                // Interpolate the frequency data to match the pixel coordinates
-                right = ((float)m_freqMax) / (m_freq / 2) * (windowSize - 1);
-                dbMap = FFTTools::interpolatePeakPreserving((*it), m_innerScopeRect.width(), 0, right, -180);
-
-                for (int i = 0; i < dbMap.size(); ++i) {
-                    float val;
-                    val = dbMap[i];
-                    peak = val > m_dBmax;
-
-                    // Normalize dB value to [0 1], 1 corresponding to dbMax dB and 0 to dbMin dB
-                    val = (val - m_dBmax) / (m_dBmax - m_dBmin) + 1;
-                    if (val < 0) {
-                        val = 0;
-                    } else if (val > 1) {
-                        val = 1;
-                    }
-                    if (!peak || !m_aHighlightPeaks->isChecked()) {
-                        spectrum.setPixel(leftDist + i, topDist + h - 1 - y, m_colorMap[(int)(val * 255)]);
-                    } else {
-                        spectrum.setPixel(leftDist + i, topDist + h - 1 - y, AbstractScopeWidget::colHighlightDark.rgba());
-                    }
-                }
-
-                y++;
-                if (y >= topDist + m_innerScopeRect.height()) {
-                    break;
-                }
-                if (!completeRedraw) {
-                    break;
-                }
-            }
+        const int older = h - 1 - m_rowHead;
+        if (older > 0) {
+            davinci.drawImage(QPoint(leftDist, topDist), m_rows, QRect(0, m_rowHead + 1, w, older));
         }
+        davinci.drawImage(QPoint(leftDist, topDist + older), m_rows, QRect(0, 0, w, m_rowHead + 1));
+        davinci.end();
 
 #ifdef DEBUG_SPECTROGRAM
-        qCDebug(KDENLIVE_LOG) << "Rendered " << y - topDist << "lines from " << m_fftHistory.size() << " available samples in " << start.elapsed() << " ms"
-                              << (completeRedraw ? "" : " (re-used old image)");
-        uint storedBytes = 0;
-        for (QList<QVector<float>>::iterator it = m_fftHistory.begin(); it != m_fftHistory.end(); ++it) {
-            storedBytes += (*it).size() * sizeof((*it)[0]);
-        }
-        qCDebug(KDENLIVE_LOG) << QString("Total storage used: %1 kB").arg((double)storedBytes / 1000, 0, 'f', 2);
+        qCDebug(KDENLIVE_LOG) << "Rendered spectrogram from " << m_historyCount << " available samples in " << start.elapsed() << " ms";
 #endif
 
-        m_fftHistoryImg = spectrum;
-
         emit signalScopeRenderingFinished(start.elapsed(), 1);
         return spectrum;
     }
     emit signalScopeRenderingFinished(0, 1);
     return QImage();
 }
+const QVector<float> &Spectrogram::historyAt(int age) const
+{
+    return m_fftHistory[(m_historyHead - age + SPECTROGRAM_HISTORY_SIZE) % SPECTROGRAM_HISTORY_SIZE];
+}
+
+void Spectrogram::renderRow(const QVector<float> &spectrum, int row)
+{
+    const int w = m_rows.width();
+    auto *line = reinterpret_cast<QRgb *>(m_rows.scanLine(row));
+    if (spectrum.size() < 2) {
+        std::fill(line, line + w, qRgba(0, 0, 0, 0));
+        return;
+    }
+    // Interpolate the frequency data to match the pixel coordinates
+    const uint right = ((float)m_freqMax) / (m_freq / 2) * (spectrum.size() - 1);
+    const QVector<float> dbMap = FFTTools::interpolatePeakPreserving(spectrum, (uint)w, 0, right, -180);
+    const bool highlightPeaks = m_aHighlightPeaks->isChecked();
+    const float range = m_dBmax - m_dBmin;
+    for (int i = 0; i < w; ++i) {
+        const float db = dbMap[i];
+        if (highlightPeaks && db > m_dBmax) {
+            line[i] = AbstractScopeWidget::colHighlightDark.rgba();
+            continue;
+        }
+        // Normalize dB value to [0 1], 1 corresponding to dbMax dB and 0 to dbMin dB
+        const float val = qBound(0.f, (db - m_dBmax) / range + 1, 1.f);
+        line[i] = m_colorMap[(int)(val * 255)];
+    }
+}
+
 QImage Spectrogram::renderBackground(uint)
 {
     return QImage();
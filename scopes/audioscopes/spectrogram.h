@@ -12,8 +12,9 @@
     over time. See http://en.wikipedia.org/wiki/Spectrogram.
 
     The Spectrogram makes use of two caches:
-    * A cached image where only the most recent line needs to be appended instead of
-      having to recalculate the whole image. A typical speedup factor is 10x.
+    * A ring of colorized rows where only the most recent line needs to be computed
+      instead of having to recalculate the whole image. Scrolling only moves the ring
+      position, so the cost of a new frame does not depend on the scope height.
     * A FFT cache storing a history of previous spectral power distributions (i.e.
       the Fourier-transformed audio signals). This is used if the user adjusts parameters
       like the maximum frequency to display or minimum/maximum signal strength in dB.
@@ -44,7 +45,7 @@ protected:
     ///// Implemented methods /////
     QRect scopeRect() override;
     QImage renderHUD(uint accelerationFactor) override;
-    QImage renderAudioScope(uint accelerationFactor, const audioShortVector &audioFrame, const int freq, const int num_channels, const int num_samples,
+    QImage renderAudioScope(uint accelerationFactor, const AudioBlock &audioFrame, const int freq, const int num_channels, const int num_samples,
                             const int newData) override;
     QImage renderBackground(uint accelerationFactor) override;
     bool isHUDDependingOnInput() const override;
@@ -58,13 +59,22 @@ protected:
 private:
     Ui::Spectrogram_UI *ui;
     FFTTools m_fftTools;
+    QVector<QVector<float>> m_channelSpectra;
     QAction *m_aResetHz;
     QAction *m_aGrid;
     QAction *m_aTrackMouse;
     QAction *m_aHighlightPeaks;
 
-    QList<QVector<float>> m_fftHistory;
-    QImage m_fftHistoryImg;
+    /** Ring of the last spectra, the newest at m_historyHead */
+    QVector<QVector<float>> m_fftHistory;
+    int m_historyHead;
+    int m_historyCount;
+    /** Ring of colorized rows, one per history entry. The newest row is at m_rowHead,
+        scrolling only moves this position so every new spectrum costs a single row. */
+    QImage m_rows;
+    int m_rowHead;
+    int m_rowsFreqMax;
+    int m_rowsFreq;
 
     int m_dBmin;
     int m_dBmax;
@@ -77,6 +87,11 @@ private:
     QRect m_innerScopeRect;
     QRgb m_colorMap[256];
 
+    /** Spectrum received \a age updates ago, 0 being the newest */
+    const QVector<float> &historyAt(int age) const;
+    /** Colorizes a spectrum into one row of m_rows */
+    void renderRow(const QVector<float> &spectrum, int row);
+
 private slots:
     void slotResetMaxFreq();
 };
@@ -22,15 +22,35 @@
 
 AbstractGfxScopeWidget::AbstractGfxScopeWidget(bool trackMouse, QWidget *parent)
     : AbstractScopeWidget(trackMouse, parent)
+    , m_analyzer(std::make_shared<ScopeAnalyzer>())
 {
 }
 
-AbstractGfxScopeWidget::~AbstractGfxScopeWidget() = default;
+AbstractGfxScopeWidget::~AbstractGfxScopeWidget()
+{
+    m_analyzer->removeClient(this);
+}
+
+void AbstractGfxScopeWidget::setAnalyzer(const std::shared_ptr<ScopeAnalyzer> &analyzer)
+{
+    QMutexLocker lock(&m_mutex);
+    m_analyzer->removeClient(this);
+    m_analyzer = analyzer;
+}
+
+std::shared_ptr<const ScopeAnalyzer::Analysis> AbstractGfxScopeWidget::analyseFrame(const ScopeAnalyzer::Request &request, const ScopeFrame &frame)
+{
+    // Called from renderGfxScope(), m_mutex is already locked
+    return m_analyzer->analyse(this, request, frame);
+}
 
 QImage AbstractGfxScopeWidget::renderScope(uint accelerationFactor)
 {
+    m_frameMutex.lock();
+    const ScopeFrame frame = m_scopeImage;
+    m_frameMutex.unlock();
     QMutexLocker lock(&m_mutex);
-    return renderGfxScope(accelerationFactor, m_scopeImage);
+    return renderGfxScope(accelerationFactor, frame);
 }
 
 void AbstractGfxScopeWidget::mouseReleaseEvent(QMouseEvent *event)
@@ -41,10 +61,11 @@ void AbstractGfxScopeWidget::mouseReleaseEvent(QMouseEvent *event)
 
 ///// Slots /////
 
-void AbstractGfxScopeWidget::slotRenderZoneUpdated(const QImage &frame)
+void AbstractGfxScopeWidget::slotRenderZoneUpdated(const ScopeFrame &frame)
 {
-    QMutexLocker lock(&m_mutex);
+    m_frameMutex.lock();
     m_scopeImage = frame;
+    m_frameMutex.unlock();
     AbstractScopeWidget::slotRenderZoneUpdated();
 }
 
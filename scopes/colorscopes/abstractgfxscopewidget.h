@@ -16,6 +16,10 @@
 #include <QtCore>
 
 #include "../abstractscopewidget.h"
+#include "monitor/scopes/scopeframe.h"
+#include "scopeanalyzer.h"
+
+#include <memory>
 
 /**
 \brief Abstract class for scopes analyzing image frames.
@@ -27,28 +31,38 @@ class AbstractGfxScopeWidget : public AbstractScopeWidget
 public:
     explicit AbstractGfxScopeWidget(bool trackMouse = false, QWidget *parent = nullptr);
     virtual ~AbstractGfxScopeWidget(); // Must be virtual because of inheritance, to avoid memory leaks
+    /** @brief Shares the analysis of the frames with the other color scopes. */
+    void setAnalyzer(const std::shared_ptr<ScopeAnalyzer> &analyzer);
 
 protected:
     ///// Variables /////
 
     /** @brief Scope renderer. Must emit signalScopeRenderingFinished()
         when calculation has finished, to allow multi-threading.
-        accelerationFactor hints how much faster than usual the calculation should be accomplished, if possible. */
-    virtual QImage renderGfxScope(uint accelerationFactor, const QImage &) = 0;
+        accelerationFactor hints how much faster than usual the calculation should be accomplished, if possible.
+        The frame is a YUV view of the monitor frame, it can be read without further conversion. */
+    virtual QImage renderGfxScope(uint accelerationFactor, const ScopeFrame &) = 0;
 
     QImage renderScope(uint accelerationFactor) override;
 
+    /** @brief Returns the distributions of the frame described by request.
+        The frame is only read once for all the scopes sharing the analyzer. */
+    std::shared_ptr<const ScopeAnalyzer::Analysis> analyseFrame(const ScopeAnalyzer::Request &request, const ScopeFrame &frame);
+
     void mouseReleaseEvent(QMouseEvent *) override;
 
 private:
-    QImage m_scopeImage;
+    /** The newest frame received, guarded by its own mutex so that a running render never blocks its update. */
+    ScopeFrame m_scopeImage;
+    QMutex m_frameMutex;
     QMutex m_mutex;
+    std::shared_ptr<ScopeAnalyzer> m_analyzer;
 
 public slots:
     /** @brief Must be called when the active monitor has shown a new frame.
       This slot must be connected in the implementing class, it is *not*
       done in this abstract class. */
-    void slotRenderZoneUpdated(const QImage &);
+    void slotRenderZoneUpdated(const ScopeFrame &);
 
 protected slots:
     virtual void slotAutoRefreshToggled(bool autoRefresh);
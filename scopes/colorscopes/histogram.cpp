@@ -122,7 +122,7 @@ QImage Histogram::renderHUD(uint)
     emit signalHUDRenderingFinished(0, 1);
     return QImage();
 }
-QImage Histogram::renderGfxScope(uint accelFactor, const QImage &qimage)
+QImage Histogram::renderGfxScope(uint accelFactor, const ScopeFrame &frame)
 {
     QTime start = QTime::currentTime();
     start.start();
@@ -131,9 +131,18 @@ QImage Histogram::renderGfxScope(uint accelFactor, const QImage &qimage)
         (ui->cbR->isChecked() ? 1 : 0) * HistogramGenerator::ComponentR | (ui->cbG->isChecked() ? 1 : 0) * HistogramGenerator::ComponentG |
         (ui->cbB->isChecked() ? 1 : 0) * HistogramGenerator::ComponentB;
 
-    HistogramGenerator::Rec rec = m_aRec601->isChecked() ? HistogramGenerator::Rec_601 : HistogramGenerator::Rec_709;
-
-    QImage histogram = m_histogramGenerator->calculateHistogram(m_scopeRect.size(), qimage, componentFlags, rec, m_aUnscaled->isChecked(), accelFactor);
+    // The histogram is a distribution with a single column, summed from the waveform or parade ones if they are shown
+    ScopeAnalyzer::Request request;
+    request.lumaColumns = (componentFlags & HistogramGenerator::ComponentY) != 0 ? 1 : 0;
+    request.lumaSpace = m_aRec601->isChecked() ? ScopeFrame::Rec601 : ScopeFrame::Rec709;
+    request.rgbColumns = (componentFlags & ~HistogramGenerator::ComponentY) != 0 ? 1 : 0;
+    request.accelFactor = accelFactor;
+    std::shared_ptr<const ScopeAnalyzer::Analysis> analysis = analyseFrame(request, frame);
+    QImage histogram;
+    if (analysis) {
+        histogram = m_histogramGenerator->calculateHistogram(m_scopeRect.size(), analysis->findLuma(request.lumaSpace, 1), analysis->findRgb(1), componentFlags,
+                                                             m_aUnscaled->isChecked());
+    }
 
     emit signalScopeRenderingFinished(start.elapsed(), accelFactor);
     return histogram;
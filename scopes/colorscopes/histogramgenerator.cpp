@@ -18,18 +18,18 @@
 
 HistogramGenerator::HistogramGenerator() = default;
 
-QImage HistogramGenerator::calculateHistogram(const QSize &paradeSize, const QImage &image, const int &components, HistogramGenerator::Rec rec, bool unscaled,
-                                              uint accelFactor) const
+QImage HistogramGenerator::calculateHistogram(const QSize &paradeSize, const ScopeAnalyzer::Columns *luma, const ScopeAnalyzer::RgbColumns *rgb,
+                                              const int &components, bool unscaled) const
 {
-    if (paradeSize.height() <= 0 || paradeSize.width() <= 0 || image.width() <= 0 || image.height() <= 0) {
+    if (paradeSize.height() <= 0 || paradeSize.width() <= 0 || (luma == nullptr && rgb == nullptr)) {
         return QImage();
     }
 
-    bool drawY = (components & HistogramGenerator::ComponentY) != 0;
-    bool drawR = (components & HistogramGenerator::ComponentR) != 0;
-    bool drawG = (components & HistogramGenerator::ComponentG) != 0;
-    bool drawB = (components & HistogramGenerator::ComponentB) != 0;
-    bool drawSum = (components & HistogramGenerator::ComponentSum) != 0;
+    bool drawY = luma != nullptr && (components & HistogramGenerator::ComponentY) != 0;
+    bool drawR = rgb != nullptr && (components & HistogramGenerator::ComponentR) != 0;
+    bool drawG = rgb != nullptr && (components & HistogramGenerator::ComponentG) != 0;
+    bool drawB = rgb != nullptr && (components & HistogramGenerator::ComponentB) != 0;
+    bool drawSum = rgb != nullptr && (components & HistogramGenerator::ComponentSum) != 0;
 
     int r[256], g[256], b[256], y[256], s[766];
     // Initialize the values to zero
@@ -39,35 +39,29 @@ QImage HistogramGenerator::calculateHistogram(const QSize &paradeSize, const QIm
     std::fill(y, y + 256, 0);
     std::fill(s, s + 766, 0);
 
-    const uint iw = image.bytesPerLine();
-    const uint ih = image.height();
     const uint ww = paradeSize.width();
     const uint wh = paradeSize.height();
-    const uint byteCount = iw * ih;
-
-    // Read the stats from the input image
-    for (int Y = 0; Y < image.height(); ++Y) {
-        for (int X = 0; X < image.width(); X += accelFactor) {
-            QRgb col = image.pixel(X, Y);
-            r[qRed(col)]++;
-            g[qGreen(col)]++;
-            b[qBlue(col)]++;
-            if (drawY) {
-                // Use if branch to avoid expensive multiplication if Y disabled
-                if (rec == HistogramGenerator::Rec_601) {
-                    y[(int)floor(.299 * qRed(col) + .587 * qGreen(col) + .114 * qBlue(col))]++;
-                } else {
-                    y[(int)floor(.2125 * qRed(col) + .7154 * qGreen(col) + .0721 * qBlue(col))]++;
-                }
-            }
-            if (drawSum) {
-                // Use an if branch here because the sum takes more operations than rgb
-                s[qRed(col)]++;
-                s[qGreen(col)]++;
-                s[qBlue(col)]++;
-            }
+
+    // The analysis holds the stats of the frame
+    uint samples = 0;
+    if (luma != nullptr) {
+        std::copy(luma->column(0), luma->column(0) + 256, y);
+        samples = luma->samples;
+    }
+    if (rgb != nullptr) {
+        std::copy(rgb->red.column(0), rgb->red.column(0) + 256, r);
+        std::copy(rgb->green.column(0), rgb->green.column(0) + 256, g);
+        std::copy(rgb->blue.column(0), rgb->blue.column(0) + 256, b);
+        samples = rgb->red.samples;
+    }
+    if (drawSum) {
+        // Every component value is counted once in the sum
+        for (int i = 0; i < 256; ++i) {
+            s[i] = r[i] + g[i] + b[i];
         }
     }
+    // Same scale as for the 4 bytes per pixel RGB images used before
+    const uint byteCount = samples * 4;
 
     const int nParts = (drawY ? 1 : 0) + (drawR ? 1 : 0) + (drawG ? 1 : 0) + (drawB ? 1 : 0) + (drawSum ? 1 : 0);
     if (nParts == 0) {
@@ -13,6 +13,8 @@
 
 #include <QObject>
 
+#include "scopeanalyzer.h"
+
 class QColor;
 class QImage;
 class QPainter;
@@ -25,16 +27,13 @@ class HistogramGenerator : public QObject
 public:
     explicit HistogramGenerator();
 
-    /** Recommendation to use.
-        See http://www.poynton.com/ColorFAQ.html for details. */
-    enum Rec { Rec_601, Rec_709 };
-
     /**
-        Calculates a histogram display from the input image.
-        components are OR-ed HistogramGenerator::Components flags and decide with components (Y, R, G, B) to paint.
+        Calculates a histogram display from the single column luma and RGB distributions of the frame.
+        components are OR-ed HistogramGenerator::Components flags and decide with components (Y, R, G, B) to paint,
+        luma is needed for Y and rgb for the others.
         unscaled = true leaves the width at 256 if the widget is wider (to avoid scaling). */
-    QImage calculateHistogram(const QSize &paradeSize, const QImage &image, const int &components, const HistogramGenerator::Rec rec, bool unscaled,
-                              uint accelFactor = 1) const;
+    QImage calculateHistogram(const QSize &paradeSize, const ScopeAnalyzer::Columns *luma, const ScopeAnalyzer::RgbColumns *rgb, const int &components,
+                              bool unscaled) const;
 
     QImage drawComponent(const int *y, const QSize &size, const float &scaling, const QColor &color, bool unscaled, uint max) const;
 
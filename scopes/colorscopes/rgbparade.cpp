@@ -125,14 +125,22 @@ QImage RGBParade::renderHUD(uint)
     return hud;
 }
 
-QImage RGBParade::renderGfxScope(uint accelerationFactor, const QImage &qimage)
+QImage RGBParade::renderGfxScope(uint accelerationFactor, const ScopeFrame &frame)
 {
     QTime start = QTime::currentTime();
     start.start();
 
     int paintmode = ui->paintMode->itemData(ui->paintMode->currentIndex()).toInt();
-    QImage parade = m_rgbParadeGenerator->calculateRGBParade(m_scopeRect.size(), qimage, (RGBParadeGenerator::PaintMode)paintmode, m_aAxis->isChecked(),
-                                                             m_aGradRef->isChecked(), accelerationFactor);
+    ScopeAnalyzer::Request request;
+    request.rgbColumns = (int)RGBParadeGenerator::partWidth(m_scopeRect.size());
+    request.accelFactor = accelerationFactor;
+    std::shared_ptr<const ScopeAnalyzer::Analysis> analysis = analyseFrame(request, frame);
+    const ScopeAnalyzer::RgbColumns *rgb = analysis ? analysis->findRgb(request.rgbColumns) : nullptr;
+    QImage parade;
+    if (rgb != nullptr) {
+        parade = m_rgbParadeGenerator->calculateRGBParade(m_scopeRect.size(), *rgb, (RGBParadeGenerator::PaintMode)paintmode, m_aAxis->isChecked(),
+                                                          m_aGradRef->isChecked());
+    }
     emit signalScopeRenderingFinished(start.elapsed(), accelerationFactor);
     return parade;
 }
@@ -46,7 +46,7 @@ private:
     bool isBackgroundDependingOnInput() const override;
 
     QImage renderHUD(uint accelerationFactor) override;
-    QImage renderGfxScope(uint accelerationFactor, const QImage &) override;
+    QImage renderGfxScope(uint accelerationFactor, const ScopeFrame &) override;
     QImage renderBackground(uint accelerationFactor) override;
 };
 
@@ -23,21 +23,20 @@ const QColor RGBParadeGenerator::colSoft(150, 150, 150, 255);
 const uchar RGBParadeGenerator::distRight(40);
 const uchar RGBParadeGenerator::distBottom(40);
 
-struct StructRGB
-{
-    uint r;
-    uint g;
-    uint b;
-};
-
 RGBParadeGenerator::RGBParadeGenerator() = default;
 
-QImage RGBParadeGenerator::calculateRGBParade(const QSize &paradeSize, const QImage &image, const RGBParadeGenerator::PaintMode paintMode, bool drawAxis,
-                                              bool drawGradientRef, uint accelFactor)
+uint RGBParadeGenerator::partWidth(const QSize &paradeSize)
 {
-    Q_ASSERT(accelFactor >= 1);
+    const uchar offset = 10;
+    const int width = paradeSize.width() - 2 * offset - distRight;
+    return width > 0 ? (uint)width / 3 : 0;
+}
 
-    if (paradeSize.width() <= 0 || paradeSize.height() <= 0 || image.width() <= 0 || image.height() <= 0) {
+QImage RGBParadeGenerator::calculateRGBParade(const QSize &paradeSize, const ScopeAnalyzer::RgbColumns &rgb, const RGBParadeGenerator::PaintMode paintMode,
+                                              bool drawAxis, bool drawGradientRef)
+{
+    const uint partW = partWidth(paradeSize);
+    if (paradeSize.width() <= 0 || paradeSize.height() <= 0 || partW == 0 || (uint)rgb.red.columns != partW || rgb.red.samples == 0) {
         return QImage();
     }
     QImage parade(paradeSize, QImage::Format_ARGB32);
@@ -47,74 +46,38 @@ QImage RGBParadeGenerator::calculateRGBParade(const QSize &paradeSize, const QIm
 
     const uint ww = paradeSize.width();
     const uint wh = paradeSize.height();
-    const uint iw = image.bytesPerLine();
-    const uint ih = image.height();
-    const uint byteCount = iw * ih; // Note that 1 px = 4 B
 
     const uchar offset = 10;
-    const uint partW = (ww - 2 * offset - distRight) / 3;
     const uint partH = wh - distBottom;
 
-    // Statistics
-    uchar minR = 255, minG = 255, minB = 255, maxR = 0, maxG = 0, maxB = 0, r, g, b;
-
     // Number of input pixels that will fall on one scope pixel.
     // Must be a float because the acceleration factor can be high, leading to <1 expected px per px.
-    const float pixelDepth = (float)((byteCount >> 2) / accelFactor) / (partW * 255);
+    const float pixelDepth = (float)rgb.red.samples / (partW * 255);
     const float gain = 255 / (8 * pixelDepth);
-    //        qCDebug(KDENLIVE_LOG) << "Pixel depth: expected " << pixelDepth << "; Gain: using " << gain << " (acceleration: " << accelFactor << "x)";
 
     QImage unscaled(ww - distRight, 256, QImage::Format_ARGB32);
     unscaled.fill(qRgba(0, 0, 0, 0));
 
-    const float wPrediv = (float)(partW - 1) / (iw - 1);
-
-    StructRGB paradeVals[partW][256];
+    // Statistics
+    uchar minR = 255, minG = 255, minB = 255, maxR = 0, maxG = 0, maxB = 0;
     for (uint i = 0; i < partW; ++i) {
+        const uint *red = rgb.red.column((int)i);
+        const uint *green = rgb.green.column((int)i);
+        const uint *blue = rgb.blue.column((int)i);
         for (uint j = 0; j < 256; ++j) {
-            paradeVals[i][j].r = 0;
-            paradeVals[i][j].g = 0;
-            paradeVals[i][j].b = 0;
-        }
-    }
-
-    const uchar *bits = image.bits();
-    const uint stepsize = image.depth() / 8 * accelFactor;
-
-    for (uint i = 0, x = 0; i < byteCount; i += stepsize) {
-        auto *col = (QRgb *)bits;
-        r = qRed(*col);
-        g = qGreen(*col);
-        b = qBlue(*col);
-
-        double dx = x * wPrediv;
-
-        paradeVals[(int)dx][r].r++;
-        paradeVals[(int)dx][g].g++;
-        paradeVals[(int)dx][b].b++;
-
-        if (r < minR) {
-            minR = r;
-        }
-        if (g < minG) {
-            minG = g;
-        }
-        if (b < minB) {
-            minB = b;
-        }
-        if (r > maxR) {
-            maxR = r;
-        }
-        if (g > maxG) {
-            maxG = g;
-        }
-        if (b > maxB) {
-            maxB = b;
+            if (red[j] > 0) {
+                minR = qMin(minR, (uchar)j);
+                maxR = qMax(maxR, (uchar)j);
+            }
+            if (green[j] > 0) {
+                minG = qMin(minG, (uchar)j);
+                maxG = qMax(maxG, (uchar)j);
+            }
+            if (blue[j] > 0) {
+                minB = qMin(minB, (uchar)j);
+                maxB = qMax(maxB, (uchar)j);
+            }
         }
-
-        bits += stepsize;
-        x += stepsize;
-        x %= iw; // Modulo image width, to represent the current x position in the image
     }
 
     const uint offset1 = partW + offset;
@@ -123,18 +86,18 @@ QImage RGBParadeGenerator::calculateRGBParade(const QSize &paradeSize, const QIm
     case PaintMode_RGB:
         for (uint i = 0; i < partW; ++i) {
             for (uint j = 0; j < 256; ++j) {
-                unscaled.setPixel(i, j, qRgba(255, 10, 10, CHOP255(gain * paradeVals[i][j].r)));
-                unscaled.setPixel(i + offset1, j, qRgba(10, 255, 10, CHOP255(gain * paradeVals[i][j].g)));
-                unscaled.setPixel(i + offset2, j, qRgba(10, 10, 255, CHOP255(gain * paradeVals[i][j].b)));
+                unscaled.setPixel(i, j, qRgba(255, 10, 10, CHOP255(gain * rgb.red.column((int)i)[j])));
+                unscaled.setPixel(i + offset1, j, qRgba(10, 255, 10, CHOP255(gain * rgb.green.column((int)i)[j])));
+                unscaled.setPixel(i + offset2, j, qRgba(10, 10, 255, CHOP255(gain * rgb.blue.column((int)i)[j])));
             }
         }
         break;
     default:
         for (uint i = 0; i < partW; ++i) {
             for (uint j = 0; j < 256; ++j) {
-                unscaled.setPixel(i, j, qRgba(255, 255, 255, CHOP255(gain * paradeVals[i][j].r)));
-                unscaled.setPixel(i + offset1, j, qRgba(255, 255, 255, CHOP255(gain * paradeVals[i][j].g)));
-                unscaled.setPixel(i + offset2, j, qRgba(255, 255, 255, CHOP255(gain * paradeVals[i][j].b)));
+                unscaled.setPixel(i, j, qRgba(255, 255, 255, CHOP255(gain * rgb.red.column((int)i)[j])));
+                unscaled.setPixel(i + offset1, j, qRgba(255, 255, 255, CHOP255(gain * rgb.green.column((int)i)[j])));
+                unscaled.setPixel(i + offset2, j, qRgba(255, 255, 255, CHOP255(gain * rgb.blue.column((int)i)[j])));
             }
         }
         break;
@@ -13,6 +13,8 @@
 
 #include <QObject>
 
+#include "scopeanalyzer.h"
+
 class QColor;
 class QImage;
 class QSize;
@@ -23,8 +25,11 @@ public:
     enum PaintMode { PaintMode_RGB, PaintMode_White };
 
     RGBParadeGenerator();
-    QImage calculateRGBParade(const QSize &paradeSize, const QImage &image, const RGBParadeGenerator::PaintMode paintMode, bool drawAxis, bool drawGradientRef,
-                              uint accelFactor = 1);
+    /** Draws the parade from the RGB distributions of the frame, which must have partWidth() columns. */
+    QImage calculateRGBParade(const QSize &paradeSize, const ScopeAnalyzer::RgbColumns &rgb, const RGBParadeGenerator::PaintMode paintMode, bool drawAxis,
+                              bool drawGradientRef);
+    /** Width of the part showing one component. */
+    static uint partWidth(const QSize &paradeSize);
 
     static const QColor colHighlight;
     static const QColor colLight;
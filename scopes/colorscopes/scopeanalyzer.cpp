@@ -0,0 +1,446 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "scopeanalyzer.h"
+
+#include <QMutexLocker>
+#include <QThread>
+#include <QtConcurrent>
+#include <atomic>
+
+namespace {
+// Number of values of an 8 bit component
+const int valueCount = 256;
+
+void initColumns(ScopeAnalyzer::Columns &values, int columns)
+{
+    values.columns = columns;
+    values.bins.assign((size_t)columns * valueCount, 0);
+}
+
+// Offset in the bins of the column of each pixel of a line
+std::vector<uint> columnOffsets(int width, int columns)
+{
+    std::vector<uint> offsets((size_t)width);
+    const float prediv = width > 1 ? (float)(columns - 1) / (width - 1) : 0;
+    for (int x = 0; x < width; ++x) {
+        offsets[x] = (uint)(x * prediv) * valueCount;
+    }
+    return offsets;
+}
+
+// Fills a single column with the sum of all the columns of a wider distribution
+void sumColumns(const ScopeAnalyzer::Columns &source, ScopeAnalyzer::Columns &target)
+{
+    uint *bins = target.bins.data();
+    for (int column = 0; column < source.columns; ++column) {
+        const uint *values = source.column(column);
+        for (int i = 0; i < valueCount; ++i) {
+            bins[i] += values[i];
+        }
+    }
+    target.samples = source.samples;
+}
+
+// Number of sampled lines in a tile, tiles are picked by the worker threads as they become free
+const int tileRows = 32;
+} // namespace
+
+struct ScopeAnalyzer::Pass
+{
+    struct Luma
+    {
+        int target;
+        int line;
+        std::vector<uint> offsets;
+    };
+    struct Rgb
+    {
+        // Red, green and blue are the 3 consecutive targets from this one
+        int target;
+        std::vector<uint> offsets;
+    };
+
+    const ScopeFrame *frame;
+    int width;
+    int accel;
+    bool lumaLines[2];
+    bool rgbLine;
+    std::vector<Luma> luma;
+    std::vector<Rgb> rgb;
+    int chroma = -1;
+    int chromaLuma = -1;
+    // Luma levels, and the illegal luma and gamut counts as 2 consecutive values
+    int levels = -1;
+    int illegal = -1;
+    // Where the distributions are stored in the analysis, and their size
+    std::vector<uint *> targets;
+    std::vector<size_t> sizes;
+};
+
+struct ScopeAnalyzer::Worker
+{
+    // Accumulators of the worker, kept between frames so that they are not reallocated
+    std::vector<std::vector<uint>> storage;
+    // Where each distribution is accumulated, the first worker directly uses the analysis
+    std::vector<uint *> bins;
+    std::vector<uchar> lumaLines[2];
+    std::vector<QRgb> rgbLine;
+    uint rows = 0;
+    uint chromaRows = 0;
+};
+
+const ScopeAnalyzer::Columns *ScopeAnalyzer::Analysis::findLuma(ScopeFrame::ColorSpace space, int columns) const
+{
+    for (const LumaColumns &entry : luma) {
+        if (entry.space == space && entry.values.columns == columns) {
+            return &entry.values;
+        }
+    }
+    return nullptr;
+}
+
+const ScopeAnalyzer::RgbColumns *ScopeAnalyzer::Analysis::findRgb(int columns) const
+{
+    for (const RgbColumns &entry : rgb) {
+        if (entry.red.columns == columns) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+bool ScopeAnalyzer::Analysis::covers(const Request &request) const
+{
+    return accelFactor <= qMax(1u, request.accelFactor) && (request.lumaColumns <= 0 || findLuma(request.lumaSpace, request.lumaColumns) != nullptr) &&
+           (request.rgbColumns <= 0 || findRgb(request.rgbColumns) != nullptr) && (!request.chroma || !chroma.empty()) &&
+           (!request.chromaColors || !chromaColors.empty()) && (!request.legality || !levels.empty());
+}
+
+ScopeAnalyzer::ScopeAnalyzer()
+    : m_frameCount(0)
+{
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
+}
+
+ScopeAnalyzer::~ScopeAnalyzer()
+{
+    m_pool.waitForDone();
+}
+
+std::shared_ptr<const ScopeAnalyzer::Analysis> ScopeAnalyzer::analyse(const void *client, const Request &request, const ScopeFrame &frame)
+{
+    if (!frame.isValid()) {
+        return nullptr;
+    }
+    QMutexLocker lock(&m_mutex);
+    if (frame != m_frame) {
+        m_frame = frame;
+        m_analysis.reset();
+        ++m_frameCount;
+    }
+    Client &entry = m_clients[client];
+    entry.request = request;
+    entry.lastFrame = m_frameCount;
+    if (m_analysis && m_analysis->covers(request)) {
+        return m_analysis;
+    }
+    // Scopes that asked for the current or the previous frame will most likely ask for this one too
+    std::vector<Request> requests;
+    for (const auto &other : m_clients) {
+        if (other.second.lastFrame + 1 >= m_frameCount) {
+            requests.push_back(other.second.request);
+        }
+    }
+    m_analysis = compute(frame, requests);
+    return m_analysis;
+}
+
+void ScopeAnalyzer::removeClient(const void *client)
+{
+    QMutexLocker lock(&m_mutex);
+    m_clients.erase(client);
+}
+
+std::shared_ptr<ScopeAnalyzer::Analysis> ScopeAnalyzer::compute(const ScopeFrame &frame, const std::vector<Request> &requests)
+{
+    auto analysis = std::make_shared<Analysis>();
+    analysis->accelFactor = requests.empty() ? 1 : qMax(1u, requests.front().accelFactor);
+    bool needChroma = false;
+    bool needColors = false;
+    bool needLegality = false;
+    for (const Request &request : requests) {
+        analysis->accelFactor = qMin(analysis->accelFactor, qMax(1u, request.accelFactor));
+        if (request.lumaColumns > 0 && analysis->findLuma(request.lumaSpace, request.lumaColumns) == nullptr) {
+            analysis->luma.push_back(LumaColumns{request.lumaSpace, Columns()});
+            initColumns(analysis->luma.back().values, request.lumaColumns);
+        }
+        if (request.rgbColumns > 0 && analysis->findRgb(request.rgbColumns) == nullptr) {
+            analysis->rgb.emplace_back();
+            initColumns(analysis->rgb.back().red, request.rgbColumns);
+            initColumns(analysis->rgb.back().green, request.rgbColumns);
+            initColumns(analysis->rgb.back().blue, request.rgbColumns);
+        }
+        needChroma = needChroma || request.chroma || request.chromaColors;
+        needColors = needColors || request.chromaColors;
+        needLegality = needLegality || request.legality;
+    }
+
+    const int width = frame.width();
+    const int height = frame.height();
+    Pass pass;
+    pass.frame = &frame;
+    pass.width = width;
+    pass.accel = (int)analysis->accelFactor;
+    pass.lumaLines[0] = pass.lumaLines[1] = false;
+    auto addTarget = [&pass](uint *bins, size_t size) {
+        pass.targets.push_back(bins);
+        pass.sizes.push_back(size);
+        return (int)pass.targets.size() - 1;
+    };
+
+    // Single column distributions are summed from a wider one after the pass when possible
+    std::vector<std::pair<Columns *, const Columns *>> lumaSums;
+    for (LumaColumns &entry : analysis->luma) {
+        const Columns *wider = nullptr;
+        if (entry.values.columns == 1) {
+            for (const LumaColumns &other : analysis->luma) {
+                if (other.space == entry.space && other.values.columns > 1) {
+                    wider = &other.values;
+                    break;
+                }
+            }
+        }
+        if (wider != nullptr) {
+            lumaSums.emplace_back(&entry.values, wider);
+            continue;
+        }
+        const int line = entry.space == ScopeFrame::Rec709 ? 1 : 0;
+        pass.lumaLines[line] = true;
+        const int target = addTarget(entry.values.bins.data(), entry.values.bins.size());
+        pass.luma.push_back(Pass::Luma{target, line, columnOffsets(width, entry.values.columns)});
+    }
+    std::vector<std::pair<RgbColumns *, const RgbColumns *>> rgbSums;
+    const RgbColumns *widestRgb = nullptr;
+    for (const RgbColumns &entry : analysis->rgb) {
+        if (entry.red.columns > 1) {
+            widestRgb = &entry;
+            break;
+        }
+    }
+    for (RgbColumns &entry : analysis->rgb) {
+        if (entry.red.columns == 1 && widestRgb != nullptr) {
+            rgbSums.emplace_back(&entry, widestRgb);
+            continue;
+        }
+        const int target = addTarget(entry.red.bins.data(), entry.red.bins.size());
+        addTarget(entry.green.bins.data(), entry.green.bins.size());
+        addTarget(entry.blue.bins.data(), entry.blue.bins.size());
+        pass.rgb.push_back(Pass::Rgb{target, columnOffsets(width, entry.red.columns)});
+    }
+    pass.rgbLine = !pass.rgb.empty();
+    // Sum of the luma of the pixels of each chroma value
+    std::vector<uint> chromaLuma;
+    if (needChroma) {
+        analysis->chroma.assign(valueCount * valueCount, 0);
+        pass.chroma = addTarget(analysis->chroma.data(), analysis->chroma.size());
+        if (needColors) {
+            chromaLuma.assign(valueCount * valueCount, 0);
+            pass.chromaLuma = addTarget(chromaLuma.data(), chromaLuma.size());
+        }
+    }
+    uint illegal[2] = {0, 0};
+    if (needLegality) {
+        analysis->levels.assign(valueCount, 0);
+        pass.levels = addTarget(analysis->levels.data(), analysis->levels.size());
+        pass.illegal = addTarget(illegal, 2);
+    }
+
+    // The sampled lines are split in tiles. Each worker accumulates the tiles it picks in its own
+    // distributions, which are then added to the ones of the first worker, stored in the analysis.
+    const int sampledRows = (height + pass.accel - 1) / pass.accel;
+    const int tileCount = (sampledRows + tileRows - 1) / tileRows;
+    const int workerCount = qBound(1, m_pool.maxThreadCount(), tileCount);
+    while ((int)m_workers.size() < workerCount) {
+        m_workers.emplace_back(new Worker);
+    }
+    for (int i = 0; i < workerCount; ++i) {
+        Worker &worker = *m_workers[i];
+        worker.storage.resize(pass.targets.size());
+        worker.bins.resize(pass.targets.size());
+        for (size_t target = 0; target < pass.targets.size(); ++target) {
+            if (i == 0) {
+                worker.bins[target] = pass.targets[target];
+            } else {
+                worker.storage[target].assign(pass.sizes[target], 0);
+                worker.bins[target] = worker.storage[target].data();
+            }
+        }
+        for (int line = 0; line < 2; ++line) {
+            worker.lumaLines[line].resize(pass.lumaLines[line] ? (size_t)width : 0);
+        }
+        worker.rgbLine.resize(pass.rgbLine ? (size_t)width : 0);
+        worker.rows = worker.chromaRows = 0;
+    }
+    std::atomic<int> nextTile(0);
+    auto work = [&](Worker *worker) {
+        int tile;
+        while ((tile = nextTile.fetch_add(1)) < tileCount) {
+            analyseRows(pass, *worker, tile * tileRows, qMin(sampledRows, (tile + 1) * tileRows));
+        }
+    };
+    for (int i = 1; i < workerCount; ++i) {
+        QtConcurrent::run(&m_pool, work, m_workers[i].get());
+    }
+    // The calling thread takes its share of the tiles
+    work(m_workers[0].get());
+    m_pool.waitForDone();
+
+    uint rows = 0;
+    uint chromaRows = 0;
+    for (int i = 0; i < workerCount; ++i) {
+        rows += m_workers[i]->rows;
+        chromaRows += m_workers[i]->chromaRows;
+    }
+    if (workerCount > 1) {
+        // Each slice of the distributions is reduced by a different thread
+        auto reduce = [&](int slice) {
+            for (size_t target = 0; target < pass.targets.size(); ++target) {
+                const size_t size = pass.sizes[target];
+                const size_t from = size * (size_t)slice / (size_t)workerCount;
+                const size_t to = size * (size_t)(slice + 1) / (size_t)workerCount;
+                uint *bins = pass.targets[target];
+                for (int i = 1; i < workerCount; ++i) {
+                    const uint *values = m_workers[i]->bins[target];
+                    for (size_t j = from; j < to; ++j) {
+                        bins[j] += values[j];
+                    }
+                }
+            }
+        };
+        for (int slice = 1; slice < workerCount; ++slice) {
+            QtConcurrent::run(&m_pool, reduce, slice);
+        }
+        reduce(0);
+        m_pool.waitForDone();
+    }
+
+    for (LumaColumns &entry : analysis->luma) {
+        entry.values.samples = rows * (uint)width;
+    }
+    for (RgbColumns &entry : analysis->rgb) {
+        entry.red.samples = entry.green.samples = entry.blue.samples = rows * (uint)width;
+    }
+    for (auto &sum : lumaSums) {
+        sumColumns(*sum.second, *sum.first);
+    }
+    for (auto &sum : rgbSums) {
+        sumColumns(sum.second->red, sum.first->red);
+        sumColumns(sum.second->green, sum.first->green);
+        sumColumns(sum.second->blue, sum.first->blue);
+    }
+    analysis->illegalLuma = illegal[0];
+    analysis->illegalGamut = illegal[1];
+    analysis->chromaSamples = chromaRows * (uint)frame.chromaWidth();
+    analysis->chromaScale = frame.chromaScale();
+    if (needColors) {
+        analysis->chromaColors.assign(valueCount * valueCount, 0);
+        for (int index = 0; index < valueCount * valueCount; ++index) {
+            const uint count = analysis->chroma[index];
+            if (count > 0) {
+                analysis->chromaColors[index] = frame.rgb((int)(chromaLuma[index] / count), index / valueCount, index % valueCount);
+            }
+        }
+    }
+    return analysis;
+}
+
+void ScopeAnalyzer::analyseRows(const Pass &pass, Worker &worker, int first, int last)
+{
+    const ScopeFrame &frame = *pass.frame;
+    const int width = pass.width;
+    const int chromaWidth = frame.chromaWidth();
+    // Each line is read once and all the distributions are updated while it is in the cache
+    for (int sample = first; sample < last; ++sample) {
+        const int y = sample * pass.accel;
+        for (int line = 0; line < 2; ++line) {
+            if (pass.lumaLines[line]) {
+                frame.lumaLine(y, line == 1 ? ScopeFrame::Rec709 : ScopeFrame::Rec601, worker.lumaLines[line].data());
+            }
+        }
+        if (pass.rgbLine) {
+            frame.rgbLine(y, worker.rgbLine.data());
+        }
+        for (const Pass::Luma &luma : pass.luma) {
+            uint *bins = worker.bins[luma.target];
+            const uint *offsets = luma.offsets.data();
+            const uchar *values = worker.lumaLines[luma.line].data();
+            for (int x = 0; x < width; ++x) {
+                bins[offsets[x] + values[x]]++;
+            }
+        }
+        for (const Pass::Rgb &rgb : pass.rgb) {
+            uint *red = worker.bins[rgb.target];
+            uint *green = worker.bins[rgb.target + 1];
+            uint *blue = worker.bins[rgb.target + 2];
+            const uint *offsets = rgb.offsets.data();
+            const QRgb *colors = worker.rgbLine.data();
+            for (int x = 0; x < width; ++x) {
+                const QRgb color = colors[x];
+                const uint offset = offsets[x];
+                red[offset + qRed(color)]++;
+                green[offset + qGreen(color)]++;
+                blue[offset + qBlue(color)]++;
+            }
+        }
+        if (pass.levels >= 0) {
+            uint *levels = worker.bins[pass.levels];
+            const uchar *luma = frame.yLine(y);
+            for (int x = 0; x < width; ++x) {
+                levels[luma[x]]++;
+            }
+            uint *illegal = worker.bins[pass.illegal];
+            frame.countIllegal(y, illegal[0], illegal[1]);
+        }
+        // A chroma line is shared by 2 lines, it is read with the first sampled one
+        if (pass.chroma >= 0 && (sample == 0 || y / 2 != (y - pass.accel) / 2)) {
+            const int chromaRow = y / 2;
+            const uchar *u = frame.uLine(chromaRow);
+            const uchar *v = frame.vLine(chromaRow);
+            uint *chroma = worker.bins[pass.chroma];
+            if (pass.chromaLuma < 0) {
+                for (int x = 0; x < chromaWidth; ++x) {
+                    chroma[u[x] * valueCount + v[x]]++;
+                }
+            } else {
+                uint *chromaLuma = worker.bins[pass.chromaLuma];
+                const uchar *luma = frame.yLine(2 * chromaRow);
+                for (int x = 0; x < chromaWidth; ++x) {
+                    const int index = u[x] * valueCount + v[x];
+                    chroma[index]++;
+                    chromaLuma[index] += luma[2 * x];
+                }
+            }
+            worker.chromaRows++;
+        }
+        worker.rows++;
+    }
+}
@@ -0,0 +1,159 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef SCOPEANALYZER_H
+#define SCOPEANALYZER_H
+
+#include "monitor/scopes/scopeframe.h"
+
+#include <QMutex>
+#include <QThreadPool>
+#include <QRgb>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+/*!
+  \class ScopeAnalyzer
+  \brief The ScopeAnalyzer walks a frame once for all the color scopes and fills
+  the distributions they are drawn from.
+
+  \threadsafe
+
+  Each scope describes with a Request which distributions it needs: luma values
+  per column for the waveform, R, G and B values per column for the RGB parade,
+  chroma samples for the vectorscope. The histogram uses the same distributions
+  with a single column.
+
+  The first scope asking for a frame analyses it for all the scopes that asked
+  for one of the last frames, reading every line once and updating all the
+  distributions while it is in the cache. The other scopes then get the shared
+  result and only have to render it. A distribution with a single column is
+  summed from a wider one of the same kind when there is one.
+
+  The lines are analysed in tiles, picked by the threads of a private pool as
+  soon as they are free. Each thread fills its own distributions, which are
+  added together at the end. These per thread buffers are kept between frames.
+*/
+
+class ScopeAnalyzer
+{
+public:
+    struct Request
+    {
+        //! Number of columns of the luma distribution, 0 if not needed
+        int lumaColumns = 0;
+        ScopeFrame::ColorSpace lumaSpace = ScopeFrame::Rec601;
+        //! Number of columns of the R, G and B distributions, 0 if not needed
+        int rgbColumns = 0;
+        //! Distribution of the chroma samples
+        bool chroma = false;
+        //! Average color of the pixels of each chroma value
+        bool chromaColors = false;
+        //! Stored luma levels and pixels out of the broadcast ranges
+        bool legality = false;
+        //! Only one line out of accelFactor is read
+        uint accelFactor = 1;
+    };
+
+    //! Number of samples of each value in each column, column after column.
+    struct Columns
+    {
+        int columns = 0;
+        uint samples = 0;
+        std::vector<uint> bins;
+
+        const uint *column(int index) const { return bins.data() + index * 256; }
+    };
+
+    struct LumaColumns
+    {
+        ScopeFrame::ColorSpace space;
+        Columns values;
+    };
+
+    struct RgbColumns
+    {
+        Columns red;
+        Columns green;
+        Columns blue;
+    };
+
+    struct Analysis
+    {
+        uint accelFactor = 1;
+        std::vector<LumaColumns> luma;
+        std::vector<RgbColumns> rgb;
+        //! Number of samples of each chroma value, at index U * 256 + V
+        std::vector<uint> chroma;
+        //! Average color of each chroma value, if requested
+        std::vector<QRgb> chromaColors;
+        uint chromaSamples = 0;
+        //! Factor converting a chroma value minus 128 to the -0.5 / 0.5 range
+        float chromaScale = 1.0f / 255.0f;
+        //! Number of samples of each luma value as stored in the frame, if legality was requested
+        std::vector<uint> levels;
+        //! Sampled pixels with an illegal luma, or R, G, B component (see ScopeFrame::countIllegal())
+        uint illegalLuma = 0;
+        uint illegalGamut = 0;
+
+        const Columns *findLuma(ScopeFrame::ColorSpace space, int columns) const;
+        const RgbColumns *findRgb(int columns) const;
+        bool covers(const Request &request) const;
+    };
+
+    ScopeAnalyzer();
+    ~ScopeAnalyzer();
+
+    /*!
+      Returns the distributions of \a frame needed by \a client.
+
+      The frame is analysed for all the known clients if \a client is the first one
+      to ask for it, or if the previous analysis does not include its request.
+    */
+    std::shared_ptr<const Analysis> analyse(const void *client, const Request &request, const ScopeFrame &frame);
+
+    //! Forgets the request of a client that is not used anymore.
+    void removeClient(const void *client);
+
+private:
+    struct Client
+    {
+        Request request;
+        quint64 lastFrame;
+    };
+
+    struct Pass;
+    struct Worker;
+
+    std::shared_ptr<Analysis> compute(const ScopeFrame &frame, const std::vector<Request> &requests);
+    static void analyseRows(const Pass &pass, Worker &worker, int first, int last);
+
+    QMutex m_mutex;
+    std::unordered_map<const void *, Client> m_clients;
+    ScopeFrame m_frame;
+    quint64 m_frameCount;
+    std::shared_ptr<const Analysis> m_analysis;
+    QThreadPool m_pool;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+};
+
+#endif // SCOPEANALYZER_H
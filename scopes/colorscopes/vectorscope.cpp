@@ -261,7 +261,7 @@ QImage Vectorscope::renderHUD(uint)
     return hud;
 }
 
-QImage Vectorscope::renderGfxScope(uint accelerationFactor, const QImage &qimage)
+QImage Vectorscope::renderGfxScope(uint accelerationFactor, const ScopeFrame &frame)
 {
     QTime start = QTime::currentTime();
     QImage scope;
@@ -273,8 +273,14 @@ QImage Vectorscope::renderGfxScope(uint accelerationFactor, const QImage &qimage
         VectorscopeGenerator::ColorSpace colorSpace =
             m_aColorSpace_YPbPr->isChecked() ? VectorscopeGenerator::ColorSpace_YPbPr : VectorscopeGenerator::ColorSpace_YUV;
         VectorscopeGenerator::PaintMode paintMode = (VectorscopeGenerator::PaintMode)ui->paintMode->itemData(ui->paintMode->currentIndex()).toInt();
-        scope = m_vectorscopeGenerator->calculateVectorscope(m_scopeRect.size(), qimage, m_gain, paintMode, colorSpace, m_aAxisEnabled->isChecked(),
-                                                             accelerationFactor);
+        ScopeAnalyzer::Request request;
+        request.chroma = true;
+        request.chromaColors = paintMode == VectorscopeGenerator::PaintMode_Original;
+        request.accelFactor = accelerationFactor;
+        std::shared_ptr<const ScopeAnalyzer::Analysis> analysis = analyseFrame(request, frame);
+        if (analysis) {
+            scope = m_vectorscopeGenerator->calculateVectorscope(m_scopeRect.size(), *analysis, m_gain, paintMode, colorSpace, m_aAxisEnabled->isChecked());
+        }
     }
 
     unsigned int mseconds = start.msecsTo(QTime::currentTime());
@@ -108,12 +108,12 @@ QPoint VectorscopeGenerator::mapToCircle(const QSize &targetSize, const QPointF
     return QPoint((targetSize.width() - 1) * (point.x() + 1) / 2, (targetSize.height() - 1) * (1 - (point.y() + 1) / 2));
 }
 
-QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize, const QImage &image, const float &gain,
-                                                  const VectorscopeGenerator::PaintMode &paintMode, const VectorscopeGenerator::ColorSpace &colorSpace, bool,
-                                                  uint accelFactor) const
+QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize, const ScopeAnalyzer::Analysis &analysis, const float &gain,
+                                                  const VectorscopeGenerator::PaintMode &paintMode, const VectorscopeGenerator::ColorSpace &colorSpace, bool) const
 {
-    if (vectorscopeSize.width() <= 0 || vectorscopeSize.height() <= 0 || image.width() <= 0 || image.height() <= 0) {
-        // Invalid size
+    if (vectorscopeSize.width() <= 0 || vectorscopeSize.height() <= 0 || analysis.chroma.empty() || analysis.chromaSamples == 0 ||
+        (paintMode == PaintMode_Original && analysis.chromaColors.empty())) {
+        // Invalid size or no chroma data
         return QImage();
     }
 
@@ -122,40 +122,30 @@ QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize,
     QImage scope = QImage(cw, cw, QImage::Format_ARGB32);
     scope.fill(qRgba(0, 0, 0, 0));
 
-    const uchar *bits = image.bits();
-
     double dy, dr, dg, db, dmax;
     double /*y,*/ u, v;
     QPoint pt;
-    QRgb px;
-
-    const int stepsize = image.depth() / 8 * accelFactor;
-
-    // Just an average for the number of image pixels per scope pixel.
-    // NOTE: byteCount() has to be replaced by (img.bytesPerLine()*img.height()) for Qt 4.5 to compile, see:
-    // http://doc.trolltech.org/4.6/qimage.html#bytesPerLine
-    double avgPxPerPx = (double)image.depth() / 8 * (image.bytesPerLine() * image.height()) / scope.size().width() / scope.size().height() / accelFactor;
-
-    for (int i = 0; i < (image.bytesPerLine() * image.height()); i += stepsize) {
-        auto *col = (QRgb *)bits;
-
-        int r = qRed(*col);
-        int g = qGreen(*col);
-        int b = qBlue(*col);
-
-        switch (colorSpace) {
-        case VectorscopeGenerator::ColorSpace_YUV:
-            //             y = (double)  0.001173 * r +0.002302 * g +0.0004471* b;
-            u = (double)-0.0005781 * r - 0.001135 * g + 0.001713 * b;
-            v = (double)0.002411 * r - 0.002019 * g - 0.0003921 * b;
-            break;
-        case VectorscopeGenerator::ColorSpace_YPbPr:
-        default:
-            //             y = (double)  0.001173 * r +0.002302 * g +0.0004471* b;
-            u = (double)-0.0006671 * r - 0.001299 * g + 0.0019608 * b;
-            v = (double)0.001961 * r - 0.001642 * g - 0.0003189 * b;
-            break;
+    QRgb px, next;
+
+    // The chroma planes directly give Pb and Pr.
+    // Analog YUV only differs by a scale factor on each axis.
+    const double chromaScale = analysis.chromaScale;
+    const double uScale = colorSpace == VectorscopeGenerator::ColorSpace_YUV ? 0.872 * chromaScale : chromaScale;
+    const double vScale = colorSpace == VectorscopeGenerator::ColorSpace_YUV ? 1.230 * chromaScale : chromaScale;
+
+    // Just an average for the number of image pixels per scope pixel,
+    // tuned for one point per pixel of a 32 bit image and kept for one point per chroma sample
+    double avgPxPerPx = 4.0 * analysis.chromaSamples / scope.size().width() / scope.size().height();
+
+    // The analysis counts the samples of each chroma value: each value is mapped once,
+    // the accumulating paint modes then apply the point once per sample.
+    for (int index = 0; index < 256 * 256; ++index) {
+        const uint count = analysis.chroma[index];
+        if (count == 0) {
+            continue;
         }
+        u = uScale * (index / 256 - 128);
+        v = vScale * (index % 256 - 128);
 
         pt = mapToCircle(vectorscopeSize, QPointF(SCALING * gain * u, SCALING * gain * v));
 
@@ -242,27 +232,45 @@ QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize,
                 scope.setPixel(pt, qRgba(dr, dg, db, 255));
                 break;
             case PaintMode_Original:
-                scope.setPixel(pt, *col);
+                scope.setPixel(pt, analysis.chromaColors[index]);
                 break;
             case PaintMode_Green:
                 px = scope.pixel(pt);
-                scope.setPixel(pt, qRgba(qRed(px) + (255 - qRed(px)) / (3 * avgPxPerPx), qGreen(px) + 20 * (255 - qGreen(px)) / (avgPxPerPx),
-                                         qBlue(px) + (255 - qBlue(px)) / (avgPxPerPx), qAlpha(px) + (255 - qAlpha(px)) / (avgPxPerPx)));
+                for (uint n = 0; n < count; ++n) {
+                    next = qRgba(qRed(px) + (255 - qRed(px)) / (3 * avgPxPerPx), qGreen(px) + 20 * (255 - qGreen(px)) / (avgPxPerPx),
+                                 qBlue(px) + (255 - qBlue(px)) / (avgPxPerPx), qAlpha(px) + (255 - qAlpha(px)) / (avgPxPerPx));
+                    if (next == px) {
+                        break;
+                    }
+                    px = next;
+                }
+                scope.setPixel(pt, px);
                 break;
             case PaintMode_Green2:
                 px = scope.pixel(pt);
-                scope.setPixel(pt,
-                               qRgba(qRed(px) + ceil((255 - (float)qRed(px)) / (4 * avgPxPerPx)), 255,
-                                     qBlue(px) + ceil((255 - (float)qBlue(px)) / (avgPxPerPx)), qAlpha(px) + ceil((255 - (float)qAlpha(px)) / (avgPxPerPx))));
+                for (uint n = 0; n < count; ++n) {
+                    next = qRgba(qRed(px) + ceil((255 - (float)qRed(px)) / (4 * avgPxPerPx)), 255, qBlue(px) + ceil((255 - (float)qBlue(px)) / (avgPxPerPx)),
+                                 qAlpha(px) + ceil((255 - (float)qAlpha(px)) / (avgPxPerPx)));
+                    if (next == px) {
+                        break;
+                    }
+                    px = next;
+                }
+                scope.setPixel(pt, px);
                 break;
             case PaintMode_Black:
                 px = scope.pixel(pt);
-                scope.setPixel(pt, qRgba(0, 0, 0, qAlpha(px) + (255 - qAlpha(px)) / 20));
+                for (uint n = 0; n < count; ++n) {
+                    next = qRgba(0, 0, 0, qAlpha(px) + (255 - qAlpha(px)) / 20);
+                    if (next == px) {
+                        break;
+                    }
+                    px = next;
+                }
+                scope.setPixel(pt, px);
                 break;
             }
         }
-
-        bits += stepsize;
     }
     return scope;
 }
@@ -14,6 +14,8 @@
 #include <QImage>
 #include <QObject>
 
+#include "scopeanalyzer.h"
+
 class QImage;
 class QPoint;
 class QPointF;
@@ -27,8 +29,9 @@ public:
     enum ColorSpace { ColorSpace_YUV, ColorSpace_YPbPr };
     enum PaintMode { PaintMode_Green, PaintMode_Green2, PaintMode_Original, PaintMode_Chroma, PaintMode_YUV, PaintMode_Black };
 
-    QImage calculateVectorscope(const QSize &vectorscopeSize, const QImage &image, const float &gain, const VectorscopeGenerator::PaintMode &paintMode,
-                                const VectorscopeGenerator::ColorSpace &colorSpace, bool, uint accelFactor = 1) const;
+    /** Draws the chroma distribution of the analysis, PaintMode_Original needs the chroma colors. */
+    QImage calculateVectorscope(const QSize &vectorscopeSize, const ScopeAnalyzer::Analysis &analysis, const float &gain,
+                                const VectorscopeGenerator::PaintMode &paintMode, const VectorscopeGenerator::ColorSpace &colorSpace, bool) const;
 
     QPoint mapToCircle(const QSize &targetSize, const QPointF &point) const;
     static const float scaling;
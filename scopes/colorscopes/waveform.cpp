@@ -177,15 +177,23 @@ QImage Waveform::renderHUD(uint)
     return hud;
 }
 
-QImage Waveform::renderGfxScope(uint accelFactor, const QImage &qimage)
+QImage Waveform::renderGfxScope(uint accelFactor, const ScopeFrame &frame)
 {
     QTime start = QTime::currentTime();
     start.start();
 
     const int paintmode = ui->paintMode->itemData(ui->paintMode->currentIndex()).toInt();
-    WaveformGenerator::Rec rec = m_aRec601->isChecked() ? WaveformGenerator::Rec_601 : WaveformGenerator::Rec_709;
-    QImage wave = m_waveformGenerator->calculateWaveform(scopeRect().size() - m_textWidth - QSize(0, m_paddingBottom), qimage,
-                                                         (WaveformGenerator::PaintMode)paintmode, true, rec, accelFactor);
+    const QSize size = scopeRect().size() - m_textWidth - QSize(0, m_paddingBottom);
+    ScopeAnalyzer::Request request;
+    request.lumaColumns = size.width();
+    request.lumaSpace = m_aRec601->isChecked() ? ScopeFrame::Rec601 : ScopeFrame::Rec709;
+    request.accelFactor = accelFactor;
+    std::shared_ptr<const ScopeAnalyzer::Analysis> analysis = analyseFrame(request, frame);
+    const ScopeAnalyzer::Columns *luma = analysis ? analysis->findLuma(request.lumaSpace, request.lumaColumns) : nullptr;
+    QImage wave;
+    if (luma != nullptr) {
+        wave = m_waveformGenerator->calculateWaveform(size, *luma, (WaveformGenerator::PaintMode)paintmode, true);
+    }
 
     emit signalScopeRenderingFinished(start.elapsed(), 1);
     return wave;
@@ -11,6 +11,7 @@
 #include "waveformgenerator.h"
 
 #include <cmath>
+#include <vector>
 
 #include <QImage>
 #include <QPainter>
@@ -23,17 +24,15 @@ WaveformGenerator::WaveformGenerator() = default;
 
 WaveformGenerator::~WaveformGenerator() = default;
 
-QImage WaveformGenerator::calculateWaveform(const QSize &waveformSize, const QImage &image, WaveformGenerator::PaintMode paintMode, bool drawAxis,
-                                            WaveformGenerator::Rec rec, uint accelFactor)
+QImage WaveformGenerator::calculateWaveform(const QSize &waveformSize, const ScopeAnalyzer::Columns &luma, WaveformGenerator::PaintMode paintMode,
+                                            bool drawAxis)
 {
-    Q_ASSERT(accelFactor >= 1);
-
     // QTime time;
     // time.start();
 
     QImage wave(waveformSize, QImage::Format_ARGB32);
 
-    if (waveformSize.width() <= 0 || waveformSize.height() <= 0 || image.width() <= 0 || image.height() <= 0) {
+    if (waveformSize.width() <= 0 || waveformSize.height() <= 0 || luma.columns != waveformSize.width() || luma.samples == 0) {
         return QImage();
     }
 
@@ -42,59 +41,28 @@ QImage WaveformGenerator::calculateWaveform(const QSize &waveformSize, const QIm
 
     const uint ww = waveformSize.width();
     const uint wh = waveformSize.height();
-    const uint iw = image.bytesPerLine();
-    const uint ih = image.height();
-    const uint byteCount = iw * ih;
-
-    uint waveValues[waveformSize.width()][waveformSize.height()];
-    for (int i = 0; i < waveformSize.width(); ++i) {
-        for (int j = 0; j < waveformSize.height(); ++j) {
-            waveValues[i][j] = 0;
-        }
-    }
+
+    std::vector<uint> waveValues(ww * wh, 0);
 
     // Number of input pixels that will fall on one scope pixel.
     // Must be a float because the acceleration factor can be high, leading to <1 expected px per px.
-    const float pixelDepth = (float)((byteCount >> 2) / accelFactor) / (ww * wh);
+    const float pixelDepth = (float)luma.samples / (ww * wh);
     const float gain = 255 / (8 * pixelDepth);
-    // qCDebug(KDENLIVE_LOG) << "Pixel depth: expected " << pixelDepth << "; Gain: using " << gain << " (acceleration: " << accelFactor << "x)";
 
     // Subtract 1 from sizes because we start counting from 0.
     // Not doing it would result in attempts to paint outside of the image.
     const float hPrediv = (float)(wh - 1) / 255;
-    const float wPrediv = (float)(ww - 1) / (iw - 1);
-
-    const uchar *bits = image.bits();
-    const int bpp = image.depth() / 8;
-
-    for (uint i = 0, x = 0; i < byteCount; i += bpp) {
 
-        Q_ASSERT(bits < image.bits() + byteCount);
-
-        double dY, dx, dy;
-        auto *col = (QRgb *)bits;
-
-        if (rec == WaveformGenerator::Rec_601) {
-            // CIE 601 Luminance
-            dY = .299 * qRed(*col) + .587 * qGreen(*col) + .114 * qBlue(*col);
-        } else {
-            // CIE 709 Luminance
-            dY = .2125 * qRed(*col) + .7154 * qGreen(*col) + .0721 * qBlue(*col);
-        }
-        // dY is on [0,255] now.
-
-        dy = dY * hPrediv;
-        dx = x * wPrediv;
-        waveValues[(int)dx][(int)dy]++;
-
-        bits += bpp;
-        x += bpp;
-        if (x > iw) {
-            x -= iw;
-            if (accelFactor > 1) {
-                bits += bpp * iw * (accelFactor - 1);
-                i += bpp * iw * (accelFactor - 1);
-            }
+    // The analysis already holds the luma values of each scope column, they only have to be spread on the scope rows
+    uint rows[256];
+    for (uint i = 0; i < 256; ++i) {
+        rows[i] = (uint)(i * hPrediv);
+    }
+    for (uint i = 0; i < ww; ++i) {
+        const uint *values = luma.column((int)i);
+        uint *column = &waveValues[i * wh];
+        for (uint j = 0; j < 256; ++j) {
+            column[rows[j]] += values[j];
         }
     }
 
@@ -104,22 +72,22 @@ QImage WaveformGenerator::calculateWaveform(const QSize &waveformSize, const QIm
             for (int j = 0; j < waveformSize.height(); ++j) {
                 // Logarithmic scale. Needs fine tuning by hand, but looks great.
                 wave.setPixel(i, waveformSize.height() - j - 1,
-                              qRgba(CHOP255(52 * log(0.1 * gain * waveValues[i][j])), CHOP255(52 * log(gain * waveValues[i][j])),
-                                    CHOP255(52 * log(.25 * gain * waveValues[i][j])), CHOP255(64 * log(gain * waveValues[i][j]))));
+                              qRgba(CHOP255(52 * log(0.1 * gain * waveValues[i * wh + j])), CHOP255(52 * log(gain * waveValues[i * wh + j])),
+                                    CHOP255(52 * log(.25 * gain * waveValues[i * wh + j])), CHOP255(64 * log(gain * waveValues[i * wh + j]))));
             }
         }
         break;
     case PaintMode_Yellow:
         for (int i = 0; i < waveformSize.width(); ++i) {
             for (int j = 0; j < waveformSize.height(); ++j) {
-                wave.setPixel(i, waveformSize.height() - j - 1, qRgba(255, 242, 0, CHOP255(gain * waveValues[i][j])));
+                wave.setPixel(i, waveformSize.height() - j - 1, qRgba(255, 242, 0, CHOP255(gain * waveValues[i * wh + j])));
             }
         }
         break;
     default:
         for (int i = 0; i < waveformSize.width(); ++i) {
             for (int j = 0; j < waveformSize.height(); ++j) {
-                wave.setPixel(i, waveformSize.height() - j - 1, qRgba(255, 255, 255, CHOP255(2 * gain * waveValues[i][j])));
+                wave.setPixel(i, waveformSize.height() - j - 1, qRgba(255, 255, 255, CHOP255(2 * gain * waveValues[i * wh + j])));
             }
         }
         break;
@@ -12,6 +12,9 @@
 #define WAVEFORMGENERATOR_H
 
 #include <QObject>
+
+#include "scopeanalyzer.h"
+
 class QImage;
 class QSize;
 
@@ -21,13 +24,12 @@ class WaveformGenerator : public QObject
 
 public:
     enum PaintMode { PaintMode_Green, PaintMode_Yellow, PaintMode_White };
-    enum Rec { Rec_601, Rec_709 };
 
     WaveformGenerator();
     ~WaveformGenerator();
 
-    QImage calculateWaveform(const QSize &waveformSize, const QImage &image, WaveformGenerator::PaintMode paintMode, bool drawAxis,
-                             const WaveformGenerator::Rec rec, uint accelFactor = 1);
+    /** Draws the waveform from the luma distribution of the frame, which must have one column per scope column. */
+    QImage calculateWaveform(const QSize &waveformSize, const ScopeAnalyzer::Columns &luma, WaveformGenerator::PaintMode paintMode, bool drawAxis);
 };
 
 #endif // WAVEFORMGENERATOR_H
@@ -0,0 +1,179 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "legalityreport.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <cmath>
+#include <cstring>
+
+namespace {
+const char reportMagic[4] = {'K', 'D', 'Q', 'C'};
+// Bump when the layout of the file changes, old files are then recomputed
+const quint32 reportVersion = 1;
+// EBU R 103 tolerates signals out of range on 1% of the picture
+const quint32 pixelTolerance = 100;
+// -1 dBFS
+const quint16 peakLimit = 29204;
+
+qint32 toHundredths(double value)
+{
+    return (qint32)std::lround(value * 100);
+}
+} // namespace
+
+static_assert(sizeof(LegalityReport::FrameStats) == 24, "The frame records are stored as is");
+
+LegalityReport::LegalityReport()
+{
+    memset(&m_header, 0, sizeof(Header));
+}
+
+LegalityReport::LegalityReport(int frames, double fps, int in)
+    : LegalityReport()
+{
+    memcpy(m_header.magic, reportMagic, sizeof(reportMagic));
+    m_header.version = reportVersion;
+    m_header.frames = (quint32)qMax(0, frames);
+    m_header.fpsNum = (quint32)std::lround(fps * 1000);
+    m_header.fpsDen = 1000;
+    m_header.in = in;
+    m_header.recordSize = sizeof(FrameStats);
+    m_frames.resize(m_header.frames);
+}
+
+std::shared_ptr<LegalityReport> LegalityReport::load(const QString &path)
+{
+    QFile file(path);
+    if (path.isEmpty() || !file.open(QIODevice::ReadOnly)) {
+        return nullptr;
+    }
+    std::shared_ptr<LegalityReport> report(new LegalityReport());
+    Header &header = report->m_header;
+    if (file.read(reinterpret_cast<char *>(&header), sizeof(Header)) != sizeof(Header) || memcmp(header.magic, reportMagic, sizeof(reportMagic)) != 0 ||
+        header.version != reportVersion || header.recordSize != sizeof(FrameStats) || header.fpsDen == 0) {
+        return nullptr;
+    }
+    const qint64 dataSize = (qint64)header.frames * (qint64)sizeof(FrameStats);
+    if (file.size() < (qint64)sizeof(Header) + dataSize) {
+        return nullptr;
+    }
+    report->m_frames.resize(header.frames);
+    if (file.read(reinterpret_cast<char *>(report->m_frames.data()), dataSize) != dataSize) {
+        return nullptr;
+    }
+    return report;
+}
+
+bool LegalityReport::save(const QString &path) const
+{
+    QSaveFile file(path);
+    if (path.isEmpty() || !file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(reinterpret_cast<const char *>(&m_header), sizeof(Header));
+    file.write(reinterpret_cast<const char *>(m_frames.data()), (qint64)m_frames.size() * (qint64)sizeof(FrameStats));
+    return file.commit();
+}
+
+int LegalityReport::frames() const
+{
+    return (int)m_header.frames;
+}
+
+double LegalityReport::fps() const
+{
+    return (double)m_header.fpsNum / m_header.fpsDen;
+}
+
+int LegalityReport::in() const
+{
+    return m_header.in;
+}
+
+const LegalityReport::FrameStats &LegalityReport::frame(int index) const
+{
+    Q_ASSERT(index >= 0 && index < frames());
+    return m_frames[(size_t)index];
+}
+
+void LegalityReport::setFrame(int index, const FrameStats &stats)
+{
+    Q_ASSERT(index >= 0 && index < frames());
+    m_frames[(size_t)index] = stats;
+}
+
+int LegalityReport::violations(int index) const
+{
+    const FrameStats &stats = frame(index);
+    int result = NoViolation;
+    if (stats.pixels > 0) {
+        if (stats.illegalLuma * pixelTolerance > stats.pixels) {
+            result |= LumaViolation;
+        }
+        if (stats.illegalGamut * pixelTolerance > stats.pixels) {
+            result |= GamutViolation;
+        }
+    }
+    if (stats.audioPeak > peakLimit) {
+        result |= AudioPeakViolation;
+    }
+    return result;
+}
+
+int LegalityReport::violationCount(Violation violation) const
+{
+    int count = 0;
+    for (int i = 0; i < frames(); ++i) {
+        if ((violations(i) & violation) != 0) {
+            count++;
+        }
+    }
+    return count;
+}
+
+LoudnessInfo LegalityReport::loudness() const
+{
+    LoudnessInfo info;
+    info.valid = m_header.loudnessValid != 0;
+    info.integrated = m_header.integrated / 100.;
+    info.range = m_header.range / 100.;
+    info.momentaryMax = m_header.momentaryMax / 100.;
+    info.shortTermMax = m_header.shortTermMax / 100.;
+    info.truePeak = m_header.truePeak / 100.;
+    info.samplePeak = m_header.samplePeak / 100.;
+    return info;
+}
+
+void LegalityReport::setLoudness(const LoudnessInfo &info)
+{
+    m_header.loudnessValid = info.valid ? 1 : 0;
+    if (!info.valid) {
+        return;
+    }
+    m_header.integrated = toHundredths(info.integrated);
+    m_header.range = toHundredths(info.range);
+    m_header.momentaryMax = toHundredths(info.momentaryMax);
+    m_header.shortTermMax = toHundredths(info.shortTermMax);
+    m_header.truePeak = toHundredths(info.truePeak);
+    m_header.samplePeak = toHundredths(info.samplePeak);
+}
@@ -0,0 +1,119 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef LEGALITYREPORT_H
+#define LEGALITYREPORT_H
+
+#include "lib/audio/loudnessMeter.h"
+
+#include <QString>
+#include <QtGlobal>
+#include <memory>
+#include <vector>
+
+/**
+  Broadcast legality analysis of a clip: for each frame, the range of the luma and
+  chroma samples, the number of pixels out of the EBU R 103 ranges and the audio
+  peak and RMS levels, plus the loudness of the whole analysed range.
+
+  The report is stored in a versioned binary file made of a fixed size header
+  followed by one fixed size record per frame (24 bytes, about 2 MB for an hour
+  at 25 fps).
+
+  A frame violates the luma or gamut rule when more than 1% of its pixels are out
+  of range, which is the tolerance of EBU R 103, and the audio rule when its
+  sample peak is above -1 dBFS (the maximum true peak of EBU R 128).
+  */
+class LegalityReport
+{
+public:
+    enum Violation { NoViolation = 0, LumaViolation = 1, GamutViolation = 2, AudioPeakViolation = 4 };
+
+    struct FrameStats
+    {
+        //! Lowest and highest samples, as stored in the frame
+        quint8 lumaMin = 255;
+        quint8 lumaMax = 0;
+        quint8 uMin = 255;
+        quint8 uMax = 0;
+        quint8 vMin = 255;
+        quint8 vMax = 0;
+        //! Audio sample peak and RMS level over all channels, in the 0 - 32767 range
+        quint16 audioPeak = 0;
+        quint16 audioRms = 0;
+        quint16 reserved = 0;
+        //! Number of analysed pixels, 0 if the frame has no image
+        quint32 pixels = 0;
+        quint32 illegalLuma = 0;
+        quint32 illegalGamut = 0;
+    };
+
+    /// Creates an empty report for \a frames frames, starting at frame \a in of the clip.
+    LegalityReport(int frames, double fps, int in = 0);
+
+    /// Reads a report file, returns nullptr if it does not exist or cannot be used.
+    static std::shared_ptr<LegalityReport> load(const QString &path);
+    /// Writes the report to a file.
+    bool save(const QString &path) const;
+
+    int frames() const;
+    double fps() const;
+    /// Position in the clip of the first frame of the report.
+    int in() const;
+
+    const FrameStats &frame(int index) const;
+    void setFrame(int index, const FrameStats &stats);
+    /// Returns the rules violated by a frame, as a combination of Violation flags.
+    int violations(int index) const;
+    /// Number of frames violating each rule.
+    int violationCount(Violation violation) const;
+
+    LoudnessInfo loudness() const;
+    void setLoudness(const LoudnessInfo &info);
+
+private:
+    struct Header
+    {
+        char magic[4];
+        quint32 version;
+        quint32 frames;
+        quint32 fpsNum;
+        quint32 fpsDen;
+        qint32 in;
+        quint32 recordSize;
+        quint32 loudnessValid;
+        // Loudness values in 1/100 LUFS, LU or dB
+        qint32 integrated;
+        qint32 range;
+        qint32 momentaryMax;
+        qint32 shortTermMax;
+        qint32 truePeak;
+        qint32 samplePeak;
+        quint32 reserved[2];
+    };
+
+    LegalityReport();
+
+    Header m_header;
+    std::vector<FrameStats> m_frames;
+};
+
+#endif // LEGALITYREPORT_H
@@ -33,6 +33,7 @@
 ScopeManager::ScopeManager(QObject *parent)
     : QObject(parent)
     , m_lastConnectedRenderer(nullptr)
+    , m_colorAnalyzer(std::make_shared<ScopeAnalyzer>())
 {
     m_signalMapper = new QSignalMapper(this);
 
@@ -99,6 +100,7 @@ bool ScopeManager::addScope(AbstractGfxScopeWidget *colorScope, QDockWidget *col
         GfxScopeData gsd;
         gsd.scope = colorScope;
         m_colorScopes.append(gsd);
+        colorScope->setAnalyzer(m_colorAnalyzer);
 
         connect(colorScope, &AbstractScopeWidget::requestAutoRefresh, this, &ScopeManager::slotCheckActiveScopes);
         connect(colorScope, &AbstractGfxScopeWidget::signalFrameRequest, this, &ScopeManager::slotRequestFrame);
@@ -113,7 +115,7 @@ bool ScopeManager::addScope(AbstractGfxScopeWidget *colorScope, QDockWidget *col
     return added;
 }
 
-void ScopeManager::slotDistributeAudio(const audioShortVector &sampleData, int freq, int num_channels, int num_samples)
+void ScopeManager::slotDistributeAudio(const AudioBlock &sampleData)
 {
 #ifdef DEBUG_SM
     qCDebug(KDENLIVE_LOG) << "ScopeManager: Starting to distribute audio.";
@@ -122,7 +124,7 @@ void ScopeManager::slotDistributeAudio(const audioShortVector &sampleData, int f
         // Distribute audio to all scopes that are visible and want to be refreshed
         if (!m_audioScopes[i].scope->visibleRegion().isEmpty()) {
             if (m_audioScopes[i].scope->autoRefreshEnabled()) {
-                m_audioScopes[i].scope->slotReceiveAudio(sampleData, freq, num_channels, num_samples);
+                m_audioScopes[i].scope->slotReceiveAudio(sampleData);
 #ifdef DEBUG_SM
                 qCDebug(KDENLIVE_LOG) << "ScopeManager: Distributed audio to " << m_audioScopes[i].scope->widgetName();
 #endif
@@ -130,7 +132,12 @@ void ScopeManager::slotDistributeAudio(const audioShortVector &sampleData, int f
         }
     }
 }
-void ScopeManager::slotDistributeFrame(const QImage &image)
+void ScopeManager::slotDistributeImage(const QImage &image)
+{
+    slotDistributeFrame(ScopeFrame(image));
+}
+
+void ScopeManager::slotDistributeFrame(const ScopeFrame &frame)
 {
 #ifdef DEBUG_SM
     qCDebug(KDENLIVE_LOG) << "ScopeManager: Starting to distribute frame.";
@@ -138,7 +145,7 @@ void ScopeManager::slotDistributeFrame(const QImage &image)
     for (int i = 0; i < m_colorScopes.size(); ++i) {
         if (!m_colorScopes[i].scope->visibleRegion().isEmpty()) {
             if (m_colorScopes[i].scope->autoRefreshEnabled()) {
-                m_colorScopes[i].scope->slotRenderZoneUpdated(image);
+                m_colorScopes[i].scope->slotRenderZoneUpdated(frame);
 #ifdef DEBUG_SM
                 qCDebug(KDENLIVE_LOG) << "ScopeManager: Distributed frame to " << m_colorScopes[i].scope->widgetName();
 #endif
@@ -146,7 +153,7 @@ void ScopeManager::slotDistributeFrame(const QImage &image)
                 // Special case: Auto refresh is disabled, but user requested an update (e.g. by clicking).
                 // Force the scope to update.
                 m_colorScopes[i].singleFrameRequested = false;
-                m_colorScopes[i].scope->slotRenderZoneUpdated(image);
+                m_colorScopes[i].scope->slotRenderZoneUpdated(frame);
                 m_colorScopes[i].scope->forceUpdateScope();
 #ifdef DEBUG_SM
                 qCDebug(KDENLIVE_LOG) << "ScopeManager: Distributed forced frame to " << m_colorScopes[i].scope->widgetName();
@@ -214,7 +221,8 @@ void ScopeManager::slotUpdateActiveRenderer()
 
     // Connect new renderer
     if (m_lastConnectedRenderer != nullptr) {
-        connect(m_lastConnectedRenderer, &Monitor::frameUpdated, this, &ScopeManager::slotDistributeFrame, Qt::UniqueConnection);
+        connect(m_lastConnectedRenderer, &Monitor::frameUpdated, this, &ScopeManager::slotDistributeImage, Qt::UniqueConnection);
+        connect(m_lastConnectedRenderer, &Monitor::scopeFrameUpdated, this, &ScopeManager::slotDistributeFrame, Qt::UniqueConnection);
         connect(m_lastConnectedRenderer, &Monitor::audioSamplesSignal, this, &ScopeManager::slotDistributeAudio, Qt::UniqueConnection);
 
 #ifdef DEBUG_SM
@@ -72,6 +72,8 @@ private:
     QList<GfxScopeData> m_colorScopes;
 
     AbstractMonitor *m_lastConnectedRenderer;
+    /** The color scopes share the analysis of each frame */
+    std::shared_ptr<ScopeAnalyzer> m_colorAnalyzer;
 
     QSignalMapper *m_signalMapper;
 
@@ -127,8 +129,10 @@ private slots:
       */
     void checkActiveColourScopes();
 
-    void slotDistributeFrame(const QImage &image);
-    void slotDistributeAudio(const audioShortVector &sampleData, int freq, int num_channels, int num_samples);
+    /** @brief Wraps an RGB image (GPU readback, capture device) for the color scopes. */
+    void slotDistributeImage(const QImage &image);
+    void slotDistributeFrame(const ScopeFrame &frame);
+    void slotDistributeAudio(const AudioBlock &sampleData);
     /**
       Allows a scope to explicitly request a new frame, even if the scope's autoRefresh is disabled.
       */
@@ -0,0 +1,158 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "scopescheduler.h"
+
+#include <QMutexLocker>
+#include <cmath>
+
+namespace {
+// Weight of the last render in the average render times
+const double averageWeight = 0.25;
+// The acceleration is only lowered when the render would still fit in this part of the budget,
+// so that it does not oscillate around the budget
+const double lowerThreshold = 0.75;
+} // namespace
+
+ScopeScheduler::ScopeScheduler(int budget)
+    : m_adaptive(false)
+    , m_newestFrame(0)
+    , m_renderedFrame(0)
+    , m_newestTime(0)
+    , m_renderedTime(0)
+    , m_renderAccel(1)
+    , m_lastDiscarded(false)
+    , m_fullCost(0)
+{
+    m_stats.budget = qMax(1, budget);
+    m_clock.start();
+}
+
+void ScopeScheduler::setBudget(int budget)
+{
+    QMutexLocker lock(&m_mutex);
+    m_stats.budget = qMax(1, budget);
+    adapt();
+}
+
+int ScopeScheduler::budget() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_stats.budget;
+}
+
+void ScopeScheduler::setAdaptive(bool adaptive)
+{
+    QMutexLocker lock(&m_mutex);
+    m_adaptive = adaptive;
+    if (adaptive) {
+        adapt();
+    } else {
+        m_stats.accelFactor = 1;
+    }
+}
+
+void ScopeScheduler::frameReceived()
+{
+    QMutexLocker lock(&m_mutex);
+    m_newestFrame++;
+    m_newestTime = m_clock.elapsed();
+    m_stats.framesReceived++;
+}
+
+void ScopeScheduler::renderStarted(uint accelFactor)
+{
+    QMutexLocker lock(&m_mutex);
+    // Forced updates (resize, configuration change) render the current frame again
+    if (m_newestFrame > m_renderedFrame + 1) {
+        m_stats.framesDropped += m_newestFrame - m_renderedFrame - 1;
+    }
+    m_renderedFrame = m_newestFrame;
+    m_renderedTime = m_newestTime;
+    m_renderAccel = qMax(1u, accelFactor);
+    m_stats.rendersStarted++;
+}
+
+bool ScopeScheduler::renderFinished(uint mseconds)
+{
+    QMutexLocker lock(&m_mutex);
+    m_stats.rendersFinished++;
+    m_stats.lastRenderTime = mseconds;
+    m_stats.maxRenderTime = qMax(m_stats.maxRenderTime, mseconds);
+    if (m_stats.rendersFinished == 1) {
+        m_stats.averageRenderTime = mseconds;
+        m_fullCost = (double)mseconds * m_renderAccel;
+    } else {
+        m_stats.averageRenderTime += averageWeight * (mseconds - m_stats.averageRenderTime);
+        m_fullCost += averageWeight * ((double)mseconds * m_renderAccel - m_fullCost);
+    }
+    adapt();
+
+    // The frame being displayed by the monitor is the newest one, a result more than one frame behind it is stale
+    bool outdated = m_newestFrame > m_renderedFrame + 1;
+    if (outdated && !m_lastDiscarded) {
+        m_stats.rendersDiscarded++;
+        m_lastDiscarded = true;
+        return false;
+    }
+    m_lastDiscarded = false;
+    m_stats.lastLatency = (uint)(m_clock.elapsed() - m_renderedTime);
+    return true;
+}
+
+void ScopeScheduler::adapt()
+{
+    if (!m_adaptive || m_stats.rendersFinished == 0) {
+        return;
+    }
+    const double budget = m_stats.budget;
+    uint accel = m_stats.accelFactor;
+    if (m_fullCost / accel > budget) {
+        accel = (uint)std::ceil(m_fullCost / budget);
+    } else {
+        while (accel > 1 && m_fullCost / (accel - 1) < lowerThreshold * budget) {
+            accel--;
+        }
+    }
+    m_stats.accelFactor = qBound(1u, accel, MaxAccelFactor);
+}
+
+uint ScopeScheduler::accelFactor() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_stats.accelFactor;
+}
+
+ScopeScheduler::Stats ScopeScheduler::stats() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_stats;
+}
+
+void ScopeScheduler::resetStats()
+{
+    QMutexLocker lock(&m_mutex);
+    Stats stats;
+    stats.accelFactor = m_stats.accelFactor;
+    stats.budget = m_stats.budget;
+    m_stats = stats;
+    m_fullCost = 0;
+}
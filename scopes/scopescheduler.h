@@ -0,0 +1,115 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef SCOPESCHEDULER_H
+#define SCOPESCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QtGlobal>
+
+/*!
+  \class ScopeScheduler
+  \brief The ScopeScheduler decides which frame a scope renders and how precisely,
+  so that the scope keeps up with the monitor.
+
+  \threadsafe
+
+  The monitor never waits for a scope: frames coming in while the scope is busy
+  only replace the pending one, and the frames between the last rendered one
+  and the newest pending one are dropped. When a render ends while more than
+  one newer frame came in, its result is already out of date and is discarded,
+  unless the previous result was discarded too, so that the scope still shows
+  something when it cannot keep up.
+
+  In realtime mode, the acceleration factor (one line or pixel out of n is read)
+  follows the average render time of the scope, so that rendering stays within
+  a budget in milliseconds.
+*/
+
+class ScopeScheduler
+{
+public:
+    //! Default render budget of a scope, in milliseconds.
+    static const int DefaultBudget = 15;
+    //! Highest acceleration factor used in realtime mode.
+    static const uint MaxAccelFactor = 16;
+
+    struct Stats
+    {
+        //! Frames received from the monitor
+        quint64 framesReceived = 0;
+        //! Frames replaced by a newer one before being rendered
+        quint64 framesDropped = 0;
+        //! Renders started and finished
+        quint64 rendersStarted = 0;
+        quint64 rendersFinished = 0;
+        //! Results not displayed because they were more than one frame old
+        quint64 rendersDiscarded = 0;
+        //! Render times in milliseconds
+        uint lastRenderTime = 0;
+        double averageRenderTime = 0;
+        uint maxRenderTime = 0;
+        //! Time between the reception of the last displayed frame and the end of its render
+        uint lastLatency = 0;
+        uint accelFactor = 1;
+        int budget = DefaultBudget;
+    };
+
+    explicit ScopeScheduler(int budget = DefaultBudget);
+
+    void setBudget(int budget);
+    int budget() const;
+    //! Enables the adaptation of the acceleration factor, it is reset to 1 when disabled.
+    void setAdaptive(bool adaptive);
+
+    //! A new frame has been received.
+    void frameReceived();
+    //! A render starts, on the newest frame received.
+    void renderStarted(uint accelFactor);
+    //! The current render has finished, returns false if its result is outdated.
+    bool renderFinished(uint mseconds);
+
+    //! The acceleration factor to use for the next render.
+    uint accelFactor() const;
+    Stats stats() const;
+    void resetStats();
+
+private:
+    mutable QMutex m_mutex;
+    QElapsedTimer m_clock;
+    Stats m_stats;
+    bool m_adaptive;
+    //! Serial number of the newest frame received and of the frame being rendered
+    quint64 m_newestFrame;
+    quint64 m_renderedFrame;
+    //! Reception time of the newest frame and of the frame being rendered
+    qint64 m_newestTime;
+    qint64 m_renderedTime;
+    uint m_renderAccel;
+    bool m_lastDiscarded;
+    //! Average render time without acceleration, estimated from the accelerated renders
+    double m_fullCost;
+
+    void adapt();
+};
+
+#endif // SCOPESCHEDULER_H
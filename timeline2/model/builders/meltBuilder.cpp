@@ -39,14 +39,35 @@ bool constructTrackFromMelt(const std::shared_ptr<TimelineItemModel> &timeline,
 bool constructTrackFromMelt(const std::shared_ptr<TimelineItemModel> &timeline, int tid, Mlt::Playlist &track,
                             const std::unordered_map<QString, QString> &binIdCorresp, Fun &undo, Fun &redo);
 
+namespace {
+// Mixer settings, stored on the tracks and on the main tractor
+const char *mixerProperties[] = {"kdenlive:mixer_gain", "kdenlive:mixer_pan", "kdenlive:mixer_mute", "kdenlive:mixer_solo"};
+
+void loadMixerState(const std::shared_ptr<TimelineItemModel> &timeline, int tid, Mlt::Properties &source)
+{
+    for (const char *name : mixerProperties) {
+        if (source.get(name) != nullptr) {
+            timeline->setTrackProperty(tid, QString::fromLatin1(name), QString::fromUtf8(source.get(name)));
+        }
+    }
+}
+} // namespace
+
 bool constructTimelineFromMelt(const std::shared_ptr<TimelineItemModel> &timeline, Mlt::Tractor tractor)
 {
     Fun undo = []() { return true; };
     Fun redo = []() { return true; };
     // First, we destruct the previous tracks
     timeline->requestReset(undo, redo);
+    // Clips and compositions are loaded directly in the model, without undo history nor view notification
+    timeline->beginLoad();
     std::unordered_map<QString, QString> binIdCorresp;
     pCore->projectItemModel()->loadBinPlaylist(&tractor, timeline->tractor(), binIdCorresp);
+    for (const char *name : mixerProperties) {
+        if (tractor.get(name) != nullptr) {
+            timeline->tractor()->set(name, tractor.get(name));
+        }
+    }
 
     QSet<QString> reserved_names{QLatin1String("playlistmain"), QLatin1String("timeline_preview"), QLatin1String("timeline_overlay"),
                                  QLatin1String("black_track")};
@@ -73,6 +94,7 @@ bool constructTimelineFromMelt(const std::shared_ptr<TimelineItemModel> &timelin
             if (lockState > 0) {
                 timeline->setTrackProperty(tid, QStringLiteral("kdenlive:locked_track"), QString::number(lockState));
             }
+            loadMixerState(timeline, tid, *track);
             Mlt::Tractor local_tractor(*track);
             ok = ok && constructTrackFromMelt(timeline, tid, local_tractor, binIdCorresp, undo, redo);
             break;
@@ -93,6 +115,7 @@ bool constructTimelineFromMelt(const std::shared_ptr<TimelineItemModel> &timelin
             if (lockState > 0) {
                 timeline->setTrackProperty(tid, QStringLiteral("kdenlive:locked_track"), QString::number(lockState));
             }
+            loadMixerState(timeline, tid, local_playlist);
             ok = ok && constructTrackFromMelt(timeline, tid, local_playlist, binIdCorresp, undo, redo);
             break;
         }
@@ -128,14 +151,15 @@ bool constructTimelineFromMelt(const std::shared_ptr<TimelineItemModel> &timelin
             Mlt::Properties transProps(t->get_properties());
             QString id(t->get("kdenlive_id"));
             int compoId;
-            ok = timeline->requestCompositionInsertion(id, timeline->getTrackIndexFromPosition(t->get_b_track() - 1), t->get_a_track(), t->get_in(), t->get_length(), &transProps, compoId, undo, redo);
+            ok = timeline->loadComposition(id, timeline->getTrackIndexFromPosition(t->get_b_track() - 1), t->get_a_track(), t->get_in(), t->get_length(), &transProps, compoId);
             if (!ok) {
                 qDebug() << "ERROR : failed to insert composition in track " << t->get_b_track() << ", position" << t->get_in();
                 break;
             }
-            qDebug() << "Inserted composition in track " << t->get_b_track() << ", position" << t->get_in()<<"/"<< t->get_out();
         }
     }
+    // Plant all the compositions at once and reset the view
+    ok = timeline->endLoad() && ok;
 
     // build internal track compositing
     timeline->buildTrackCompositing();
@@ -143,6 +167,24 @@ bool constructTimelineFromMelt(const std::shared_ptr<TimelineItemModel> &timelin
 
     if (!ok) {
         // TODO log error
+        // Loaded items are not in the undo history, so every item of the timeline has to be removed before the tracks are,
+        // including a clip whose loading failed, which is registered without being on a track
+        std::vector<int> loadedCompositions;
+        std::vector<int> loadedClips;
+        for (const auto &compo : timeline->m_allCompositions) {
+            loadedCompositions.push_back(compo.first);
+        }
+        for (const auto &clip : timeline->m_allClips) {
+            loadedClips.push_back(clip.first);
+        }
+        for (int compoId : loadedCompositions) {
+            timeline->requestItemDeletion(compoId, false);
+        }
+        for (int clipId : loadedClips) {
+            if (timeline->isClip(clipId)) {
+                timeline->requestItemDeletion(clipId, false);
+            }
+        }
         undo();
         return false;
     }
@@ -217,7 +259,7 @@ bool constructTrackFromMelt(const std::shared_ptr<TimelineItemModel> &timeline,
             bool ok = false;
             if (pCore->bin()->getBinClip(binId)) {
                 int cid = ClipModel::construct(timeline, binId, clip);
-                ok = timeline->requestClipMove(cid, tid, position, true, false, undo, redo);
+                ok = timeline->loadClip(cid, tid, position);
             } else {
                 qDebug() << "// Cannot find bin clip: " << binId << " - " << clip->get("id");
             }
@@ -225,8 +267,6 @@ bool constructTrackFromMelt(const std::shared_ptr<TimelineItemModel> &timeline,
                 qDebug() << "ERROR : failed to insert clip in track" << tid << "position" << position;
                 return false;
             }
-            qDebug() << "Inserted clip in track" << tid << "at " << position;
-
             break;
         }
         case tractor_type: {
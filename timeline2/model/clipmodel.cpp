@@ -22,6 +22,7 @@
 #include "bin/projectclip.h"
 #include "bin/projectitemmodel.h"
 #include "core.h"
+#include "lib/audio/audioPeaks.h"
 #include "effects/effectstack/model/effectstackmodel.hpp"
 #include "macros.hpp"
 #include "timelinemodel.hpp"
@@ -377,7 +378,7 @@ QVariant ClipModel::getAudioWaveform()
     READ_LOCK();
     std::shared_ptr<ProjectClip> binClip = pCore->projectItemModel()->getClipByBinID(m_binClipId);
     if (binClip) {
-        return QVariant::fromValue(binClip->audioFrameCache);
+        return QVariant::fromValue(binClip->audioPeaks());
     }
     return QVariant();
 }
@@ -86,7 +86,7 @@ Fun GroupsModel::groupItems_lambda(int gid, const std::unordered_set<int> &ids,
                 setGroup(getRootId(id), gid);
                 if (type != GroupType::Selection && ptr->isClip(id)) {
                     QModelIndex ix = ptr->makeClipIndexFromID(id);
-                    ptr->dataChanged(ix, ix, {TimelineModel::GroupedRole});
+                    ptr->notifyChange(ix, ix, {TimelineModel::GroupedRole});
                 }
             }
         }
@@ -145,7 +145,7 @@ Fun GroupsModel::destructGroupItem_lambda(int id)
             m_upLink[child] = -1;
             if (ptr->isClip(child)) {
                 QModelIndex ix = ptr->makeClipIndexFromID(child);
-                ptr->dataChanged(ix, ix, {TimelineModel::GroupedRole});
+                ptr->notifyChange(ix, ix, {TimelineModel::GroupedRole});
             }
         }
         m_downLink[id].clear();
@@ -367,7 +367,7 @@ bool GroupsModel::mergeSingleGroups(int id, Fun &undo, Fun &redo)
             setGroup(group.first, group.second);
             if (old == -1 && group.second != -1 && ptr->isClip(group.first)) {
                 QModelIndex ix = ptr->makeClipIndexFromID(group.first);
-                ptr->dataChanged(ix, ix, {TimelineModel::GroupedRole});
+                ptr->notifyChange(ix, ix, {TimelineModel::GroupedRole});
             }
         }
         return true;
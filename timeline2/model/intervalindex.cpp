@@ -0,0 +1,138 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+#include "intervalindex.hpp"
+#include "treap.hpp"
+
+#include <algorithm>
+
+IntervalIndex::IntervalIndex()
+    : m_root(-1)
+{
+}
+
+void IntervalIndex::update(int node)
+{
+    Node &n = m_nodes[(size_t)node];
+    n.maxOut = n.out;
+    if (n.left >= 0) {
+        n.maxOut = std::max(n.maxOut, m_nodes[(size_t)n.left].maxOut);
+    }
+    if (n.right >= 0) {
+        n.maxOut = std::max(n.maxOut, m_nodes[(size_t)n.right].maxOut);
+    }
+}
+
+int IntervalIndex::newNode(int id, int in, int out)
+{
+    Node node{id, in, out, out, -1, -1, Treap::idPriority(id)};
+    return Treap::allocate(m_nodes, m_free, node);
+}
+
+void IntervalIndex::split(int node, int in, int id, int &lower, int &upper)
+{
+    Treap::split(m_nodes, node, [in, id](const Node &n) { return n.in < in || (n.in == in && n.id < id); }, [this](int n) { update(n); }, lower,
+                 upper);
+}
+
+int IntervalIndex::merge(int lower, int upper)
+{
+    return Treap::merge(m_nodes, lower, upper, [this](int n) { update(n); });
+}
+
+void IntervalIndex::insert(int id, int in, int out)
+{
+    remove(id);
+    int node = newNode(id, in, out);
+    int lower, upper;
+    split(m_root, in, id, lower, upper);
+    m_root = merge(merge(lower, node), upper);
+    m_starts[id] = in;
+}
+
+bool IntervalIndex::remove(int id)
+{
+    auto it = m_starts.find(id);
+    if (it == m_starts.end()) {
+        return false;
+    }
+    int lower, middle, upper;
+    split(m_root, it->second, id, lower, upper);
+    // upper starts with the item, detach it
+    split(upper, it->second, id + 1, middle, upper);
+    m_root = merge(lower, upper);
+    m_free.push_back(middle);
+    m_starts.erase(it);
+    return true;
+}
+
+bool IntervalIndex::contains(int id) const
+{
+    return m_starts.count(id) > 0;
+}
+
+bool IntervalIndex::collect(int node, int in, int out, bool first, std::vector<int> &result) const
+{
+    if (node < 0 || m_nodes[(size_t)node].maxOut < in) {
+        return false;
+    }
+    const Node &n = m_nodes[(size_t)node];
+    if (collect(n.left, in, out, first, result)) {
+        return true;
+    }
+    if (n.in > out) {
+        // Everything on the right starts even later
+        return false;
+    }
+    if (n.out >= in) {
+        result.push_back(n.id);
+        if (first) {
+            return true;
+        }
+    }
+    return collect(n.right, in, out, first, result);
+}
+
+std::vector<int> IntervalIndex::overlapping(int in, int out) const
+{
+    std::vector<int> result;
+    collect(m_root, in, out, false, result);
+    return result;
+}
+
+int IntervalIndex::firstOverlapping(int in, int out) const
+{
+    std::vector<int> result;
+    collect(m_root, in, out, true, result);
+    return result.empty() ? -1 : result.front();
+}
+
+int IntervalIndex::size() const
+{
+    return (int)m_starts.size();
+}
+
+void IntervalIndex::clear()
+{
+    m_nodes.clear();
+    m_free.clear();
+    m_starts.clear();
+    m_root = -1;
+}
@@ -0,0 +1,88 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef INTERVALINDEX_H
+#define INTERVALINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/** @brief This class stores the frame ranges of the items of a track, to find which items are at a position or in a range
+    without querying MLT. Ranges may overlap.
+ *
+    Finding the items overlapping a range is O(log n + k), k being the number of items found, and so are insertions,
+    removals and updates.
+    Internally, this is a treap ordered by start position, whose nodes store the highest end of their subtree so that
+    subtrees ending before the queried range are skipped. The priority of a node is a hash of its id, so that the shape
+    of the tree only depends on its content.
+ */
+
+class IntervalIndex
+{
+public:
+    IntervalIndex();
+
+    /* @brief Sets the range of an item, in and out being included. The previous range of the item, if any, is replaced */
+    void insert(int id, int in, int out);
+
+    /* @brief Removes an item. Returns false if it was not there */
+    bool remove(int id);
+
+    bool contains(int id) const;
+
+    /* @brief Returns the ids of the items overlapping the range [in, out], ordered by start position */
+    std::vector<int> overlapping(int in, int out) const;
+
+    /* @brief Returns the id of the first item (by start position) overlapping the range [in, out], or -1 if there is none */
+    int firstOverlapping(int in, int out) const;
+
+    int size() const;
+    void clear();
+
+private:
+    struct Node
+    {
+        int id;
+        int in;
+        int out;
+        int maxOut; // highest out of the subtree
+        int left;
+        int right;
+        uint32_t priority;
+    };
+
+    int newNode(int id, int in, int out);
+    void update(int node);
+    // Splits the tree rooted at node in the items before (in, id), and the others
+    void split(int node, int in, int id, int &lower, int &upper);
+    int merge(int lower, int upper);
+    // Appends the overlapping items to result. If first is true, returns true as soon as one is found to stop the search
+    bool collect(int node, int in, int out, bool first, std::vector<int> &result) const;
+
+    std::vector<Node> m_nodes; // Nodes are stored contiguously and referenced by index, -1 being the empty tree
+    std::vector<int> m_free;   // Removed nodes, reused by the next insertions
+    std::unordered_map<int, int> m_starts; // start position of each item, which is its key in the tree
+    int m_root;
+};
+
+#endif
@@ -0,0 +1,136 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+#include "rankindex.hpp"
+#include "treap.hpp"
+
+RankIndex::RankIndex()
+    : m_root(-1)
+{
+}
+
+int RankIndex::sizeOf(int node) const
+{
+    return node < 0 ? 0 : m_nodes[(size_t)node].size;
+}
+
+void RankIndex::update(int node)
+{
+    Node &n = m_nodes[(size_t)node];
+    n.size = 1 + sizeOf(n.left) + sizeOf(n.right);
+}
+
+int RankIndex::newNode(int id)
+{
+    Node node{id, 1, -1, -1, Treap::idPriority(id)};
+    return Treap::allocate(m_nodes, m_free, node);
+}
+
+void RankIndex::split(int node, int id, int &lower, int &upper)
+{
+    Treap::split(m_nodes, node, [id](const Node &n) { return n.id < id; }, [this](int n) { update(n); }, lower, upper);
+}
+
+int RankIndex::merge(int lower, int upper)
+{
+    return Treap::merge(m_nodes, lower, upper, [this](int n) { update(n); });
+}
+
+bool RankIndex::insert(int id)
+{
+    if (contains(id)) {
+        return false;
+    }
+    int node = newNode(id);
+    int lower, upper;
+    split(m_root, id, lower, upper);
+    m_root = merge(merge(lower, node), upper);
+    return true;
+}
+
+bool RankIndex::remove(int id)
+{
+    int lower, middle, upper;
+    split(m_root, id, lower, upper);
+    // upper starts with id if it is in the index, detach it
+    split(upper, id + 1, middle, upper);
+    m_root = merge(lower, upper);
+    if (middle < 0) {
+        return false;
+    }
+    m_free.push_back(middle);
+    return true;
+}
+
+int RankIndex::rank(int id) const
+{
+    int result = 0;
+    int node = m_root;
+    while (node >= 0) {
+        const Node &n = m_nodes[(size_t)node];
+        if (id < n.id) {
+            node = n.left;
+        } else if (id > n.id) {
+            result += sizeOf(n.left) + 1;
+            node = n.right;
+        } else {
+            return result + sizeOf(n.left);
+        }
+    }
+    return -1;
+}
+
+int RankIndex::at(int rank) const
+{
+    if (rank < 0 || rank >= size()) {
+        return -1;
+    }
+    int node = m_root;
+    while (node >= 0) {
+        const Node &n = m_nodes[(size_t)node];
+        int leftSize = sizeOf(n.left);
+        if (rank < leftSize) {
+            node = n.left;
+        } else if (rank > leftSize) {
+            rank -= leftSize + 1;
+            node = n.right;
+        } else {
+            return n.id;
+        }
+    }
+    return -1;
+}
+
+bool RankIndex::contains(int id) const
+{
+    return rank(id) >= 0;
+}
+
+int RankIndex::size() const
+{
+    return sizeOf(m_root);
+}
+
+void RankIndex::clear()
+{
+    m_nodes.clear();
+    m_free.clear();
+    m_root = -1;
+}
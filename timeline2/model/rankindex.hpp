@@ -0,0 +1,81 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef RANKINDEX_H
+#define RANKINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/** @brief This class is an ordered set of ids that also knows the rank of each id.
+    The tracks use the id order of their clips and compositions as row order. Both the row of an id
+    and the id at a given row are found in O(log n), as well as insertions and removals, whereas
+    walking an std::map is linear in the row.
+ *
+    Internally, this is a treap whose nodes store the size of their subtree. The priority of a node is
+    a hash of its id, so that the shape of the tree only depends on its content.
+ */
+
+class RankIndex
+{
+public:
+    RankIndex();
+
+    /* @brief Adds an id. Returns false if it was already there */
+    bool insert(int id);
+
+    /* @brief Removes an id. Returns false if it was not there */
+    bool remove(int id);
+
+    /* @brief Returns the number of ids smaller than the given one, or -1 if it is not in the index */
+    int rank(int id) const;
+
+    /* @brief Returns the id of given rank, or -1 if the rank is out of bounds */
+    int at(int rank) const;
+
+    bool contains(int id) const;
+    int size() const;
+    void clear();
+
+private:
+    struct Node
+    {
+        int id;
+        int size;
+        int left;
+        int right;
+        uint32_t priority;
+    };
+
+    int newNode(int id);
+    void update(int node);
+    // Splits the tree rooted at node in the ids lower than id, and the others
+    void split(int node, int id, int &lower, int &upper);
+    int merge(int lower, int upper);
+    int sizeOf(int node) const;
+
+    std::vector<Node> m_nodes; // Nodes are stored contiguously and referenced by index, -1 being the empty tree
+    std::vector<int> m_free;   // Removed nodes, reused by the next insertions
+    int m_root;
+};
+
+#endif
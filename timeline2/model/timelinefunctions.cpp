@@ -64,6 +64,12 @@ bool TimelineFunctions::requestMultipleClipsInsertion(std::shared_ptr<TimelineIt
 {
     std::function<bool(void)> undo = []() { return true; };
     std::function<bool(void)> redo = []() { return true; };
+    // Notify the view and monitor once for all the clips
+    const bool batched = (size_t)binIds.size() > TimelineModel::BatchedEditSize;
+    std::unique_ptr<TimelineEditTransaction> transaction;
+    if (batched) {
+        transaction.reset(new TimelineEditTransaction(timeline.get()));
+    }
 
     for (const QString &binId : binIds) {
         int clipId;
@@ -78,6 +84,10 @@ bool TimelineFunctions::requestMultipleClipsInsertion(std::shared_ptr<TimelineIt
     }
 
     if (logUndo) {
+        if (batched) {
+            undo = timeline->inEditTransaction(undo);
+            redo = timeline->inEditTransaction(redo);
+        }
         pCore->pushUndo(undo, redo, i18n("Insert Clips"));
     }
 
@@ -200,6 +210,10 @@ bool TimelineFunctions::requestSpacerEndOperation(std::shared_ptr<TimelineItemMo
         final = timeline->requestClipUngroup(clipId, undo, redo);
     }
     if (final) {
+        if (clips.size() > TimelineModel::BatchedEditSize) {
+            undo = timeline->inEditTransaction(undo);
+            redo = timeline->inEditTransaction(redo);
+        }
         pCore->pushUndo(undo, redo, i18n("Insert space"));
         return true;
     }
@@ -212,12 +226,18 @@ bool TimelineFunctions::extractZone(std::shared_ptr<TimelineItemModel> timeline,
     std::function<bool(void)> undo = []() { return true; };
     std::function<bool(void)> redo = []() { return true; };
     bool result = false;
+    // Items moved back by the removal of the space
+    const size_t movedItems = liftOnly ? 0 : timeline->getItemsAfterPosition(-1, zone.y() - 1, -1, true).size();
     for (int trackId : tracks) {
         result = TimelineFunctions::liftZone(timeline, trackId, zone, undo, redo);
         if (result && !liftOnly) {
             result = TimelineFunctions::removeSpace(timeline, trackId, zone, undo, redo);
         }
     }
+    if (movedItems > TimelineModel::BatchedEditSize) {
+        undo = timeline->inEditTransaction(undo);
+        redo = timeline->inEditTransaction(redo);
+    }
     pCore->pushUndo(undo, redo, liftOnly ? i18n("Lift zone") : i18n("Extract zone"));
     return result;
 }
@@ -228,6 +248,8 @@ bool TimelineFunctions::insertZone(std::shared_ptr<TimelineItemModel> timeline,
     std::function<bool(void)> undo = []() { return true; };
     std::function<bool(void)> redo = []() { return true; };
     bool result = false;
+    // Items moved forward by the insertion of the space
+    const size_t movedItems = overwrite ? 0 : timeline->getItemsAfterPosition(-1, insertFrame, -1, true).size();
     if (overwrite) {
         result = TimelineFunctions::liftZone(timeline, trackId, QPoint(insertFrame, insertFrame + (zone.y() - zone.x())), undo, redo);
     } else {
@@ -251,6 +273,10 @@ bool TimelineFunctions::insertZone(std::shared_ptr<TimelineItemModel> timeline,
     int newId = -1;
     QString binClipId = QString("%1/%2/%3").arg(binId).arg(zone.x()).arg(zone.y() - 1);
     timeline->requestClipInsertion(binClipId, trackId, insertFrame, newId, true, true, undo, redo);
+    if (movedItems > TimelineModel::BatchedEditSize) {
+        undo = timeline->inEditTransaction(undo);
+        redo = timeline->inEditTransaction(redo);
+    }
     pCore->pushUndo(undo, redo, overwrite ? i18n("Overwrite zone") : i18n("Insert zone"));
     return result;
 }
@@ -339,6 +365,10 @@ bool TimelineFunctions::requestItemCopy(std::shared_ptr<TimelineItemModel> timel
     std::unordered_set<int> allIds = timeline->getGroupElements(clipId);
     std::unordered_map<int, int> mapping; // keys are ids of the source clips, values are ids of the copied clips
     bool res = true;
+    std::unique_ptr<TimelineEditTransaction> transaction;
+    if (allIds.size() > TimelineModel::BatchedEditSize) {
+        transaction.reset(new TimelineEditTransaction(timeline.get()));
+    }
     for (int id : allIds) {
         int newId = -1;
         if (timeline->isClip(id)) {
@@ -383,14 +413,14 @@ void TimelineFunctions::showClipKeyframes(std::shared_ptr<TimelineItemModel> tim
 {
     timeline->m_allClips[clipId]->setShowKeyframes(value);
     QModelIndex modelIndex = timeline->makeClipIndexFromID(clipId);
-    timeline->dataChanged(modelIndex, modelIndex, {TimelineModel::KeyframesRole});
+    timeline->notifyChange(modelIndex, modelIndex, {TimelineModel::KeyframesRole});
 }
 
 void TimelineFunctions::showCompositionKeyframes(std::shared_ptr<TimelineItemModel> timeline, int compoId, bool value)
 {
     timeline->m_allCompositions[compoId]->setShowKeyframes(value);
     QModelIndex modelIndex = timeline->makeCompositionIndexFromID(compoId);
-    timeline->dataChanged(modelIndex, modelIndex, {TimelineModel::KeyframesRole});
+    timeline->notifyChange(modelIndex, modelIndex, {TimelineModel::KeyframesRole});
 }
 
 bool TimelineFunctions::changeClipState(std::shared_ptr<TimelineItemModel> timeline, int clipId, PlaylistState::ClipState status)
@@ -421,10 +451,10 @@ bool TimelineFunctions::changeClipState(std::shared_ptr<TimelineItemModel> timel
         if (trackId != -1) {
             timeline->getTrackById(trackId)->replugClip(clipId);
             QModelIndex ix = timeline->makeClipIndexFromID(clipId);
-            timeline->dataChanged(ix, ix, {TimelineModel::StatusRole});
+            timeline->notifyChange(ix, ix, {TimelineModel::StatusRole});
             int start = timeline->getItemPosition(clipId);
             int end = start + timeline->getItemPlaytime(clipId);
-            timeline->invalidateZone(start, end);
+            timeline->invalidateRange(start, end);
             timeline->checkRefresh(start, end);
         }
         return res;
@@ -438,8 +468,8 @@ bool TimelineFunctions::changeClipState(std::shared_ptr<TimelineItemModel> timel
             int end = start + timeline->getItemPlaytime(clipId);
             timeline->getTrackById(trackId)->replugClip(clipId);
             QModelIndex ix = timeline->makeClipIndexFromID(clipId);
-            timeline->dataChanged(ix, ix, {TimelineModel::StatusRole});
-            timeline->invalidateZone(start, end);
+            timeline->notifyChange(ix, ix, {TimelineModel::StatusRole});
+            timeline->invalidateRange(start, end);
             timeline->checkRefresh(start, end);
         }
         return res;
@@ -511,8 +541,8 @@ void TimelineFunctions::setCompositionATrack(std::shared_ptr<TimelineItemModel>
         timeline->getCompositionPtr(cid)->setATrack(aTrack, aTrack <= 0 ? -1 : timeline->getTrackIndexFromPosition(aTrack - 1));
         field->unlock();
         QModelIndex modelIndex = timeline->makeCompositionIndexFromID(cid);
-        timeline->dataChanged(modelIndex, modelIndex, {TimelineModel::ItemATrack});
-        timeline->invalidateZone(start, end);
+        timeline->notifyChange(modelIndex, modelIndex, {TimelineModel::ItemATrack});
+        timeline->invalidateRange(start, end);
         timeline->checkRefresh(start, end);
         return true;
     };
@@ -523,8 +553,8 @@ void TimelineFunctions::setCompositionATrack(std::shared_ptr<TimelineItemModel>
         timeline->getCompositionPtr(cid)->setATrack(previousATrack, previousATrack<= 0 ? -1 : timeline->getTrackIndexFromPosition(previousATrack - 1));
         field->unlock();
         QModelIndex modelIndex = timeline->makeCompositionIndexFromID(cid);
-        timeline->dataChanged(modelIndex, modelIndex, {TimelineModel::ItemATrack});
-        timeline->invalidateZone(start, end);
+        timeline->notifyChange(modelIndex, modelIndex, {TimelineModel::ItemATrack});
+        timeline->invalidateRange(start, end);
         timeline->checkRefresh(start, end);
         return true;
     };
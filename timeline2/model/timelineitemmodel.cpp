@@ -39,10 +39,13 @@
 #include <mlt++/MltTractor.h>
 #include <mlt++/MltTransition.h>
 
+#include <algorithm>
 #include <utility>
 
 TimelineItemModel::TimelineItemModel(Mlt::Profile *profile, std::weak_ptr<DocUndoStack> undo_stack)
     : TimelineModel(profile, undo_stack)
+    , m_sendingTrack(-1)
+    , m_sendingRowCount(0)
 {
 }
 
@@ -80,9 +83,7 @@ QModelIndex TimelineItemModel::index(int row, int column, const QModelIndex &par
             }
         }
     } else if (row < getTracksCount() && row >= 0) {
-        auto it = m_allTracks.cbegin();
-        std::advance(it, row);
-        int trackId = (*it)->getId();
+        int trackId = m_allTracks[(size_t)row]->getId();
         result = createIndex(row, column, quintptr(trackId));
     }
     return result;
@@ -114,11 +115,8 @@ QModelIndex TimelineItemModel::makeCompositionIndexFromID(int compoId) const
 
 QModelIndex TimelineItemModel::makeTrackIndexFromID(int trackId) const
 {
-    // we retrieve iterator
-    Q_ASSERT(m_iteratorTable.count(trackId) > 0);
-    auto it = m_iteratorTable.at(trackId);
-    int ind = (int)std::distance<decltype(m_allTracks.cbegin())>(m_allTracks.begin(), it);
-    return index(ind);
+    Q_ASSERT(m_trackPositions.count(trackId) > 0);
+    return index(m_trackPositions.at(trackId));
 }
 
 QModelIndex TimelineItemModel::parent(const QModelIndex &index) const
@@ -153,6 +151,9 @@ int TimelineItemModel::rowCount(const QModelIndex &parent) const
             // if it is not a track, it is something invalid
             return 0;
         }
+        if (id == m_sendingTrack) {
+            return m_sendingRowCount;
+        }
         return getTrackClipsCount(id) + getTrackCompositionsCount(id);
     }
     return getTracksCount();
@@ -457,37 +458,199 @@ void TimelineItemModel::notifyChange(const QModelIndex &topleft, const QModelInd
             roles.push_back(TimelineModel::OutPointRole);
         }
     }
-    emit dataChanged(topleft, bottomright, roles);
+    notifyChange(topleft, bottomright, roles);
 }
 
 void TimelineItemModel::notifyChange(const QModelIndex &topleft, const QModelIndex &bottomright, const QVector<int> &roles)
 {
-    emit dataChanged(topleft, bottomright, roles);
+    if (!isInEditTransaction()) {
+        emit dataChanged(topleft, bottomright, roles);
+        return;
+    }
+    if (!topleft.isValid() || !bottomright.isValid()) {
+        return;
+    }
+    // Merge the roles of each item, they are sent once when the transaction ends
+    const QModelIndex parent = topleft.parent();
+    for (int row = topleft.row(); row <= bottomright.row(); ++row) {
+        const int id = (int)index(row, 0, parent).internalId();
+        auto it = m_deferredRoles.find(id);
+        if (it == m_deferredRoles.end()) {
+            m_deferredRoles[id] = roles;
+        } else if (roles.isEmpty()) {
+            it->second.clear();
+        } else if (!it->second.isEmpty()) {
+            for (int role : roles) {
+                if (!it->second.contains(role)) {
+                    it->second.push_back(role);
+                }
+            }
+        }
+    }
+}
+
+std::vector<int> TimelineItemModel::trackRows(int trackId) const
+{
+    std::shared_ptr<TrackModel> track = getTrackById_const(trackId);
+    const int count = track->getClipsCount() + track->getCompositionsCount();
+    std::vector<int> rows;
+    rows.reserve((size_t)count);
+    for (int row = 0; row < count; ++row) {
+        int id = track->getClipByRow(row);
+        rows.push_back(id != -1 ? id : track->getCompositionByRow(row));
+    }
+    return rows;
+}
+
+void TimelineItemModel::deferRowsChange(const QModelIndex &parent, int first, int last, bool inserted)
+{
+    if (!parent.isValid()) {
+        // Tracks were inserted or removed, the view will be reset
+        m_transactionResetView = true;
+        return;
+    }
+    const int trackId = (int)parent.internalId();
+    std::shared_ptr<TrackModel> track = getTrackById_const(trackId);
+    for (int row = first; row <= last; ++row) {
+        int id = track->getClipByRow(row);
+        if (id == -1) {
+            id = track->getCompositionByRow(row);
+        }
+        if (id != -1) {
+            m_deferredMoves.insert(id);
+        }
+    }
+    if (m_deferredRows.count(trackId) == 0) {
+        // Inserted items are already in the track when they are notified, removed ones are still there
+        std::vector<int> rows = trackRows(trackId);
+        if (inserted) {
+            const int size = (int)rows.size();
+            rows.erase(rows.begin() + std::min(first, size), rows.begin() + std::min(last + 1, size));
+        }
+        m_deferredRows[trackId] = std::move(rows);
+    }
+}
+
+void TimelineItemModel::_sendDeferredViewUpdates(bool reset)
+{
+    std::unordered_map<int, std::vector<int>> deferredRows;
+    std::unordered_set<int> moves;
+    std::unordered_map<int, QVector<int>> deferredRoles;
+    std::swap(deferredRows, m_deferredRows);
+    std::swap(moves, m_deferredMoves);
+    std::swap(deferredRoles, m_deferredRoles);
+    if (reset) {
+        beginResetModel();
+        endResetModel();
+        return;
+    }
+    // Rows are sent as the net change of each track: the items that are not there anymore are removed, from the last row so
+    // that the others keep their row, then the new items are inserted in row order so that each one gets its final row.
+    // Both lists keep the relative order of the items present in both, as rows follow the ids of clips, then of compositions.
+    for (const auto &track : deferredRows) {
+        const int trackId = track.first;
+        if (!isTrack(trackId)) {
+            continue;
+        }
+        const std::vector<int> &oldRows = track.second;
+        const std::vector<int> newRows = trackRows(trackId);
+        const std::unordered_set<int> oldIds(oldRows.begin(), oldRows.end());
+        const std::unordered_set<int> newIds(newRows.begin(), newRows.end());
+        const QModelIndex parent = makeTrackIndexFromID(trackId);
+        m_sendingTrack = trackId;
+        m_sendingRowCount = (int)oldRows.size();
+        for (int row = (int)oldRows.size() - 1; row >= 0;) {
+            if (newIds.count(oldRows[(size_t)row]) > 0) {
+                --row;
+                continue;
+            }
+            const int last = row;
+            while (row >= 0 && newIds.count(oldRows[(size_t)row]) == 0) {
+                --row;
+            }
+            beginRemoveRows(parent, row + 1, last);
+            m_sendingRowCount -= last - row;
+            endRemoveRows();
+        }
+        for (int row = 0; row < (int)newRows.size();) {
+            if (oldIds.count(newRows[(size_t)row]) > 0) {
+                ++row;
+                continue;
+            }
+            const int first = row;
+            while (row < (int)newRows.size() && oldIds.count(newRows[(size_t)row]) == 0) {
+                ++row;
+            }
+            beginInsertRows(parent, first, row - 1);
+            m_sendingRowCount += row - first;
+            endInsertRows();
+        }
+        m_sendingTrack = -1;
+        // Items removed and inserted back in the same track kept their row, but may have changed
+        for (int id : newRows) {
+            if (oldIds.count(id) > 0 && moves.count(id) > 0) {
+                deferredRoles[id].clear();
+            }
+        }
+    }
+    for (const auto &item : deferredRoles) {
+        const int id = item.first;
+        QModelIndex ix;
+        if (isClip(id)) {
+            ix = makeClipIndexFromID(id);
+        } else if (isComposition(id) && getCompositionTrackId(id) != -1) {
+            ix = makeCompositionIndexFromID(id);
+        } else if (isTrack(id)) {
+            ix = makeTrackIndexFromID(id);
+        }
+        if (ix.isValid()) {
+            emit dataChanged(ix, ix, item.second);
+        }
+    }
 }
 
+// During an edit transaction, row changes are only recorded, see _sendDeferredViewUpdates
 void TimelineItemModel::_beginRemoveRows(const QModelIndex &i, int j, int k)
 {
     // qDebug()<<"FORWARDING beginRemoveRows"<<i<<j<<k;
+    if (isInEditTransaction()) {
+        deferRowsChange(i, j, k, false);
+        return;
+    }
     beginRemoveRows(i, j, k);
 }
 void TimelineItemModel::_beginInsertRows(const QModelIndex &i, int j, int k)
 {
     // qDebug()<<"FORWARDING beginInsertRows"<<i<<j<<k;
+    if (isInEditTransaction()) {
+        deferRowsChange(i, j, k, true);
+        return;
+    }
     beginInsertRows(i, j, k);
 }
 void TimelineItemModel::_endRemoveRows()
 {
     // qDebug()<<"FORWARDING endRemoveRows";
+    if (isInEditTransaction()) {
+        return;
+    }
     endRemoveRows();
 }
 void TimelineItemModel::_endInsertRows()
 {
     // qDebug()<<"FORWARDING endinsertRows";
+    if (isInEditTransaction()) {
+        return;
+    }
     endInsertRows();
 }
 
 void TimelineItemModel::_resetView()
 {
+    if (isInEditTransaction()) {
+        m_transactionResetView = true;
+        return;
+    }
     beginResetModel();
     endResetModel();
 }
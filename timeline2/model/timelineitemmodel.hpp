@@ -95,9 +95,26 @@ public:
     virtual void _endRemoveRows() override;
     virtual void _endInsertRows() override;
     virtual void _resetView() override;
+    virtual void _sendDeferredViewUpdates(bool reset) override;
 
 protected:
     // This is an helper function that finishes a constuction of a freshly created TimelineItemModel
     static void finishConstruct(std::shared_ptr<TimelineItemModel> ptr, std::shared_ptr<MarkerListModel> guideModel);
+
+private:
+    /* @brief Records the rows of a track inserted or removed during an edit transaction, see _sendDeferredViewUpdates */
+    void deferRowsChange(const QModelIndex &parent, int first, int last, bool inserted);
+    /* @brief Returns the ids of the items of a track, in row order */
+    std::vector<int> trackRows(int trackId) const;
+
+    // Rows of the tracks as they were last sent to the views, for the tracks whose rows changed during the edit transaction
+    std::unordered_map<int, std::vector<int>> m_deferredRows;
+    // Items whose row was removed or inserted during the edit transaction
+    std::unordered_set<int> m_deferredMoves;
+    // Roles changed during the edit transaction for each item id, an empty vector meaning all roles
+    std::unordered_map<int, QVector<int>> m_deferredRoles;
+    // While the deferred rows of a track are sent, the number of rows the views expect for it
+    int m_sendingTrack;
+    int m_sendingRowCount;
 };
 #endif
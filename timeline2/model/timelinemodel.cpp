@@ -41,6 +41,7 @@
 #include <mlt++/MltProfile.h>
 #include <mlt++/MltTractor.h>
 #include <mlt++/MltTransition.h>
+#include <algorithm>
 #include <queue>
 #ifdef LOGGING
 #include <sstream>
@@ -65,6 +66,9 @@ TimelineModel::TimelineModel(Mlt::Profile *profile, std::weak_ptr<DocUndoStack>
     , m_overlayTrackCount(-1)
     , m_audioTarget(-1)
     , m_videoTarget(-1)
+    , m_transactionDepth(0)
+    , m_transactionResetView(false)
+    , m_transactionDurationChanged(false)
 {
     // Create black background track
     m_blackClip->set("id", "black_track");
@@ -90,7 +94,7 @@ TimelineModel::TimelineModel(Mlt::Profile *profile, std::weak_ptr<DocUndoStack>
 TimelineModel::~TimelineModel()
 {
     std::vector<int> all_ids;
-    for (auto tracks : m_iteratorTable) {
+    for (auto tracks : m_trackPositions) {
         all_ids.push_back(tracks.first);
     }
     for (auto tracks : all_ids) {
@@ -118,12 +122,7 @@ int TimelineModel::getTrackIndexFromPosition(int pos) const
 {
     Q_ASSERT(pos >= 0 && pos < (int)m_allTracks.size());
     READ_LOCK();
-    auto it = m_allTracks.begin();
-    while (pos > 0) {
-        it++;
-        pos--;
-    }
-    return (*it)->getId();
+    return m_allTracks[(size_t)pos]->getId();
 }
 
 int TimelineModel::getClipsCount() const
@@ -242,9 +241,7 @@ int TimelineModel::getTrackPosition(int trackId) const
 {
     READ_LOCK();
     Q_ASSERT(isTrack(trackId));
-    auto it = m_allTracks.begin();
-    int pos = (int)std::distance(it, (decltype(it))m_iteratorTable.at(trackId));
-    return pos;
+    return m_trackPositions.at(trackId);
 }
 
 int TimelineModel::getTrackMltIndex(int trackId) const
@@ -259,7 +256,7 @@ QList<int> TimelineModel::getLowerTracksId(int trackId, TrackType type) const
     READ_LOCK();
     Q_ASSERT(isTrack(trackId));
     QList<int> results;
-    auto it = m_iteratorTable.at(trackId);
+    auto it = m_allTracks.cbegin() + m_trackPositions.at(trackId);
     while (it != m_allTracks.begin()) {
         --it;
         if (type == TrackType::AnyTrack) {
@@ -280,7 +277,7 @@ int TimelineModel::getPreviousVideoTrackPos(int trackId) const
 {
     READ_LOCK();
     Q_ASSERT(isTrack(trackId));
-    auto it = m_iteratorTable.at(trackId);
+    auto it = m_allTracks.cbegin() + m_trackPositions.at(trackId);
     while (it != m_allTracks.begin()) {
         --it;
         if (it != m_allTracks.begin() && (*it)->getProperty("kdenlive:audio_track").toInt() == 0) {
@@ -776,6 +773,10 @@ bool TimelineModel::requestGroupMove(int clipId, int groupId, int delta_track, i
     std::function<bool(void)> redo = []() { return true; };
     bool res = requestGroupMove(clipId, groupId, delta_track, delta_pos, updateView, logUndo, undo, redo);
     if (res && logUndo) {
+        if (m_groups->getLeaves(groupId).size() > BatchedEditSize) {
+            undo = inEditTransaction(undo);
+            redo = inEditTransaction(redo);
+        }
         PUSH_UNDO(undo, redo, i18n("Move group"));
     }
     return res;
@@ -792,30 +793,40 @@ bool TimelineModel::requestGroupMove(int clipId, int groupId, int delta_track, i
     Q_ASSERT(m_allGroups.count(groupId) > 0);
     bool ok = true;
     auto all_clips = m_groups->getLeaves(groupId);
-    std::vector<int> sorted_clips(all_clips.begin(), all_clips.end());
+    // Track and position of each item are looked up once, before anything moves
+    struct GroupItem
+    {
+        int id;
+        int trackPosition;
+        int position;
+    };
+    std::vector<GroupItem> sorted_clips;
+    sorted_clips.reserve(all_clips.size());
+    for (int clip : all_clips) {
+        int position = isClip(clip) ? m_allClips[clip]->getPosition() : m_allCompositions[clip]->getPosition();
+        sorted_clips.push_back({clip, getTrackPosition(getItemTrackId(clip)), position});
+    }
     // we have to sort clip in an order that allows to do the move without self conflicts
     // If we move up, we move first the clips on the upper tracks (and conversely).
     // If we move left, we move first the leftmost clips (and conversely).
-    std::sort(sorted_clips.begin(), sorted_clips.end(), [delta_track, delta_pos, this](int clipId1, int clipId2) {
-        int trackId1 = getItemTrackId(clipId1);
-        int trackId2 = getItemTrackId(clipId2);
-        int track_pos1 = getTrackPosition(trackId1);
-        int track_pos2 = getTrackPosition(trackId2);
-        if (trackId1 == trackId2) {
-            int p1 = isClip(clipId1) ? m_allClips[clipId1]->getPosition() : m_allCompositions[clipId1]->getPosition();
-            int p2 = isClip(clipId2) ? m_allClips[clipId2]->getPosition() : m_allCompositions[clipId2]->getPosition();
-            return !(p1 <= p2) == !(delta_pos <= 0);
-        }
-        return !(track_pos1 <= track_pos2) == !(delta_track <= 0);
+    std::sort(sorted_clips.begin(), sorted_clips.end(), [delta_track, delta_pos](const GroupItem &item1, const GroupItem &item2) {
+        if (item1.trackPosition == item2.trackPosition) {
+            return !(item1.position <= item2.position) == !(delta_pos <= 0);
+        }
+        return !(item1.trackPosition <= item2.trackPosition) == !(delta_track <= 0);
     });
-    for (int clip : sorted_clips) {
-        int current_track_id = getItemTrackId(clip);
-        int current_track_position = getTrackPosition(current_track_id);
-        int target_track_position = current_track_position + delta_track;
-        if (target_track_position >= 0 && target_track_position < getTracksCount()) {
-            auto it = m_allTracks.cbegin();
-            std::advance(it, target_track_position);
-            int target_track = (*it)->getId();
+    // Moving a large group item per item would notify the view for every clip, send the net changes once instead.
+    // Interactive moves (finalMove false, as in spacer drags) are sent as they happen
+    std::unique_ptr<TimelineEditTransaction> transaction;
+    if (updateView && finalMove && sorted_clips.size() > BatchedEditSize) {
+        transaction.reset(new TimelineEditTransaction(this));
+    }
+    const int tracksCount = (int)m_allTracks.size();
+    for (const GroupItem &item : sorted_clips) {
+        int clip = item.id;
+        int target_track_position = item.trackPosition + delta_track;
+        if (target_track_position >= 0 && target_track_position < tracksCount) {
+            int target_track = m_allTracks[(size_t)target_track_position]->getId();
             if (isClip(clip)) {
                 int target_position = m_allClips[clip]->getPosition() + delta_pos;
                 ok = requestClipMove(clip, target_track, target_position, updateView, finalMove, undo, redo);
@@ -1203,12 +1214,10 @@ void TimelineModel::registerTrack(std::shared_ptr<TrackModel> track, int pos, bo
     }
 
     // we now insert in the list
-    auto posIt = m_allTracks.begin();
-    std::advance(posIt, pos);
-    auto it = m_allTracks.insert(posIt, std::move(track));
-    // it now contains the iterator to the inserted element, we store it
-    Q_ASSERT(m_iteratorTable.count(id) == 0); // check that id is not used (shouldn't happen)
-    m_iteratorTable[id] = it;
+    Q_ASSERT(m_trackPositions.count(id) == 0); // check that id is not used (shouldn't happen)
+    m_allTracks.insert(m_allTracks.begin() + pos, std::move(track));
+    // the tracks after the inserted one moved by one position
+    updateTrackPositions(pos);
     if (reloadView) {
         // don't reload view on each track load on project opening
         _resetView();
@@ -1236,12 +1245,12 @@ Fun TimelineModel::deregisterTrack_lambda(int id, bool updateView)
 {
     return [this, id, updateView]() {
         qDebug() << "DEREGISTER TRACK" << id;
-        auto it = m_iteratorTable[id];                        // iterator to the element
-        int index = getTrackPosition(id);                     // compute index in list
+        int index = getTrackPosition(id);                     // index in list
         m_tractor->remove_track(static_cast<int>(index + 1)); // melt operation, add 1 to account for black background track
         // send update to the model
-        m_allTracks.erase(it);     // actual deletion of object
-        m_iteratorTable.erase(id); // clean table
+        m_allTracks.erase(m_allTracks.begin() + index); // actual deletion of object
+        m_trackPositions.erase(id);                     // clean table
+        updateTrackPositions(index);
         if (updateView) {
             QModelIndex root;
             _resetView();
@@ -1272,22 +1281,29 @@ void TimelineModel::deregisterGroup(int id)
     m_allGroups.erase(id);
 }
 
+void TimelineModel::updateTrackPositions(int from)
+{
+    for (int pos = from; pos < (int)m_allTracks.size(); ++pos) {
+        m_trackPositions[m_allTracks[(size_t)pos]->getId()] = pos;
+    }
+}
+
 std::shared_ptr<TrackModel> TimelineModel::getTrackById(int trackId)
 {
-    Q_ASSERT(m_iteratorTable.count(trackId) > 0);
-    return *m_iteratorTable[trackId];
+    Q_ASSERT(m_trackPositions.count(trackId) > 0);
+    return m_allTracks[(size_t)m_trackPositions.at(trackId)];
 }
 
 const std::shared_ptr<TrackModel> TimelineModel::getTrackById_const(int trackId) const
 {
-    Q_ASSERT(m_iteratorTable.count(trackId) > 0);
-    return *m_iteratorTable.at(trackId);
+    Q_ASSERT(m_trackPositions.count(trackId) > 0);
+    return m_allTracks[(size_t)m_trackPositions.at(trackId)];
 }
 
 bool TimelineModel::addTrackEffect(int trackId, const QString &effectId)
 {
-    Q_ASSERT(m_iteratorTable.count(trackId) > 0);
-    return (*m_iteratorTable.at(trackId))->addEffect(effectId);
+    Q_ASSERT(m_trackPositions.count(trackId) > 0);
+    return m_allTracks[(size_t)m_trackPositions.at(trackId)]->addEffect(effectId);
 }
 
 std::shared_ptr<ClipModel> TimelineModel::getClipPtr(int clipId) const
@@ -1360,7 +1376,7 @@ bool TimelineModel::isComposition(int id) const
 
 bool TimelineModel::isTrack(int id) const
 {
-    return m_iteratorTable.count(id) > 0;
+    return m_trackPositions.count(id) > 0;
 }
 
 bool TimelineModel::isGroup(int id) const
@@ -1370,10 +1386,13 @@ bool TimelineModel::isGroup(int id) const
 
 void TimelineModel::updateDuration()
 {
+    if (m_transactionDepth > 0) {
+        m_transactionDurationChanged = true;
+        return;
+    }
     int current = m_blackClip->get_playtime();
     int duration = 10;
-    for (const auto &tck : m_iteratorTable) {
-        auto track = (*tck.second);
+    for (const auto &track : m_allTracks) {
         duration = qMax(duration, track->trackDuration());
     }
     if (duration != current) {
@@ -1402,7 +1421,7 @@ Mlt::Profile *TimelineModel::getProfile()
 bool TimelineModel::requestReset(Fun &undo, Fun &redo)
 {
     std::vector<int> all_ids;
-    for (const auto &track : m_iteratorTable) {
+    for (const auto &track : m_trackPositions) {
         all_ids.push_back(track.first);
     }
     bool ok = true;
@@ -1412,6 +1431,59 @@ bool TimelineModel::requestReset(Fun &undo, Fun &redo)
     return ok;
 }
 
+void TimelineModel::beginLoad()
+{
+    beginEditTransaction();
+}
+
+bool TimelineModel::endLoad()
+{
+    bool ok = true;
+    if (!m_allCompositions.empty()) {
+        ok = replantCompositions(-1, false);
+    }
+    // Nothing was sent to the view while loading
+    m_transactionResetView = true;
+    endEditTransaction();
+    return ok;
+}
+
+bool TimelineModel::loadClip(int clipId, int trackId, int position)
+{
+    QWriteLocker locker(&m_lock);
+    Q_ASSERT(isClip(clipId) && isTrack(trackId));
+    Q_ASSERT(getClipTrackId(clipId) == -1);
+    return getTrackById(trackId)->loadClip(clipId, position);
+}
+
+bool TimelineModel::loadComposition(const QString &transitionId, int trackId, int compositionTrack, int position, int length, Mlt::Properties *transProps,
+                                    int &id)
+{
+    QWriteLocker locker(&m_lock);
+    Q_ASSERT(isTrack(trackId));
+    if (compositionTrack == -1 || (compositionTrack > 0 && trackId == getTrackIndexFromPosition(compositionTrack - 1))) {
+        compositionTrack = getPreviousVideoTrackPos(trackId);
+    }
+    if (compositionTrack == -1) {
+        // it doesn't make sense to insert a composition on the last track
+        id = -1;
+        return false;
+    }
+    int compositionId = TimelineModel::getNextId();
+    CompositionModel::construct(shared_from_this(), transitionId, compositionId, transProps);
+    auto composition = m_allCompositions[compositionId];
+    // Set the final length before the insertion, so that no resize is needed
+    composition->setInOut(position, position + length - 1);
+    if (!getTrackById(trackId)->requestCompositionInsertion_lambda(compositionId, position, false)()) {
+        deregisterComposition_lambda(compositionId)();
+        id = -1;
+        return false;
+    }
+    composition->setATrack(compositionTrack, compositionTrack <= 0 ? -1 : getTrackIndexFromPosition(compositionTrack - 1));
+    id = compositionId;
+    return true;
+}
+
 void TimelineModel::setUndoStack(std::weak_ptr<DocUndoStack> undo_stack)
 {
     m_undoStack = std::move(undo_stack);
@@ -1706,7 +1778,8 @@ bool TimelineModel::replantCompositions(int currentCompo, bool updateView)
         // Note: we need to retrieve the position of the track, that is its melt index.
         int trackPos = getTrackMltIndex(trackId);
         compos.push_back({trackPos, compo.first});
-        if (compo.first != currentCompo) {
+        // Compositions created by loadComposition() are not planted yet
+        if (compo.first != currentCompo && mlt_service_consumer(compo.second->get_service()) != nullptr) {
             unplantComposition(compo.first);
         }
     }
@@ -1795,8 +1868,12 @@ bool TimelineModel::unplantComposition(int compoId)
 
 bool TimelineModel::checkConsistency()
 {
-    for (const auto &tck : m_iteratorTable) {
-        auto track = (*tck.second);
+    for (const auto &tck : m_trackPositions) {
+        auto track = m_allTracks[(size_t)tck.second];
+        if (track->getId() != tck.first) {
+            qDebug() << "Wrong position stored for track" << tck.first;
+            return false;
+        }
         // Check parent/children link for tracks
         if (auto ptr = track->m_parent.lock()) {
             if (ptr.get() != this) {
@@ -1997,12 +2074,90 @@ Mlt::Producer *TimelineModel::producer()
 
 void TimelineModel::checkRefresh(int start, int end)
 {
+    if (m_transactionDepth > 0) {
+        m_transactionRefresh.push_back({start, end});
+        return;
+    }
     int currentPos = tractor()->position();
     if (currentPos >= start && currentPos < end) {
         emit requestMonitorRefresh();
     }
 }
 
+void TimelineModel::invalidateRange(int in, int out)
+{
+    if (m_transactionDepth > 0) {
+        m_transactionInvalidate.push_back({in, out});
+        return;
+    }
+    emit invalidateZone(in, out);
+}
+
+void TimelineModel::beginEditTransaction()
+{
+    m_transactionDepth++;
+}
+
+void TimelineModel::endEditTransaction()
+{
+    Q_ASSERT(m_transactionDepth > 0);
+    if (--m_transactionDepth > 0) {
+        return;
+    }
+    const bool reset = m_transactionResetView;
+    m_transactionResetView = false;
+    _sendDeferredViewUpdates(reset);
+    if (m_transactionDurationChanged) {
+        m_transactionDurationChanged = false;
+        updateDuration();
+    }
+    // Send one invalidation per group of overlapping or adjacent ranges
+    std::vector<std::pair<int, int>> ranges;
+    std::swap(ranges, m_transactionInvalidate);
+    std::sort(ranges.begin(), ranges.end());
+    for (size_t i = 0; i < ranges.size();) {
+        int in = ranges[i].first;
+        int out = ranges[i].second;
+        for (++i; i < ranges.size() && ranges[i].first <= out; ++i) {
+            out = std::max(out, ranges[i].second);
+        }
+        emit invalidateZone(in, out);
+    }
+    std::vector<std::pair<int, int>> refresh;
+    std::swap(refresh, m_transactionRefresh);
+    int currentPos = tractor()->position();
+    for (const auto &range : refresh) {
+        if (currentPos >= range.first && currentPos < range.second) {
+            emit requestMonitorRefresh();
+            break;
+        }
+    }
+}
+
+bool TimelineModel::isInEditTransaction() const
+{
+    return m_transactionDepth > 0;
+}
+
+Fun TimelineModel::inEditTransaction(const Fun &operation)
+{
+    return [this, operation]() {
+        TimelineEditTransaction transaction(this);
+        return operation();
+    };
+}
+
+TimelineEditTransaction::TimelineEditTransaction(TimelineModel *timeline)
+    : m_timeline(timeline)
+{
+    m_timeline->beginEditTransaction();
+}
+
+TimelineEditTransaction::~TimelineEditTransaction()
+{
+    m_timeline->endEditTransaction();
+}
+
 void TimelineModel::clearAssetView(int itemId)
 {
     emit requestClearAssetView(itemId);
@@ -426,6 +426,28 @@ public:
     /* @brief Removes all the elements on the timeline (tracks and clips)
      */
     bool requestReset(Fun &undo, Fun &redo);
+
+    /* @brief Starts the loading of a project. Until endLoad(), items must be inserted with loadClip() and loadComposition(),
+       that build the model directly, without undo history nor view notification.
+     */
+    void beginLoad();
+    /* @brief Finishes the loading of a project: plants the loaded compositions and resets the view once.
+       Returns false if the compositions could not be planted
+     */
+    bool endLoad();
+    /* @brief Inserts a newly constructed clip in a track while loading a project. Returns false if the track has no room for it
+       @param clipId is the id of the clip
+       @param trackId is the id of the target track
+       @param position is the position where to insert the clip
+    */
+    bool loadClip(int clipId, int trackId, int position);
+    /* @brief Creates a composition while loading a project, it is only planted in endLoad(). Returns false if it cannot be inserted
+       @param transitionId is the identifier of the composition
+       @param trackId is the id of the target track
+       @param compositionTrack is the mlt index of the track the composition applies to, or -1 for the previous video track
+       @param id return parameter of the id of the inserted composition
+    */
+    bool loadComposition(const QString &transitionId, int trackId, int compositionTrack, int position, int length, Mlt::Properties *transProps, int &id);
     /* @brief Updates the current the pointer to the current undo_stack
        Must be called for example when the doc change
     */
@@ -520,6 +542,9 @@ protected:
      */
     void registerTrack(std::shared_ptr<TrackModel> track, int pos = -1, bool doInsert = true, bool reloadView = true);
 
+    /* @brief Updates the stored position of the tracks from the given position to the last one, after an insertion or a deletion */
+    void updateTrackPositions(int from);
+
     /* @brief Register a new clip. This is a call-back meant to be called from ClipModel
     */
     void registerClip(const std::shared_ptr<ClipModel> &clip);
@@ -584,10 +609,32 @@ public:
     /* @brief Debugging function that checks consistency with Mlt objects */
     bool checkConsistency();
 
+    /* @brief Starts an edit transaction. Until the matching endEditTransaction(), the view notifications, monitor refreshes,
+       preview invalidations and duration updates are collected instead of being sent. When the outermost transaction ends, the
+       row changes of each track are sent as the net rows removed and inserted, the data changes are sent once per item, the
+       monitor is refreshed once and the invalidated ranges are merged.
+       Transactions can be nested. Use it around final operations that modify more than BatchedEditSize items, never during
+       interactive moves. See TimelineEditTransaction.
+     */
+    void beginEditTransaction();
+    void endEditTransaction();
+
+    /* @brief Returns true while an edit transaction is running */
+    bool isInEditTransaction() const;
+
+    /* @brief Returns an operation running the given one inside an edit transaction, so that undoing or redoing a bulk operation is batched too */
+    Fun inEditTransaction(const Fun &operation);
+
+    /* @brief Number of items above which a final edit is run in an edit transaction */
+    static const size_t BatchedEditSize = 20;
+
 protected:
     /* @brief Refresh project monitor if cursor was inside range */
     void checkRefresh(int start, int end);
 
+    /* @brief Invalidate the timeline preview of a range. During an edit transaction, the range is only stored */
+    void invalidateRange(int in, int out);
+
     /* @brief Send signal to require clearing effet/composition view */
     void clearAssetView(int itemId);
 
@@ -603,10 +650,10 @@ signals:
 protected:
     std::unique_ptr<Mlt::Tractor> m_tractor;
 
-    std::list<std::shared_ptr<TrackModel>> m_allTracks;
+    std::vector<std::shared_ptr<TrackModel>> m_allTracks; // the tracks, ordered by position
 
-    std::unordered_map<int, std::list<std::shared_ptr<TrackModel>>::iterator>
-        m_iteratorTable; // this logs the iterator associated which each track id. This allows easy access of a track based on its id.
+    std::unordered_map<int, int> m_trackPositions; // position of each track id in m_allTracks. This gives constant time access to a track and its position
+                                                   // based on its id, it is updated by registerTrack() and deregisterTrack_lambda()
 
     std::unordered_map<int, std::shared_ptr<ClipModel>> m_allClips; // the keys are the clip id, and the values are the corresponding pointers
 
@@ -646,6 +693,14 @@ protected:
     // The preferred video target for clip insertion or -1 if not defined
     int m_videoTarget;
 
+    // Number of nested edit transactions running
+    int m_transactionDepth;
+    // What the running edit transaction has to send when it ends. The view is reset instead of updated if the tracks themselves changed
+    bool m_transactionResetView;
+    bool m_transactionDurationChanged;
+    std::vector<std::pair<int, int>> m_transactionRefresh;
+    std::vector<std::pair<int, int>> m_transactionInvalidate;
+
     // what follows are some virtual function that corresponds to the QML. They are implemented in TimelineItemModel
 protected:
     virtual void _beginRemoveRows(const QModelIndex &, int, int) = 0;
@@ -658,5 +713,19 @@ protected:
     virtual QModelIndex makeCompositionIndexFromID(int) const = 0;
     virtual QModelIndex makeTrackIndexFromID(int) const = 0;
     virtual void _resetView() = 0;
+    /* @brief Sends the view notifications collected during an edit transaction, or resets the view if reset is true */
+    virtual void _sendDeferredViewUpdates(bool reset) = 0;
+};
+
+/* @brief This class runs an edit transaction on a timeline for its lifetime, see TimelineModel::beginEditTransaction()
+ */
+class TimelineEditTransaction
+{
+public:
+    explicit TimelineEditTransaction(TimelineModel *timeline);
+    ~TimelineEditTransaction();
+
+private:
+    TimelineModel *m_timeline;
 };
 #endif
@@ -125,11 +125,13 @@ Fun TrackModel::requestClipInsertion_lambda(int clipId, int position, bool updat
         if (auto ptr = m_parent.lock()) {
             std::shared_ptr<ClipModel> clip = ptr->getClipPtr(clipId);
             m_allClips[clip->getId()] = clip; // store clip
+            m_clipRows.insert(clip->getId());
             // update clip position and track
             clip->setPosition(position);
             clip->setCurrentTrackId(getId());
             int new_in = clip->getPosition();
             int new_out = new_in + clip->getPlaytime();
+            m_clipIntervals.insert(clipId, new_in, new_out - 1);
             ptr->m_snaps->addPoint(new_in);
             ptr->m_snaps->addPoint(new_out);
             if (updateView) {
@@ -143,7 +145,7 @@ Fun TrackModel::requestClipInsertion_lambda(int clipId, int position, bool updat
                     ptr->checkRefresh(new_in, new_out);
                 }
                 if (!audioOnly && finalMove && !isAudioTrack()) {
-                    ptr->invalidateZone(new_in, new_out);
+                    ptr->invalidateRange(new_in, new_out);
                 }
             }
             return true;
@@ -200,6 +202,46 @@ Fun TrackModel::requestClipInsertion_lambda(int clipId, int position, bool updat
     return []() { return false; };
 }
 
+bool TrackModel::loadClip(int clipId, int position)
+{
+    QWriteLocker locker(&m_lock);
+    auto ptr = m_parent.lock();
+    if (!ptr) {
+        qDebug() << "Error : Clip loading failed because timeline is not available anymore";
+        return false;
+    }
+    int length = m_playlists[0].get_playtime();
+    if (position < length) {
+        // The clip is not after the last one, find the blank where it goes
+        return requestClipInsertion_lambda(clipId, position, false, false)();
+    }
+    // Same as insert_at past the end of the playlist, without consolidating all the blanks for each clip
+    std::shared_ptr<ClipModel> clip = ptr->getClipPtr(clipId);
+    m_playlists[0].lock();
+    const bool addBlank = position > length;
+    if (addBlank) {
+        m_playlists[0].blank(position - length - 1);
+    }
+    int res = m_playlists[0].append(*clip);
+    if (res != 0 && addBlank) {
+        // Leave the track as it was
+        m_playlists[0].remove(m_playlists[0].count() - 1);
+    }
+    m_playlists[0].unlock();
+    if (res != 0) {
+        return false;
+    }
+    m_allClips[clipId] = clip;
+    m_clipRows.insert(clipId);
+    clip->setPosition(position);
+    clip->setCurrentTrackId(getId());
+    int out = position + clip->getPlaytime();
+    m_clipIntervals.insert(clipId, position, out - 1);
+    ptr->m_snaps->addPoint(position);
+    ptr->m_snaps->addPoint(out);
+    return true;
+}
+
 bool TrackModel::requestClipInsertion(int clipId, int position, bool updateView, bool finalMove,  Fun &undo, Fun &redo)
 {
     QWriteLocker locker(&m_lock);
@@ -230,6 +272,8 @@ void TrackModel::replugClip(int clipId)
     m_playlists[target_track].consolidate_blanks();
     delete prod;
     m_playlists[target_track].unlock();
+    // The clip duration may have changed, for example with a speed change
+    m_clipIntervals.insert(clipId, clip_position, clip_position + m_allClips[clipId]->getPlaytime() - 1);
 }
 
 Fun TrackModel::requestClipDeletion_lambda(int clipId, bool updateView, bool finalMove)
@@ -259,12 +303,14 @@ Fun TrackModel::requestClipDeletion_lambda(int clipId, bool updateView, bool fin
             if (finalMove && !audioOnly && !isAudioTrack()) {
                 if (auto ptr = m_parent.lock()) {
                     //qDebug() << "/// INVALIDATE CLIP ON DELETE!!!!!!";
-                    ptr->invalidateZone(old_in, old_out);
+                    ptr->invalidateRange(old_in, old_out);
                 }
             }
             m_playlists[target_track].consolidate_blanks();
             m_allClips[clipId]->setCurrentTrackId(-1);
             m_allClips.erase(clipId);
+            m_clipRows.remove(clipId);
+            m_clipIntervals.remove(clipId);
             delete prod;
             m_playlists[target_track].unlock();
             if (auto ptr = m_parent.lock()) {
@@ -398,6 +444,7 @@ Fun TrackModel::requestClipResize_lambda(int clipId, int in, int out, bool right
     }
 
     auto update_snaps = [clipId, old_in, old_out, checkRefresh, this](int new_in, int new_out) {
+        m_clipIntervals.insert(clipId, new_in, new_out - 1);
         if (auto ptr = m_parent.lock()) {
             ptr->m_snaps->removePoint(old_in);
             ptr->m_snaps->removePoint(old_out);
@@ -528,75 +575,33 @@ int TrackModel::getId() const
 int TrackModel::getClipByPosition(int position)
 {
     READ_LOCK();
-    QSharedPointer<Mlt::Producer> prod(nullptr);
-    if (m_playlists[0].count() > 0) {
-        prod = QSharedPointer<Mlt::Producer>(m_playlists[0].get_clip_at(position));
-    }
-    if ((!prod || prod->is_blank()) && m_playlists[1].count() > 0) {
-        prod = QSharedPointer<Mlt::Producer>(m_playlists[1].get_clip_at(position));
-    }
-    if (!prod || prod->is_blank()) {
-        return -1;
-    }
-    return prod->get_int("_kdenlive_cid");
+    return m_clipIntervals.firstOverlapping(position, position);
 }
 
 int TrackModel::getCompositionByPosition(int position)
 {
     READ_LOCK();
-    for (const auto &comp : m_compoPos) {
-        if (comp.first == position) {
-            return comp.second;
-        } else if (comp.first < position) {
-            if (comp.first + m_allCompositions[comp.second]->getPlaytime() >= position) {
-                return comp.second;
-            }
-        }
-    }
-    return -1;
+    return m_compositionIntervals.firstOverlapping(position, position);
 }
 
 int TrackModel::getClipByRow(int row) const
 {
     READ_LOCK();
-    if (row >= static_cast<int>(m_allClips.size())) {
-        return -1;
-    }
-    auto it = m_allClips.cbegin();
-    std::advance(it, row);
-    return (*it).first;
+    return m_clipRows.at(row);
 }
 
 std::unordered_set<int> TrackModel::getClipsAfterPosition(int position, int end)
 {
     READ_LOCK();
-    // TODO: this function doesn't take into accounts the fact that there are two tracks
-    std::unordered_set<int> ids;
-    int ix = m_playlists[0].get_clip_index_at(position);
-    if (end > -1) {
-        end = m_playlists[0].get_clip_index_at(end);
-        if (end < m_playlists[0].count()) {
-            end++;
-        }
-    } else {
-        end = m_playlists[0].count();
-    }
-    while (ix < end) {
-        QSharedPointer<Mlt::Producer> prod(m_playlists[0].get_clip(ix));
-        ix++;
-        if (prod->is_blank()) {
-            continue;
-        }
-        ids.insert(prod->get_int("_kdenlive_cid"));
-    }
-    return ids;
+    std::vector<int> found = m_clipIntervals.overlapping(position, end > -1 ? end : INT_MAX);
+    return std::unordered_set<int>(found.begin(), found.end());
 }
 
 int TrackModel::getRowfromClip(int clipId) const
 {
     READ_LOCK();
     Q_ASSERT(m_allClips.count(clipId) > 0);
-    return (int)std::distance(m_allClips.begin(), m_allClips.find(clipId));
+    return m_clipRows.rank(clipId);
 }
 
 std::unordered_set<int> TrackModel::getCompositionsAfterPosition(int position, int end)
@@ -604,12 +609,12 @@ std::unordered_set<int> TrackModel::getCompositionsAfterPosition(int position, i
     READ_LOCK();
     // TODO: this function doesn't take into accounts the fact that there are two tracks
     std::unordered_set<int> ids;
-    for (const auto &compo : m_allCompositions) {
-        int pos = compo.second->getPosition();
-        if (pos > position && pos < end) {
-            if (compo.second->getPlaytime() < end - position) {
-                ids.insert(compo.first);
-            }
+    // Compositions starting in the range also overlap it
+    for (int compoId : m_compositionIntervals.overlapping(position + 1, end - 1)) {
+        const auto &compo = m_allCompositions.at(compoId);
+        int pos = compo->getPosition();
+        if (pos > position && pos < end && compo->getPlaytime() < end - position) {
+            ids.insert(compoId);
         }
     }
     return ids;
@@ -619,7 +624,7 @@ int TrackModel::getRowfromComposition(int tid) const
 {
     READ_LOCK();
     Q_ASSERT(m_allCompositions.count(tid) > 0);
-    return (int)m_allClips.size() + (int)std::distance(m_allCompositions.begin(), m_allCompositions.find(tid));
+    return (int)m_allClips.size() + m_compositionRows.rank(tid);
 }
 
 QVariant TrackModel::getProperty(const QString &name) const
@@ -693,8 +698,14 @@ bool TrackModel::checkConsistency()
             }
         }
     }
+    for (const auto &c : clips) {
+        if (m_clipIntervals.firstOverlapping(c.first, c.first) == -1) {
+            qDebug() << "Error: the range of clip " << c.second << " is not properly stored";
+            return false;
+        }
+    }
     // We now check compositions positions
-    if (m_allCompositions.size() != m_compoPos.size()) {
+    if (m_allCompositions.size() != m_compoPos.size() || (int)m_allCompositions.size() != m_compositionIntervals.size()) {
         qDebug() << "Error: the number of compositions position doesn't match number of compositions";
         return false;
     }
@@ -828,11 +839,14 @@ Fun TrackModel::requestCompositionResize_lambda(int compoId, int in, int out)
         return []() { return true; };
     }
 
-    // temporary remove of current compo to check collisions
-    m_compoPos.erase(compo_position);
-    bool intersecting = hasIntersectingComposition(in, out);
-    // put it back
-    m_compoPos[compo_position] = compoId;
+    // check collisions with the other compositions
+    bool intersecting = false;
+    for (int id : m_compositionIntervals.overlapping(in, out)) {
+        if (id != compoId) {
+            intersecting = true;
+            break;
+        }
+    }
 
     if (intersecting) {
         return []() { return false; };
@@ -841,6 +855,7 @@ Fun TrackModel::requestCompositionResize_lambda(int compoId, int in, int out)
     return [in, out, compoId, update_snaps, this]() {
         m_compoPos.erase(m_allCompositions[compoId]->getPosition());
         m_allCompositions[compoId]->setInOut(in, out);
+        m_compositionIntervals.insert(compoId, in, out);
         update_snaps(in, out + 1);
         m_compoPos[m_allCompositions[compoId]->getPosition()] = compoId;
         return true;
@@ -892,6 +907,8 @@ Fun TrackModel::requestCompositionDeletion_lambda(int compoId, bool updateView)
         }
         m_allCompositions[compoId]->setCurrentTrackId(-1);
         m_allCompositions.erase(compoId);
+        m_compositionRows.remove(compoId);
+        m_compositionIntervals.remove(compoId);
         m_compoPos.erase(old_in);
         ptr->m_snaps->removePoint(old_in);
         ptr->m_snaps->removePoint(old_out);
@@ -905,10 +922,7 @@ int TrackModel::getCompositionByRow(int row) const
     if (row < (int)m_allClips.size()) {
         return -1;
     }
-    // Q_ASSERT(row <= (int)m_allClips.size() + m_allCompositions.size());
-    auto it = m_allCompositions.cbegin();
-    std::advance(it, row - (int)m_allClips.size());
-    return (*it).first;
+    return m_compositionRows.at(row - (int)m_allClips.size());
 }
 
 int TrackModel::getCompositionsCount() const
@@ -931,6 +945,7 @@ Fun TrackModel::requestCompositionInsertion_lambda(int compoId, int position, bo
             if (auto ptr = m_parent.lock()) {
                 std::shared_ptr<CompositionModel> composition = ptr->getCompositionPtr(compoId);
                 m_allCompositions[composition->getId()] = composition; // store clip
+                m_compositionRows.insert(composition->getId());
                 // update clip position and track
                 composition->setCurrentTrackId(getId());
                 int new_in = position;
@@ -944,6 +959,7 @@ Fun TrackModel::requestCompositionInsertion_lambda(int compoId, int position, bo
                 ptr->m_snaps->addPoint(new_in);
                 ptr->m_snaps->addPoint(new_out);
                 m_compoPos[new_in] = composition->getId();
+                m_compositionIntervals.insert(composition->getId(), new_in, new_out - 1);
                 return true;
             }
             qDebug() << "Error : Composition Insertion failed because timeline is not available anymore";
@@ -957,22 +973,7 @@ Fun TrackModel::requestCompositionInsertion_lambda(int compoId, int position, bo
 bool TrackModel::hasIntersectingComposition(int in, int out) const
 {
     READ_LOCK();
-    auto it = m_compoPos.lower_bound(in);
-    if (m_compoPos.empty()) {
-        return false;
-    }
-    if (it != m_compoPos.end() && it->first <= out) {
-        // compo at it intersects
-        return true;
-    }
-    if (it == m_compoPos.begin()) {
-        return false;
-    }
-    --it;
-    int end = it->first + m_allCompositions.at(it->second)->getPlaytime() - 1;
-    return end >= in;
-
-    return false;
+    return m_compositionIntervals.firstOverlapping(in, out) != -1;
 }
 
 bool TrackModel::addEffect(const QString &effectId)
@@ -22,6 +22,8 @@
 #ifndef TRACKMODEL_H
 #define TRACKMODEL_H
 
+#include "intervalindex.hpp"
+#include "rankindex.hpp"
 #include "undohelper.hpp"
 #include <QReadWriteLock>
 #include <QSharedPointer>
@@ -119,6 +121,14 @@ protected:
     /* @brief This function returns a lambda that performs the requested operation */
     Fun requestClipInsertion_lambda(int clipId, int position, bool updateView, bool finalMove);
 
+    /* @brief Inserts the given clip while loading a project, without undo nor view update.
+       Clips are expected in increasing position order, so that they are appended to the playlist. Otherwise, this falls back to the regular insertion.
+       Returns true if the operation succeeded, and otherwise, the track is not modified.
+       @param clipId is the id of the clip
+       @param position is the position where to insert the clip
+    */
+    bool loadClip(int clipId, int position);
+
     /* @brief Performs an deletion of the given clip.
        Returns true if the operation succeeded, and otherwise, the track is not modified.
        This method is protected because it shouldn't be called directly. Call the function in the timeline instead.
@@ -229,6 +239,13 @@ private:
         m_allCompositions; /*this is important to keep an
                                    ordered structure to store the clips, since we use their ids order as row order*/
 
+    // Row of the clips and compositions, kept in sync with m_allClips and m_allCompositions so that row <-> id lookups are logarithmic
+    RankIndex m_clipRows;
+    RankIndex m_compositionRows;
+    // Frame ranges of the clips and compositions, updated by the insertion, deletion and resize lambdas, so that position queries do not go through MLT
+    IntervalIndex m_clipIntervals;
+    IntervalIndex m_compositionIntervals;
+
     std::map<int, int> m_compoPos; // We store the positions of the compositions. In Melt, the compositions are not inserted at the track level, but we keep
                                    // those positions here to check for moves and resize
 
@@ -0,0 +1,101 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by the Kdenlive developers                         *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef TREAP_H
+#define TREAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/** @brief Helpers shared by the treaps of the tracks (RankIndex, IntervalIndex).
+    Nodes are stored contiguously in a vector and referenced by index, -1 being the empty tree. A node type provides
+    left, right and priority members; the key order and the data maintained over subtrees are given by the callers.
+ */
+namespace Treap {
+
+/* @brief Returns the priority of the node of an id. This is the Murmur3 finalizer: any well mixed hash keeps the tree
+   balanced, and the shape of the tree only depends on its content */
+inline uint32_t idPriority(int id)
+{
+    auto h = static_cast<uint32_t>(id);
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+/* @brief Stores a node, reusing a removed one if any, and returns its index */
+template <typename Node> int allocate(std::vector<Node> &nodes, std::vector<int> &freeNodes, const Node &node)
+{
+    if (!freeNodes.empty()) {
+        int index = freeNodes.back();
+        freeNodes.pop_back();
+        nodes[(size_t)index] = node;
+        return index;
+    }
+    nodes.push_back(node);
+    return (int)nodes.size() - 1;
+}
+
+/* @brief Splits the tree rooted at node in the nodes for which before(node) is true, and the others
+   @param update recomputes the subtree data of a node whose children changed
+ */
+template <typename Node, typename Before, typename Update>
+void split(std::vector<Node> &nodes, int node, const Before &before, const Update &update, int &lower, int &upper)
+{
+    if (node < 0) {
+        lower = upper = -1;
+        return;
+    }
+    if (before(nodes[(size_t)node])) {
+        split(nodes, nodes[(size_t)node].right, before, update, nodes[(size_t)node].right, upper);
+        lower = node;
+    } else {
+        split(nodes, nodes[(size_t)node].left, before, update, lower, nodes[(size_t)node].left);
+        upper = node;
+    }
+    update(node);
+}
+
+/* @brief Merges two trees whose keys are all lower in the first one, and returns the root of the result */
+template <typename Node, typename Update> int merge(std::vector<Node> &nodes, int lower, int upper, const Update &update)
+{
+    if (lower < 0 || upper < 0) {
+        return lower < 0 ? upper : lower;
+    }
+    if (nodes[(size_t)lower].priority > nodes[(size_t)upper].priority) {
+        int right = merge(nodes, nodes[(size_t)lower].right, upper, update);
+        nodes[(size_t)lower].right = right;
+        update(lower);
+        return lower;
+    }
+    int left = merge(nodes, lower, nodes[(size_t)upper].left, update);
+    nodes[(size_t)upper].left = left;
+    update(upper);
+    return upper;
+}
+
+} // namespace Treap
+
+#endif
@@ -387,10 +387,10 @@ Rectangle {
                     height: waveform.height
                     showItem: waveform.visible && (index * waveform.maxWidth) < waveform.scrollEnd && (index * waveform.maxWidth + width) > waveform.scrollStart
                     format: timeline.audioThumbFormat
-                    property int channels: 2
-                    inPoint: Math.round((clipRoot.inPoint + index * waveform.maxWidth / timeScale) * speed) * channels
-                    outPoint: inPoint + Math.round(width / timeScale * speed) * channels
+                    inPoint: Math.round((clipRoot.inPoint + index * waveform.maxWidth / timeScale) * speed)
+                    outPoint: inPoint + Math.round(width / timeScale * speed)
                     levels: audioLevels
+                    binId: clipRoot.binId
                 }
             }
         }
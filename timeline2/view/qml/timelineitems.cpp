@@ -1,6 +1,10 @@
 
 
+#include "bin/projectclip.h"
+#include "bin/projectitemmodel.h"
+#include "core.h"
 #include "kdenlivesettings.h"
+#include "lib/audio/audioPeaks.h"
 #include <QLinearGradient>
 #include <QPainter>
 #include <QPainterPath>
@@ -43,6 +47,7 @@ class TimelineWaveform : public QQuickPaintedItem
     Q_PROPERTY(int outPoint MEMBER m_outPoint NOTIFY outPointChanged)
     Q_PROPERTY(bool format MEMBER m_format NOTIFY propertyChanged)
     Q_PROPERTY(bool showItem MEMBER m_showItem)
+    Q_PROPERTY(int binId READ binId WRITE setBinId NOTIFY propertyChanged)
 
 public:
     TimelineWaveform()
@@ -64,13 +69,62 @@ public:
         m_gradient.setSpread(QGradient::ReflectSpread);
     }
 
+    int binId() const { return m_binId; }
+
+    void setBinId(int id)
+    {
+        if (id == m_binId) return;
+        m_binId = id;
+        disconnect(m_detailConnection);
+        // Resolved here, on the GUI thread, since paint may run in the render thread
+        std::shared_ptr<ProjectClip> clip = pCore->projectItemModel()->getClipByBinID(QString::number(id));
+        m_clip = clip;
+        if (clip) {
+            m_detailConnection = connect(clip.get(), &ProjectClip::audioDetailReady, this, [this]() { update(); }, Qt::QueuedConnection);
+        }
+        emit propertyChanged();
+    }
+
     void paint(QPainter *painter) override
     {
         if (!m_showItem) return;
-        QVariantList data = m_audioLevels.toList();
-        if (data.isEmpty()) return;
+        auto peaks = m_audioLevels.value<std::shared_ptr<const AudioPeaks>>();
+        if (!peaks || peaks->count() == 0) return;
+        const int channels = peaks->channels();
 
-        const qreal indicesPrPixel = qreal(m_outPoint - m_inPoint) / width();
+        // Peaks are looked up by range in the pyramid, so that no peak is lost when a pixel covers many frames
+        const qreal framesPrPixel = qreal(m_outPoint - m_inPoint) / width();
+        const qreal indicesPrPixel = framesPrPixel * peaks->levelsPerFrame();
+        const qreal firstIndex = qreal(m_inPoint) * peaks->levelsPerFrame();
+        // When a frame is wider than 2 pixels, use the sub-frame peaks of the clip's detailed thumbnail
+        std::shared_ptr<ProjectClip> clip = m_clip.lock();
+        const bool useDetail = clip && framesPrPixel < 0.5 && KdenliveSettings::audiothumbdetail();
+        std::shared_ptr<const AudioPeaks> detail;
+        int detailChunk = -1;
+        bool missingDetail = false;
+        // Returns the thumbnail to read for pixel x, and the range of pairs to read in it
+        auto pixelRange = [&](int x, int &from, int &to) -> const AudioPeaks * {
+            if (useDetail) {
+                qreal start = m_inPoint + x * framesPrPixel;
+                int chunk = int(start) / ProjectClip::AudioDetailChunk;
+                if (chunk != detailChunk) {
+                    detailChunk = chunk;
+                    detail = clip->audioDetail(int(start));
+                    missingDetail = missingDetail || !detail;
+                }
+                if (detail) {
+                    qreal offset = start - chunk * ProjectClip::AudioDetailChunk;
+                    from = int(offset * ProjectClip::AudioDetailLevels);
+                    to = qMax(from + 1, int((offset + framesPrPixel) * ProjectClip::AudioDetailLevels));
+                    if (from < detail->count()) {
+                        return detail.get();
+                    }
+                }
+            }
+            from = int(firstIndex + x * indicesPrPixel);
+            to = qMax(from + 1, int(firstIndex + (x + 1) * indicesPrPixel));
+            return peaks.get();
+        };
         QPen pen = painter->pen();
         pen.setWidthF(0.5);
         pen.setColor(Qt::black);
@@ -84,55 +138,74 @@ public:
             path.moveTo(-1, height());
             int i = 0;
             int lastIdx = -1;
+            const AudioPeaks *lastSource = nullptr;
             for (; i < width(); ++i) {
-                int idx = m_inPoint + int(i * indicesPrPixel);
-                if (lastIdx == idx) {
+                int from, to;
+                const AudioPeaks *source = pixelRange(i, from, to);
+                if (lastIdx == from && lastSource == source) {
                     continue;
                 }
-                lastIdx = idx;
-                if (idx + 1 >= data.length()) break;
-                qreal level = qMax(data.at(idx).toReal(), data.at(idx + 1).toReal()) / 256;
-                path.lineTo(i, height() - level * height());
+                lastIdx = from;
+                lastSource = source;
+                if (from >= source->count()) break;
+                int level = 0;
+                for (int channel = 0; channel < channels; channel++) {
+                    qint16 min, max;
+                    source->range(channel, from, to, min, max);
+                    level = qMax(level, qMax(-(int)min, (int)max));
+                }
+                path.lineTo(i, height() - level / 32768. * height());
             }
             path.lineTo(i, height());
             painter->drawPath(path);
         } else {
             // Fill gradient
-            m_gradient.setFinalStop(0, height() / 4);
+            const qreal channelHeight = height() / (2 * channels);
+            m_gradient.setFinalStop(0, channelHeight);
             painter->setBrush(m_gradient);
 
             // Draw separate channels
-            QMap<int, QPainterPath> positiveChannelPaths;
-            QMap<int, QPainterPath> negativeChannelPaths;
-            // TODO: get channels count
-            int channels = 2;
             int i = 0;
             for (int channel = 0; channel < channels; channel++) {
-                int y = height() - (2 * channel + 1) * height() / 4;
-                positiveChannelPaths[channel].moveTo(-1, y);
-                negativeChannelPaths[channel].moveTo(-1, y);
+                int y = height() - (2 * channel + 1) * channelHeight;
+                QPainterPath positiveChannelPath;
+                QPainterPath negativeChannelPath;
+                positiveChannelPath.moveTo(-1, y);
+                negativeChannelPath.moveTo(-1, y);
                 // Draw channel median line
                 painter->drawLine(0, y, width(), y);
                 int lastIdx = -1;
+                const AudioPeaks *lastSource = nullptr;
                 for (i = 0; i < width(); ++i) {
-                    int idx = m_inPoint + int(i * indicesPrPixel);
-                    if (lastIdx == idx) {
+                    int from, to;
+                    const AudioPeaks *source = pixelRange(i, from, to);
+                    if (lastIdx == from && lastSource == source) {
                         continue;
                     }
-                    lastIdx = idx;
-                    if (idx + channel >= data.length()) break;
-                    qreal level = data.at(idx + channel).toReal() / 256;
-                    positiveChannelPaths[channel].lineTo(i, y - level * height() / 4);
-                    negativeChannelPaths[channel].lineTo(i, y + level * height() / 4);
+                    lastIdx = from;
+                    lastSource = source;
+                    if (from >= source->count()) break;
+                    qint16 min, max;
+                    source->range(channel, from, to, min, max);
+                    positiveChannelPath.lineTo(i, y - max / 32768. * channelHeight);
+                    negativeChannelPath.lineTo(i, y - min / 32768. * channelHeight);
                 }
+                positiveChannelPath.lineTo(i, y);
+                negativeChannelPath.lineTo(i, y);
+                painter->drawPath(positiveChannelPath);
+                painter->drawPath(negativeChannelPath);
             }
-            for (int channel = 0; channel < channels; channel++) {
-                int y = height() - (2 * channel + 1) * height() / 4;
-                positiveChannelPaths[channel].lineTo(i, y);
-                negativeChannelPaths[channel].lineTo(i, y);
-                painter->drawPath(positiveChannelPaths.value(channel));
-                painter->drawPath(negativeChannelPaths.value(channel));
-            }
+        }
+        if (missingDetail) {
+            QMetaObject::invokeMethod(this, "requestDetail", Qt::QueuedConnection, Q_ARG(int, m_inPoint), Q_ARG(int, m_outPoint));
+        }
+    }
+
+public slots:
+    void requestDetail(int from, int to)
+    {
+        if (auto clip = m_clip.lock()) {
+            clip->requestAudioDetail(from, to);
         }
     }
 
@@ -149,6 +222,9 @@ private:
     bool m_format;
     QLinearGradient m_gradient;
     bool m_showItem;
+    int m_binId = -1;
+    std::weak_ptr<ProjectClip> m_clip;
+    QMetaObject::Connection m_detailConnection;
 };
 
 void registerTimelineItems()
@@ -29,6 +29,7 @@
 #include "dialogs/spacerdialog.h"
 #include "doc/kdenlivedoc.h"
 #include "kdenlivesettings.h"
+#include "lib/audio/audioEnvelope.h"
 #include "previewmanager.h"
 #include "project/projectmanager.h"
 #include "timeline2/model/clipmodel.hpp"
@@ -45,9 +46,32 @@
 #include <QApplication>
 #include <QInputDialog>
 #include <QQuickItem>
+#include <QtConcurrent>
 
 int TimelineController::m_duration = 0;
 
+namespace {
+// Alignments below this confidence are considered wrong and not applied
+const double minimumAlignConfidence = 0.1;
+
+// What is needed to compute the audio envelope of a timeline clip outside of the GUI thread
+struct AlignSource
+{
+    std::shared_ptr<Mlt::Producer> producer;
+    QString url;
+    QString cacheFile;
+    int in;
+    int length;
+};
+
+AudioEnvelope *createEnvelope(const AlignSource &source)
+{
+    auto *envelope = new AudioEnvelope(source.url, source.producer.get(), source.in, source.length);
+    envelope->setCacheFile(source.cacheFile);
+    return envelope;
+}
+} // namespace
+
 TimelineController::TimelineController(KActionCollection *actionCollection, QObject *parent)
     : QObject(parent)
     , m_root(nullptr)
@@ -58,10 +82,12 @@ TimelineController::TimelineController(KActionCollection *actionCollection, QObj
     , m_activeTrack(0)
     , m_scale(3.0)
     , m_timelinePreview(nullptr)
+    , m_audioRef(-1)
 {
     m_disablePreview = pCore->currentDoc()->getAction(QStringLiteral("disable_preview"));
     connect(m_disablePreview, &QAction::triggered, this, &TimelineController::disablePreview);
     m_disablePreview->setEnabled(false);
+    connect(&m_alignWatcher, &QFutureWatcherBase::finished, this, &TimelineController::slotAudioAligned);
 }
 
 TimelineController::~TimelineController()
@@ -181,7 +207,7 @@ const QString TimelineController::getTrackNameFromIndex(int trackIndex)
 QMap<int, QString> TimelineController::getTrackNames(bool videoOnly)
 {
     QMap<int, QString> names;
-    for (const auto &track : m_model->m_iteratorTable) {
+    for (const auto &track : m_model->m_trackPositions) {
         if (videoOnly && m_model->getTrackById(track.first)->getProperty(QStringLiteral("kdenlive:audio_track")).toInt() == 1) {
             continue;
         }
@@ -1473,6 +1499,102 @@ void TimelineController::splitAudio(int clipId)
     TimelineFunctions::requestSplitAudio(m_model, clipId, audioTarget());
 }
 
+void TimelineController::setAudioRef()
+{
+    int clipId = getCurrentItem();
+    if (clipId == -1 || !m_model->isClip(clipId)) {
+        pCore->displayMessage(i18n("Select a clip to set as audio reference"), InformationMessage);
+        return;
+    }
+    m_audioRef = clipId;
+    pCore->displayMessage(i18n("Audio reference set"), InformationMessage);
+}
+
+void TimelineController::alignAudio()
+{
+    if (m_audioRef == -1 || !m_model->isClip(m_audioRef)) {
+        m_audioRef = -1;
+        pCore->displayMessage(i18n("Set an audio reference before aligning clips"), ErrorMessage);
+        return;
+    }
+    if (m_alignWatcher.isRunning()) {
+        pCore->displayMessage(i18n("Audio alignment already running"), InformationMessage);
+        return;
+    }
+    auto sourceFor = [this](int cid) {
+        std::shared_ptr<ProjectClip> binClip = pCore->bin()->getBinClip(m_model->getClipBinId(cid));
+        AlignSource source;
+        source.producer = binClip->originalProducer();
+        source.url = binClip->url();
+        source.cacheFile = binClip->getAudioEnvelopePath();
+        source.in = m_model->getClipIn(cid);
+        source.length = m_model->getClipPlaytime(cid);
+        return source;
+    };
+    AlignSource reference = sourceFor(m_audioRef);
+    QList<AlignSource> children;
+    m_alignClips.clear();
+    for (int cid : m_selection.selectedItems) {
+        if (cid != m_audioRef && m_model->isClip(cid)) {
+            m_alignClips << cid;
+            children << sourceFor(cid);
+        }
+    }
+    if (children.isEmpty()) {
+        pCore->displayMessage(i18n("Select the clips to align with the audio reference"), InformationMessage);
+        return;
+    }
+    pCore->displayMessage(i18n("Aligning %1 clips...", children.size()), ProcessingJobMessage);
+    m_alignWatcher.setFuture(QtConcurrent::run([reference, children]() {
+        std::unique_ptr<AudioEnvelope> referenceEnvelope(createEnvelope(reference));
+        QList<AudioEnvelope *> envelopes;
+        for (const AlignSource &child : children) {
+            envelopes << createEnvelope(child);
+        }
+        QVector<AudioCorrelation::Alignment> result = AudioCorrelation::alignBatch(referenceEnvelope.get(), envelopes);
+        qDeleteAll(envelopes);
+        return result;
+    }));
+}
+
+void TimelineController::slotAudioAligned()
+{
+    const QVector<AudioCorrelation::Alignment> result = m_alignWatcher.result();
+    if (!m_model->isClip(m_audioRef)) {
+        pCore->displayMessage(i18n("Audio reference was deleted, alignment canceled"), ErrorMessage);
+        return;
+    }
+    // The envelopes start at the clips' in point, so a shift is the distance between both clip starts
+    int referencePos = m_model->getClipPosition(m_audioRef);
+    Fun undo = []() { return true; };
+    Fun redo = []() { return true; };
+    int moved = 0;
+    int rejected = 0;
+    double lowestConfidence = 1;
+    for (int i = 0; i < m_alignClips.size() && i < result.size(); ++i) {
+        int cid = m_alignClips.at(i);
+        int position = referencePos + result.at(i).shift;
+        if (!m_model->isClip(cid) || result.at(i).confidence < minimumAlignConfidence || position < 0 ||
+            !m_model->requestClipMove(cid, m_model->getClipTrackId(cid), position, true, true, undo, redo)) {
+            qDebug() << "Cannot align clip" << cid << ", confidence:" << result.at(i).confidence;
+            rejected++;
+            continue;
+        }
+        lowestConfidence = qMin(lowestConfidence, result.at(i).confidence);
+        moved++;
+    }
+    m_alignClips.clear();
+    if (moved > 0) {
+        pCore->pushUndo(undo, redo, i18n("Align clips"));
+    }
+    if (rejected > 0) {
+        pCore->displayMessage(i18np("%1 clip could not be aligned", "%1 clips could not be aligned", rejected), ErrorMessage);
+    } else {
+        pCore->displayMessage(i18np("Aligned %1 clip (confidence: %2%)", "Aligned %1 clips (lowest confidence: %2%)", moved, qRound(lowestConfidence * 100)),
+                              OperationCompletedMessage);
+    }
+}
+
 void TimelineController::switchTrackLock(bool applyToAll)
 {
     if (!applyToAll) {
@@ -23,9 +23,12 @@
 #define TIMELINECONTROLLER_H
 
 #include "definitions.h"
+#include "lib/audio/audioCorrelation.h"
 #include "timeline2/model/timelineitemmodel.hpp"
 #include "timelinewidget.h"
 
+#include <QFutureWatcher>
+
 class PreviewManager;
 class QAction;
 
@@ -256,6 +259,12 @@ public:
     Q_INVOKABLE void extract(int clipId);
 
     Q_INVOKABLE void splitAudio(int clipId);
+    /* @brief Use the selected clip as reference for audio alignment
+     */
+    void setAudioRef();
+    /* @brief Align the audio of all selected clips on the reference clip, as one undoable operation
+     */
+    void alignAudio();
     void switchTrackLock(bool applyToAll = false);
     void switchTargetTrack();
 
@@ -388,6 +397,10 @@ private:
     Selection m_selection;
     Selection m_savedSelection;
     PreviewManager *m_timelinePreview;
+    int m_audioRef;
+    /* @brief Clips being aligned, in the order of the alignment results */
+    QList<int> m_alignClips;
+    QFutureWatcher<QVector<AudioCorrelation::Alignment>> m_alignWatcher;
     QAction *m_disablePreview;
     void emitSelectedFromSelection();
     int getCurrentItem();
@@ -395,6 +408,10 @@ private:
     // Get a list of currently selected items, including clips grouped with selection
     std::unordered_set<int> getCurrentSelectionIds() const;
 
+private slots:
+    /* @brief Move the aligned clips once the correlation is computed */
+    void slotAudioAligned();
+
 signals:
     void selected(Mlt::Producer *producer);
     void selectionChanged();